@@ -0,0 +1,15 @@
+#pragma once
+
+#include <string>
+
+namespace wmm::util {
+
+/**
+ * @return true if the command line argument starts with the option prefix,
+ * e.g. "--seed="
+ */
+inline bool startsWith(const std::string &string, const std::string &prefix) {
+    return string.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace wmm::util
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "BoundedExplorer.h"
+#include "ExecutorFactory.h"
+#include "Outcome.h"
+#include "Program.h"
+#include "Watchdog.h"
+
+namespace wmm {
+
+struct SimulationStats {
+    size_t steps = 0;
+    std::chrono::nanoseconds duration{0};
+};
+
+struct SimulationResult {
+    execution::ExecutionStatus status = execution::ExecutionStatus::Completed;
+    // Final shared storage and registers, also filled for abandoned runs
+    execution::Outcome finalState;
+    // Memory actions in the order they happened, empty unless recorded
+    std::vector<std::string> trace;
+    // State dump of an abandoned execution
+    std::string snapshot;
+    SimulationStats stats;
+};
+
+/**
+ * Embeddable entry point: runs parsed programs under a memory model in
+ * process. One engine can be used for any number of runs, the programs are
+ * not copied or re-parsed between them. Runs don't share state, so an engine
+ * can be used from several threads.
+ */
+class Engine {
+public:
+    struct Config {
+        execution::MemoryModel model = execution::MemoryModel::SC;
+        // Executor policy, Random or Pct
+        execution::ExecutionMode mode = execution::ExecutionMode::Random;
+        execution::SchedulingOptions scheduling;
+        size_t storageSize = 10;
+        size_t threadLocalStorageSize = 10;
+        execution::Watchdog::Config watchdog;
+        bool recordTrace = false;
+    };
+
+    explicit Engine(Config config);
+
+    [[nodiscard]] SimulationResult
+    run(const std::vector<program::Program> &programs,
+        unsigned long seed) const;
+
+    /**
+     * Systematic exploration of the programs under the configured model, the
+     * storage sizes are taken from the engine config
+     */
+    [[nodiscard]] execution::BoundedExplorer::Result
+    explore(const std::vector<program::Program> &programs,
+            const execution::BoundedExplorer::Config &config = {}) const;
+
+    [[nodiscard]] const Config &getConfig() const { return m_config; }
+
+private:
+    Config m_config;
+};
+
+} // namespace wmm
@@ -0,0 +1,61 @@
+#include <stdexcept>
+
+#include "Engine.h"
+
+namespace wmm {
+
+using namespace execution;
+
+Engine::Engine(Config config) : m_config(std::move(config)) {
+    if (m_config.mode != ExecutionMode::Random &&
+        m_config.mode != ExecutionMode::Pct) {
+        throw std::invalid_argument(
+                "Engine supports only random and pct executors");
+    }
+}
+
+SimulationResult Engine::run(const std::vector<program::Program> &programs,
+                             unsigned long seed) const {
+    storage::LoggerPtr logger;
+    storage::TraceStorageLogger *traceLogger = nullptr;
+    if (m_config.recordTrace) {
+        auto ptr = std::make_unique<storage::TraceStorageLogger>();
+        traceLogger = ptr.get();
+        logger = std::move(ptr);
+    } else {
+        logger = std::make_unique<storage::FakeStorageLogger>();
+    }
+    auto storageManager = makeStorageManager(
+            m_config.model, m_config.mode, m_config.storageSize,
+            programs.size(), seed, std::move(logger), nullptr,
+            m_config.scheduling);
+    // The executor gets its own stream of random numbers
+    auto executor = makeExecutor(m_config.mode, programs, storageManager,
+                                 m_config.threadLocalStorageSize, ~seed,
+                                 m_config.scheduling);
+
+    auto start = std::chrono::steady_clock::now();
+    auto report = Watchdog(m_config.watchdog).run(*executor);
+    auto duration = std::chrono::steady_clock::now() - start;
+
+    SimulationResult result;
+    result.status = report.status;
+    result.finalState = executor->getOutcome();
+    if (traceLogger) { result.trace = traceLogger->takeTrace(); }
+    result.snapshot = std::move(report.snapshot);
+    result.stats.steps = report.steps;
+    result.stats.duration =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+    return result;
+}
+
+BoundedExplorer::Result
+Engine::explore(const std::vector<program::Program> &programs,
+                const BoundedExplorer::Config &config) const {
+    auto explorerConfig = config;
+    explorerConfig.storageSize = m_config.storageSize;
+    explorerConfig.threadLocalStorageSize = m_config.threadLocalStorageSize;
+    return BoundedExplorer(explorerConfig).explore(programs, m_config.model);
+}
+
+} // namespace wmm
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <optional>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ExecutorFactory.h"
+#include "Outcome.h"
+#include "Program.h"
+#include "RecordWriter.h"
+#include "Statistics.h"
+#include "Watchdog.h"
+
+namespace wmm::execution {
+
+struct LitmusTest {
+    std::string name;
+    std::vector<program::Program> programs;
+};
+
+struct BatchCell {
+    std::set<Outcome> outcomes;
+    size_t completedRuns = 0;
+    // Runs that did not finish within the step limit
+    size_t truncatedRuns = 0;
+    size_t deadlockedRuns = 0;
+    size_t livelockedRuns = 0;
+    // Runs that were aborted by an exception
+    size_t failedRuns = 0;
+
+    struct StuckRun {
+        size_t run;
+        ExecutionReport report;
+    };
+    // The first (by run index) run abandoned by the watchdog
+    std::optional<StuckRun> firstStuckRun;
+    ExecutionStatistics statistics;
+
+    [[nodiscard]] size_t runs() const {
+        return completedRuns + truncatedRuns + deadlockedRuns +
+               livelockedRuns + failedRuns;
+    }
+
+    void merge(const BatchCell &other);
+};
+
+struct BatchResult {
+    std::vector<std::string> testNames;
+    std::vector<MemoryModel> models;
+    // cells[testIndex][modelIndex]
+    std::vector<std::vector<BatchCell>> cells;
+
+    void writeMatrix(std::ostream &outputStream) const;
+    void writeOutcomes(std::ostream &outputStream) const;
+
+    /**
+     * Statistics of all tests, one entry per memory model
+     */
+    [[nodiscard]] StatisticsReport getStatisticsReport() const;
+};
+
+/**
+ * Runs every test under every requested memory model with a randomized
+ * executor and collects the outcomes reached by the runs. The parsed programs
+ * are shared by all runs, the runs are spread over a pool of worker threads.
+ * Each run gets a seed derived from the batch seed and the run position, so
+ * the result doesn't depend on the number of workers.
+ */
+class BatchRunner {
+public:
+    struct Config {
+        std::vector<MemoryModel> models = ALL_MEMORY_MODELS;
+        // Either Random or Pct
+        ExecutionMode mode = ExecutionMode::Random;
+        SchedulingOptions scheduling;
+        size_t runsPerModel = 1000;
+        size_t maxSteps = 10000;
+        // See Watchdog, used with the random mode only as PCT isn't fair
+        size_t livelockSteps = 1000;
+        // 0 means one worker per hardware thread
+        size_t nOfWorkers = 0;
+        unsigned long seed = 0;
+        // See BoundedExplorer::Config
+        size_t storageSize = 10;
+        size_t threadLocalStorageSize = 10;
+        // Run the programs rewritten by program::Optimizer
+        bool optimize = true;
+        // If nonzero, random runs under SC and TSO are executed by a
+        // LockstepExecutor with this many lanes. Such runs don't detect
+        // livelocks and don't record statistics or stuck run snapshots.
+        size_t lockstepLanes = 0;
+        // If set, a record of every run is streamed here as the runs finish
+        RecordWriterPtr records;
+        // Write one record per distinct outcome of a test and model after
+        // all runs instead
+        bool recordOutcomes = false;
+    };
+
+    explicit BatchRunner(Config config) : m_config(std::move(config)) {}
+
+    [[nodiscard]] BatchResult run(const std::vector<LitmusTest> &tests) const;
+
+private:
+    Config m_config;
+
+    static constexpr size_t RUNS_PER_JOB = 64;
+
+    // Memory and threads of one test under one model, reset between runs
+    struct Context {
+        storage::StorageManagerPtr storageManager;
+        ExecutorPtr executor;
+        // Fields of the records of the runs
+        ExecutionRecord record;
+    };
+
+    [[nodiscard]] Context makeContext(const LitmusTest &test,
+                                      MemoryModel model) const;
+    // The records of the runs are appended to records
+    void runSingle(Context &context, size_t run, unsigned long seed,
+                   BatchCell &cell, std::string &records) const;
+    [[nodiscard]] bool isLockstep(MemoryModel model) const;
+    void runLockstep(const LitmusTest &test, size_t testIndex,
+                     size_t modelIndex, size_t firstRun, size_t lastRun,
+                     BatchCell &cell, std::string &records) const;
+    [[nodiscard]] bool isRecordingRuns() const {
+        return m_config.records && !m_config.recordOutcomes;
+    }
+};
+
+} // namespace wmm::execution
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <optional>
+#include <set>
+#include <vector>
+
+#include "Executor.h"
+#include "ExecutorFactory.h"
+#include "Outcome.h"
+#include "Program.h"
+#include "RecordWriter.h"
+#include "Watchdog.h"
+
+namespace wmm::execution {
+
+/**
+ * Stateless model checker: systematically enumerates executions by replaying
+ * recorded choice sequences (see storage::ChoiceSequence). The number of
+ * preemptions and delayed buffer propagations per execution is bounded, the
+ * bounds are deepened iteratively starting from zero until either the
+ * maximum bounds are reached or a round finishes without pruning anything,
+ * in which case the exploration is exhaustive.
+ *
+ * With several workers every worker replays its own choice sequences on its
+ * own storage manager and executor. A worker that runs out of sequences
+ * gets the unexplored options of the shallowest open choice of a busy worker
+ * (see storage::ChoiceSequence::split), so every sequence is still explored
+ * exactly once and the result doesn't depend on the number of workers.
+ */
+class BoundedExplorer {
+public:
+    struct Config {
+        size_t maxPreemptions = 2;
+        size_t maxDelays = 2;
+        // Executions longer than this are truncated and give no outcome
+        size_t maxSteps = 1000;
+        // Limit on the number of executions in a single round
+        size_t maxExecutionsPerRound = SIZE_MAX;
+        // The storage manager only gets the shared locations the programs
+        // access when they are known statically, see MemoryLayout
+        size_t storageSize = 10;
+        size_t threadLocalStorageSize = 10;
+        // Run accesses that commute with the other threads without branching
+        bool skipCommutingAccesses = true;
+        // Explore the programs rewritten by program::Optimizer
+        bool optimize = true;
+        // 0 means the number of cores. A round that reaches
+        // maxExecutionsPerRound is explored again by a single worker, as
+        // are the rounds after it, to cut it at the same execution
+        size_t nOfWorkers = 1;
+        // If set, every execution of every round is written here with the
+        // bound and the options it took, under the test name recordName.
+        // The records of a round that is explored again are written once.
+        RecordWriterPtr records;
+        std::string recordName;
+    };
+
+    struct Round {
+        BoundedExecutor::Bound bound;
+        size_t executions = 0;
+        size_t newOutcomes = 0;
+        bool isComplete = true;
+    };
+
+    struct Result {
+        std::set<Outcome> outcomes;
+        std::vector<Round> rounds;
+        size_t truncatedExecutions = 0;
+        // Executions that stopped with threads blocked in spin loops
+        size_t deadlockedExecutions = 0;
+        size_t failedExecutions = 0;
+        // true if no execution was pruned by the bounds in the last round
+        bool isExhaustive = false;
+        ExecutionStatistics statistics;
+    };
+
+    explicit BoundedExplorer(Config config) : m_config(config) {}
+
+    [[nodiscard]] Result explore(const std::vector<program::Program> &programs,
+                                 MemoryModel model) const;
+
+private:
+    Config m_config;
+
+    Round exploreRound(const std::vector<program::Program> &programs,
+                       MemoryModel model, BoundedExecutor::Bound bound,
+                       Result &result) const;
+
+    /**
+     * @return std::nullopt if the round reached maxExecutionsPerRound, the
+     * result is left unchanged then
+     */
+    std::optional<Round>
+    exploreRoundInParallel(const std::vector<program::Program> &programs,
+                           MemoryModel model, BoundedExecutor::Bound bound,
+                           size_t nOfWorkers, Result &result) const;
+};
+
+} // namespace wmm::execution
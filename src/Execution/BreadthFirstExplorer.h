@@ -0,0 +1,100 @@
+#pragma once
+
+#include <filesystem>
+#include <set>
+#include <vector>
+
+#include "ExecutorFactory.h"
+#include "Outcome.h"
+#include "Program.h"
+#include "Statistics.h"
+
+namespace wmm::execution {
+
+/**
+ * Stateful model checker for state spaces that don't fit in memory. The
+ * executions are explored breadth first, one choice (see
+ * storage::ChoiceSequence) per level, and every state is expanded once.
+ * When the model supports it a node of the frontier is the packed state
+ * (see storage::PackedState) that is restored to expand it. Otherwise it is
+ * the sequence of choices that leads to the state, replayed from the start,
+ * and only the hash of the state is kept.
+ *
+ * Duplicates are detected with a delay: the nodes of the next level are
+ * collected in memory up to a limit and written to the disk as runs sorted
+ * by their hash. After the level the runs are merged, and nodes that are
+ * already in the visited set or repeated are dropped. Without packed states
+ * two states with equal hashes are taken for the same state, so a hash
+ * collision may hide some states.
+ *
+ * The visited set holds the packed states or hashes as sorted runs, the new
+ * states of a level are added as a run and runs of similar size are merged,
+ * so there are O(log S) runs for S visited states. Each level reads the
+ * visited runs once and writes its new states once, and a state is
+ * rewritten O(log S) times by the merges: O(L * S) bytes are read and
+ * O(S * log S) written for L levels, instead of rewriting the whole set on
+ * every level.
+ *
+ * Threads with equal programs are interchangeable. Before every step they
+ * are renumbered so that a state and its permutations are stored as one
+ * state, and each outcome is reported with the registers of these threads
+ * in every order.
+ */
+class BreadthFirstExplorer {
+public:
+    struct Config {
+        // Executions with more choices than this are truncated
+        size_t maxDepth = 10000;
+        // Executions that run longer than this without making a choice are
+        // truncated and give no outcome
+        size_t maxSteps = 1000;
+        // Bytes of frontier nodes kept in memory before a run is written
+        size_t memoryLimit = 64 << 20;
+        // The frontier and the visited set are kept in a new directory
+        // inside this one, which is removed afterwards
+        std::filesystem::path directory =
+                std::filesystem::temp_directory_path();
+        size_t storageSize = 10;
+        size_t threadLocalStorageSize = 10;
+        // Run accesses that commute with the other threads without branching
+        bool skipCommutingAccesses = true;
+        // Explore the programs rewritten by program::Optimizer
+        bool optimize = true;
+        // Take states that differ only by a permutation of threads with
+        // equal programs (see program::findSymmetricThreads) for one state
+        bool reduceSymmetry = true;
+    };
+
+    struct Level {
+        // States on the level that weren't visited before
+        size_t states = 0;
+        // Nodes that were dropped as already visited
+        size_t duplicates = 0;
+        size_t runs = 0;
+    };
+
+    struct Result {
+        std::set<Outcome> outcomes;
+        // Levels with new states
+        std::vector<Level> levels;
+        size_t states = 0;
+        size_t truncatedExecutions = 0;
+        // Executions that stopped with threads blocked in spin loops
+        size_t deadlockedExecutions = 0;
+        size_t failedExecutions = 0;
+        // true if nothing was truncated
+        bool isExhaustive = false;
+        ExecutionStatistics statistics;
+    };
+
+    explicit BreadthFirstExplorer(Config config)
+        : m_config(std::move(config)) {}
+
+    [[nodiscard]] Result explore(const std::vector<program::Program> &programs,
+                                 MemoryModel model) const;
+
+private:
+    Config m_config;
+};
+
+} // namespace wmm::execution
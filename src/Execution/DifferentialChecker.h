@@ -0,0 +1,70 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "BatchRunner.h"
+#include "BoundedExplorer.h"
+#include "Outcome.h"
+
+namespace wmm::execution {
+
+/**
+ * Every outcome of the stronger model must be an outcome of the weaker one
+ */
+struct ModelInclusion {
+    MemoryModel stronger;
+    MemoryModel weaker;
+};
+
+const std::vector<ModelInclusion> MODEL_INCLUSIONS = {
+        {MemoryModel::SC, MemoryModel::TSO},
+        {MemoryModel::TSO, MemoryModel::PSO},
+        {MemoryModel::SC, MemoryModel::SRA},
+        {MemoryModel::SRA, MemoryModel::RA}};
+
+/**
+ * Cross-model regression check. Each test is sampled by random runs and
+ * explored by the bounded explorer under every model of the inclusions, the
+ * outcomes of the stronger model are then looked up among the outcomes of the
+ * weaker one. A missing outcome is a violation only if the exploration of the
+ * weaker model was exhaustive, otherwise the check is inconclusive.
+ */
+class DifferentialChecker {
+public:
+    struct Config {
+        std::vector<ModelInclusion> inclusions = MODEL_INCLUSIONS;
+        // The models are taken from the inclusions
+        BatchRunner::Config sampling;
+        BoundedExplorer::Config exploration;
+        // 0 means one worker per hardware thread, also used for sampling
+        size_t nOfWorkers = 0;
+    };
+
+    struct Violation {
+        std::string testName;
+        ModelInclusion inclusion;
+        // Outcome of the stronger model the weaker one can't reach
+        Outcome outcome;
+    };
+
+    struct Result {
+        std::vector<Violation> violations;
+        size_t checks = 0;
+        // Checks with outcomes missing from a non-exhaustive exploration
+        size_t inconclusiveChecks = 0;
+
+        void write(std::ostream &outputStream) const;
+    };
+
+    explicit DifferentialChecker(Config config);
+
+    [[nodiscard]] Result check(const std::vector<LitmusTest> &tests) const;
+
+private:
+    Config m_config;
+    std::vector<MemoryModel> m_models;
+};
+
+} // namespace wmm::execution
@@ -5,56 +5,212 @@
 #pragma once
 
 #include <algorithm>
+#include <optional>
 #include <random>
 
+#include "ChoiceSequence.h"
+#include "Outcome.h"
+#include "Probes.h"
+#include "Statistics.h"
 #include "ThreadManager.h"
 
 namespace wmm::execution {
 
 class ExecutorInterface {
+public:
+    virtual bool execute() = 0;
+
+    virtual void writeState(std::ostream &outputStream) const = 0;
+
+    /**
+     * Start the programs over, the storage manager is reset separately. The
+     * seed is used by the randomized executors.
+     */
+    virtual void reset(unsigned long seed) = 0;
+
+    [[nodiscard]] virtual Outcome getOutcome() const = 0;
+
+    /**
+     * @return false if the execution stopped with threads blocked in spin
+     * loops that nothing can unblock
+     */
+    [[nodiscard]] virtual bool isFinished() const = 0;
+
+    /**
+     * Hash of the memory and all threads, equal states reached by an
+     * execution have equal hashes
+     */
+    [[nodiscard]] virtual size_t hashState() const = 0;
+
+    /**
+     * @return true if the storage manager supports encodeState()
+     */
+    [[nodiscard]] virtual bool canEncodeState() const = 0;
+
+    /**
+     * Canonical encoding of the memory and all threads, equal states have
+     * equal encodings. The executor's own scheduling state isn't included.
+     */
+    [[nodiscard]] virtual storage::PackedState encodeState() const = 0;
+
+    /**
+     * Continue from a state returned by encodeState() of an executor of the
+     * same programs and model
+     */
+    virtual void decodeState(const storage::PackedState &state) = 0;
+
+    /**
+     * Renumber the threads within every class of symmetric threads (see
+     * program::findSymmetricThreads) so that their parts of the state are
+     * sorted. States that differ only by a permutation of symmetric threads
+     * then have equal encodings.
+     *
+     * @param symmetricThreads for every thread the first thread of its class
+     */
+    virtual void
+    canonicalizeThreads(const std::vector<size_t> &symmetricThreads) = 0;
+
+    /**
+     * Profiling counters accumulated over all executions since construction
+     */
+    [[nodiscard]] virtual ExecutionStatistics getStatistics() const = 0;
+
+    virtual ~ExecutorInterface() = default;
+};
+
+using ExecutorPtr = std::unique_ptr<ExecutorInterface>;
+
+/**
+ * Executor over threads that access the memory through the given storage
+ * manager type, see BasicThread
+ */
+template<class StorageManager>
+class BasicExecutor : public ExecutorInterface {
 protected:
-    ThreadManager m_threadManager;
-    storage::StorageManagerPtr m_storageManager;
+    BasicThreadManager<StorageManager> m_threadManager;
+    std::shared_ptr<StorageManager> m_storageManager;
+    MemoryLayoutPtr m_layout;
+    size_t m_internalUpdates = 0;
+    size_t m_idleInternalUpdates = 0;
 
     virtual bool executeThread() = 0;
-    virtual bool executeInternalMemoryUpdate() { return m_storageManager->internalUpdate(); };
+    virtual bool executeInternalMemoryUpdate() {
+        bool isUpdated = m_storageManager->internalUpdate();
+        WMM_PROBE(internal_update, isUpdated);
+        ++(isUpdated ? m_internalUpdates : m_idleInternalUpdates);
+        return isUpdated;
+    }
 
 public:
-    virtual bool execute() = 0;
+    BasicExecutor(const std::vector<program::Program> &programs,
+                  const std::shared_ptr<StorageManager> &storageManager,
+                  size_t threadLocalStorageSize,
+                  const MemoryLayoutPtr &layout = nullptr)
+        : m_threadManager(programs, storageManager, threadLocalStorageSize,
+                          layout),
+          m_storageManager(storageManager), m_layout(layout) {}
 
-    ExecutorInterface(const std::vector<program::Program> &programs,
-                      const storage::StorageManagerPtr &storageManager,
-                      size_t threadLocalStorageSize)
-        : m_storageManager(storageManager),
-          m_threadManager(programs, storageManager, threadLocalStorageSize) {}
+    void writeState(std::ostream &outputStream) const override;
 
+    /**
+     * The scheduling here is deterministic, so the seed is ignored, the
+     * randomized executors override this to use it
+     */
+    void reset(unsigned long /*seed*/) override { m_threadManager.reset(); }
 
+    [[nodiscard]] Outcome getOutcome() const override;
 
-    virtual void writeState(std::ostream &outputStream) const = 0;
+    [[nodiscard]] bool isFinished() const override {
+        return m_threadManager.allThreadsCompleted();
+    }
 
-    virtual ~ExecutorInterface() = default;
+    [[nodiscard]] size_t hashState() const override;
+
+    [[nodiscard]] bool canEncodeState() const override {
+        return m_storageManager->canEncodeState();
+    }
+
+    [[nodiscard]] storage::PackedState encodeState() const override;
+
+    void decodeState(const storage::PackedState &state) override;
+
+    void
+    canonicalizeThreads(const std::vector<size_t> &symmetricThreads) override;
+
+    [[nodiscard]] ExecutionStatistics getStatistics() const override;
 };
 
-using ExecutorPtr = std::unique_ptr<ExecutorInterface>;
+template<class StorageManager>
+class BasicRandomExecutor final : public BasicExecutor<StorageManager> {
+    using BasicExecutor<StorageManager>::m_threadManager;
+    using BasicExecutor<StorageManager>::m_storageManager;
 
-class RandomExecutor : public ExecutorInterface {
     std::mt19937 m_randomGenerator;
+    // Probability to try an internal update before a thread step, lower
+    // values keep stores in the buffers longer
+    std::bernoulli_distribution m_updateFirstDistribution;
 
     bool executeThread() override;
 
 public:
-    RandomExecutor(const std::vector<program::Program> &programs,
-                   const storage::StorageManagerPtr &storageManager,
-                   size_t threadLocalStorageSize, unsigned long seed)
-        : ExecutorInterface(programs, storageManager, threadLocalStorageSize),
-          m_randomGenerator(seed) {}
+    BasicRandomExecutor(const std::vector<program::Program> &programs,
+                        const std::shared_ptr<StorageManager> &storageManager,
+                        size_t threadLocalStorageSize, unsigned long seed,
+                        double flushProbability = 0.5,
+                        const MemoryLayoutPtr &layout = nullptr)
+        : BasicExecutor<StorageManager>(programs, storageManager,
+                                        threadLocalStorageSize, layout),
+          m_randomGenerator(seed),
+          m_updateFirstDistribution(flushProbability) {}
 
     bool execute() override;
+    void reset(unsigned long seed) override;
+};
 
-    void writeState(std::ostream &outputStream) const override;
+using RandomExecutor = BasicRandomExecutor<storage::StorageManagerInterface>;
+
+/**
+ * Probabilistic concurrency testing scheduler. Threads get random distinct
+ * priorities and the enabled thread with the highest priority runs. At
+ * depth - 1 random steps (change points) the priority of the running thread
+ * drops below all initial priorities. A bug that needs depth ordering
+ * constraints between steps is found with probability of at least
+ * 1 / (n * k^(depth - 1)) per run, where n is the number of threads and k is
+ * the number of steps. Internal updates are tried first with the flush
+ * probability, so stores can stay buffered for long.
+ */
+template<class StorageManager>
+class BasicPctExecutor final : public BasicExecutor<StorageManager> {
+    using BasicExecutor<StorageManager>::m_threadManager;
+
+    std::mt19937 m_randomGenerator;
+    std::bernoulli_distribution m_updateFirstDistribution;
+    std::vector<size_t> m_priorities;
+    std::vector<size_t> m_changePoints;
+    size_t m_nextChangePoint = 0;
+    size_t m_step = 0;
+    size_t m_depth;
+    size_t m_expectedSteps;
+
+    bool executeThread() override;
+
+public:
+    BasicPctExecutor(const std::vector<program::Program> &programs,
+                     const std::shared_ptr<StorageManager> &storageManager,
+                     size_t threadLocalStorageSize, unsigned long seed,
+                     size_t depth, size_t expectedSteps,
+                     double flushProbability = 0.5,
+                     const MemoryLayoutPtr &layout = nullptr);
+
+    bool execute() override;
+    // Draws new priorities and change points
+    void reset(unsigned long seed) override;
 };
 
-class InteractiveExecutor : public ExecutorInterface {
+using PctExecutor = BasicPctExecutor<storage::StorageManagerInterface>;
+
+class InteractiveExecutor
+    : public BasicExecutor<storage::StorageManagerInterface> {
     bool executeThread() override;
     bool executeInternalMemoryUpdate() override;
 
@@ -62,11 +218,66 @@ public:
     InteractiveExecutor(const std::vector<program::Program> &programs,
                    const storage::StorageManagerPtr &storageManager,
                    size_t threadLocalStorageSize)
-        : ExecutorInterface(programs, storageManager, threadLocalStorageSize) {}
+        : BasicExecutor(programs, storageManager, threadLocalStorageSize) {}
 
     bool execute() override;
 
     void writeState(std::ostream &outputStream) const override;
 };
 
+/**
+ * Executes one step per call as dictated by a choice sequence. The steps are
+ * restricted by a budget of preemptions (switching away from a thread that
+ * could continue) and delays (pending internal updates, e.g. buffered stores,
+ * that were postponed past a thread step; each is counted once). By default
+ * pending updates are performed first, so with a zero budget the weak models
+ * behave like SC. Thread-local instructions are invisible to other threads,
+ * so they are executed without branching and don't spend the budget. The
+ * same holds for the accesses marked as commuting (see
+ * program::findCommutingAccesses).
+ */
+class BoundedExecutor : public BasicExecutor<storage::StorageManagerInterface> {
+public:
+    struct Bound {
+        size_t preemptions;
+        size_t delays;
+    };
+
+private:
+    storage::ChoiceSequencePtr m_choices;
+    Bound m_bound;
+    size_t m_preemptions = 0;
+    size_t m_delays = 0;
+    // Pending internal updates that were already counted as delayed
+    size_t m_delayedUpdates = 0;
+    bool m_isPruned = false;
+    std::optional<size_t> m_currentThreadId;
+    // commutingAccesses[threadId][instruction]
+    std::vector<std::vector<bool>> m_commutingAccesses;
+
+    bool executeThread() override;
+    [[nodiscard]] bool isNextStepInvisible(size_t threadId) const;
+
+public:
+    BoundedExecutor(const std::vector<program::Program> &programs,
+                    const storage::StorageManagerPtr &storageManager,
+                    size_t threadLocalStorageSize,
+                    storage::ChoiceSequencePtr choices, Bound bound,
+                    std::vector<std::vector<bool>> commutingAccesses = {},
+                    const MemoryLayoutPtr &layout = nullptr)
+        : BasicExecutor(programs, storageManager, threadLocalStorageSize,
+                        layout),
+          m_choices(std::move(choices)), m_bound(bound),
+          m_commutingAccesses(std::move(commutingAccesses)) {}
+
+    bool execute() override;
+    // The choice sequence is shared, so it is not rewound here
+    void reset(unsigned long seed) override;
+
+    /**
+     * @return true if some step was skipped because of the budget
+     */
+    [[nodiscard]] bool isPruned() const { return m_isPruned; }
+};
+
 } // namespace wmm
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ChoiceSequence.h"
+#include "Executor.h"
+#include "MemoryLayout.h"
+#include "Program.h"
+#include "StorageLogger.h"
+#include "StorageManager.h"
+
+namespace wmm::execution {
+
+enum class MemoryModel { TSO, PSO, SC, RA, SRA };
+
+const std::vector<MemoryModel> ALL_MEMORY_MODELS = {
+        MemoryModel::SC, MemoryModel::TSO, MemoryModel::PSO, MemoryModel::SRA,
+        MemoryModel::RA};
+
+MemoryModel parseMemoryModel(const std::string &model);
+std::string toString(MemoryModel model);
+
+enum class ExecutionMode { Random, Interactive, Enumerate, Pct };
+
+ExecutionMode parseExecutionMode(const std::string &mode);
+
+/**
+ * Tuning of the randomized execution modes
+ */
+struct SchedulingOptions {
+    // Probability to try an internal update (e.g. a buffer flush) before a
+    // thread step
+    double flushProbability = 0.5;
+    // Preference of RA reads for older messages in [0, 1), 0 is uniform
+    double oldMessageBias = 0;
+    // Number of PCT priority change points plus one
+    size_t pctDepth = 3;
+    // Estimated number of thread steps in an execution, PCT change points
+    // are picked among them
+    size_t pctExpectedSteps = 100;
+};
+
+storage::StorageManagerPtr makeStorageManager(
+        MemoryModel model, ExecutionMode mode, size_t storageSize,
+        size_t nOfThreads, unsigned long seed,
+        storage::LoggerPtr &&logger =
+                std::make_unique<storage::FakeStorageLogger>(),
+        const storage::ChoiceSequencePtr &choices = nullptr,
+        const SchedulingOptions &options = {});
+
+/**
+ * With a memory layout the storage manager must be made for its shared
+ * storage size
+ */
+ExecutorPtr makeExecutor(ExecutionMode mode,
+                         const std::vector<program::Program> &programs,
+                         const storage::StorageManagerPtr &storageManager,
+                         size_t threadLocalStorageSize, unsigned long seed,
+                         const SchedulingOptions &options = {},
+                         const MemoryLayoutPtr &layout = nullptr);
+
+} // namespace wmm::execution
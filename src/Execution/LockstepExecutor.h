@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "ExecutorFactory.h"
+#include "Outcome.h"
+#include "Program.h"
+#include "Watchdog.h"
+
+namespace wmm::execution {
+
+/**
+ * Runs many independent random executions of the same programs side by side
+ * under SC or TSO. The state of all executions (lanes) is kept in structure
+ * of arrays form: memory, registers, program positions and store buffers are
+ * arrays indexed by the lane. Every step draws a random number per lane from
+ * a per-lane xorshift generator, picks a thread or a buffer to propagate the
+ * way the random executor does, then groups the lanes by the opcode of the
+ * chosen instruction and executes every group in a tight loop.
+ *
+ * The instructions follow BasicThread, including the blocking of spin loops.
+ * Stores beyond the buffer capacity first propagate the oldest buffered
+ * store, which is one of the TSO behaviours anyway. Livelocks are not
+ * detected, such executions run into the step limit.
+ */
+class LockstepExecutor {
+public:
+    struct Config {
+        size_t lanes = 256;
+        size_t maxSteps = 10000;
+        // See SchedulingOptions
+        double flushProbability = 0.5;
+        size_t storageSize = 10;
+        size_t threadLocalStorageSize = 10;
+        // Store buffer slots per thread
+        size_t bufferCapacity = 16;
+    };
+
+    struct Run {
+        // nullopt if the execution failed, e.g. on an address out of range
+        std::optional<ExecutionStatus> status;
+        size_t steps = 0;
+        // Final state of a completed execution
+        Outcome outcome;
+    };
+
+    static constexpr size_t MAX_THREADS = 64;
+
+    [[nodiscard]] static bool supports(MemoryModel model) {
+        return model == MemoryModel::SC || model == MemoryModel::TSO;
+    }
+
+    LockstepExecutor(const std::vector<program::Program> &programs,
+                     MemoryModel model, Config config);
+
+    /**
+     * Runs one execution per seed, Config::lanes of them at a time
+     */
+    [[nodiscard]] std::vector<Run> run(std::span<const unsigned long> seeds);
+
+private:
+    enum class Opcode : uint8_t {
+        StoreConst,
+        StoreExpr,
+        Goto,
+        Load,
+        Store,
+        CompareAndSwap,
+        FetchAndIncrement,
+        Fence,
+        CompareAndSwapLoop,
+        // Uses a register out of range, fails the execution
+        Invalid,
+    };
+    static constexpr size_t N_OF_OPCODES = 10;
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Instruction {
+        Opcode opcode = Opcode::Invalid;
+        program::BinaryOperation operation{};
+        // Operand registers in the order of the instruction fields, a missing
+        // result register of a cas is NONE
+        uint32_t registers[4] = {};
+        int32_t value = 0;
+        // Position of the jump target, NONE for a missing label
+        uint32_t target = NONE;
+        // Head of the spin loop closed by the jump, NONE if there is none
+        uint32_t spinLoopHead = NONE;
+        // Body of a fused loop in m_loopBodies
+        uint32_t body = 0;
+        uint32_t bodySize = 0;
+    };
+
+    Config m_config;
+    bool m_isBuffered;
+    size_t m_nOfThreads;
+    // m_programs[threadId][position]
+    std::vector<std::vector<Instruction>> m_programs;
+    std::vector<Instruction> m_loopBodies;
+
+    // Lane state, element [row * lanes + lane], the row is given in brackets
+    std::vector<int32_t> m_memory;                // [address]
+    std::vector<int32_t> m_registers;             // [thread * registers + reg]
+    std::vector<uint32_t> m_positions;            // [thread]
+    std::vector<uint32_t> m_lastLoads;            // [thread]
+    std::vector<int32_t> m_lastLoadedValues;      // [thread]
+    std::vector<uint8_t> m_isSpinning;            // [thread]
+    std::vector<uint32_t> m_bufferAddresses;      // [thread * capacity + slot]
+    std::vector<int32_t> m_bufferValues;          // [thread * capacity + slot]
+    std::vector<uint32_t> m_bufferStarts;         // [thread]
+    std::vector<uint32_t> m_bufferSizes;          // [thread]
+    // Per lane
+    std::vector<uint64_t> m_random;
+    std::vector<uint32_t> m_threads;
+    std::vector<uint8_t> m_isFailed;
+
+    [[nodiscard]] size_t at(size_t row, size_t lane) const {
+        return row * m_config.lanes + lane;
+    }
+    [[nodiscard]] int32_t &reg(size_t threadId, uint32_t reg, size_t lane) {
+        return m_registers[at(threadId * m_config.threadLocalStorageSize + reg,
+                              lane)];
+    }
+
+    [[nodiscard]] Instruction decode(const program::Program &program,
+                                     size_t position,
+                                     const program::Instruction &instruction);
+    void reset(std::span<const unsigned long> seeds);
+    [[nodiscard]] int32_t load(size_t threadId, uint32_t address,
+                               size_t lane) const;
+    void store(size_t threadId, uint32_t address, int32_t value, size_t lane);
+    void propagate(size_t threadId, size_t lane);
+    void flush(size_t threadId, size_t lane);
+    // @return the value read
+    int32_t compareAndSwap(size_t threadId, uint32_t address,
+                           int32_t expectedValue, int32_t newValue,
+                           size_t lane);
+    // Runs an instruction of the body of a fused loop, false on a failure
+    bool evaluateInLoop(const Instruction &instruction, size_t threadId,
+                        size_t lane);
+    [[nodiscard]] bool isBlocked(size_t threadId, size_t lane) const;
+    // Thread to run or buffer to propagate, nullopt if there is nothing to do
+    [[nodiscard]] std::optional<std::pair<uint32_t, bool>>
+    choose(size_t lane) const;
+    void execute(Opcode opcode, std::span<const uint32_t> lanes);
+    [[nodiscard]] Outcome getOutcome(size_t lane) const;
+};
+
+} // namespace wmm::execution
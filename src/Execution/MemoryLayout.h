@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "Program.h"
+#include "Storage.h"
+
+namespace wmm::execution {
+
+/**
+ * Split of the shared memory between the storage manager and the threads. A
+ * location that a single thread accesses with plain loads and stores behaves
+ * the same under every model: the thread always reads its own last store. It
+ * is kept in a plain array of the thread. The remaining locations are passed
+ * to the storage manager under compact indices, so its buffers, histories
+ * and views only cover them.
+ */
+class MemoryLayout {
+    size_t m_storageSize;
+    // Owner of every private location
+    std::vector<std::optional<size_t>> m_owners;
+    // Index in the storage manager of every shared location
+    std::vector<std::optional<size_t>> m_sharedIndices;
+    // Location of every index in the storage manager
+    std::vector<size_t> m_sharedLocations;
+
+public:
+    /**
+     * All locations are shared unless the footprints of the programs are
+     * complete (see program::Footprint), locations that no thread accesses
+     * are then dropped
+     */
+    MemoryLayout(const std::vector<program::Program> &programs,
+                 size_t storageSize);
+
+    [[nodiscard]] bool isPrivate(size_t threadId, size_t location) const {
+        return location < m_owners.size() && m_owners[location] == threadId;
+    }
+
+    /**
+     * @return true if some location is private to the thread
+     */
+    [[nodiscard]] bool hasPrivateLocations(size_t threadId) const;
+
+    /**
+     * @return index of a shared location in the storage manager
+     */
+    [[nodiscard]] size_t getSharedIndex(size_t location) const;
+
+    /**
+     * Size of the memory of the storage manager
+     */
+    [[nodiscard]] size_t getSharedStorageSize() const {
+        return std::max<size_t>(m_sharedLocations.size(), 1);
+    }
+
+    [[nodiscard]] size_t getStorageSize() const { return m_storageSize; }
+
+    /**
+     * Values of all locations from the memory of the storage manager and the
+     * private storages of the threads
+     */
+    [[nodiscard]] std::vector<int32_t>
+    merge(const std::vector<int32_t> &sharedStorage,
+          const std::vector<const storage::Storage *> &privateStorages) const;
+};
+
+using MemoryLayoutPtr = std::shared_ptr<const MemoryLayout>;
+
+} // namespace wmm::execution
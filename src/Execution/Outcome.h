@@ -0,0 +1,23 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace wmm::execution {
+
+/**
+ * Observable result of a finished execution: the final values of the shared
+ * locations and the registers of every thread
+ */
+struct Outcome {
+    std::vector<int32_t> sharedStorage;
+    std::vector<std::vector<int32_t>> threadLocalStorages;
+
+    [[nodiscard]] std::string str() const;
+
+    auto operator<=>(const Outcome &) const = default;
+};
+
+} // namespace wmm::execution
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Executor.h"
+#include "ExecutorFactory.h"
+#include "Outcome.h"
+#include "Watchdog.h"
+
+namespace wmm::execution {
+
+/**
+ * One machine-readable record: an execution, or a distinct outcome of a test
+ * under a model, in which case only the outcome is set
+ */
+struct ExecutionRecord {
+    std::string test;
+    MemoryModel model = MemoryModel::SC;
+    std::optional<size_t> run;
+    std::optional<unsigned long> seed;
+    // nullopt for a failed execution
+    std::optional<ExecutionStatus> status;
+    std::optional<size_t> steps;
+    // Final shared storage and registers of a completed execution
+    std::optional<Outcome> outcome;
+    // Budget of the executor, for executions of a BoundedExplorer
+    std::optional<BoundedExecutor::Bound> bound;
+    // Options taken at the choices, see storage::ChoiceSequence::replay
+    std::optional<std::vector<uint32_t>> choices;
+};
+
+enum class RecordFormat {
+    // One JSON object per line, unset fields are left out
+    JsonLines,
+    // A header line, then one line per record with unset fields empty.
+    // Storage and choices are separated by spaces, threads by '|'.
+    Csv
+};
+
+RecordFormat parseRecordFormat(const std::string &format);
+
+/**
+ * Streams records to an output stream through a buffer that is written out
+ * in large chunks. Workers can format their records into buffers of their
+ * own with format() and hand them over with write(std::string_view), so the
+ * lock is taken once per batch of records. The rest is flushed when the
+ * writer is destroyed.
+ */
+class RecordWriter {
+    std::ostream &m_stream;
+    RecordFormat m_format;
+    size_t m_bufferSize;
+    std::mutex m_mutex;
+    std::string m_buffer;
+
+public:
+    explicit RecordWriter(std::ostream &stream,
+                          RecordFormat format = RecordFormat::JsonLines,
+                          size_t bufferSize = 1 << 20);
+
+    RecordWriter(const RecordWriter &) = delete;
+    RecordWriter &operator=(const RecordWriter &) = delete;
+
+    ~RecordWriter();
+
+    /**
+     * Append the formatted record to the buffer
+     */
+    void format(const ExecutionRecord &record, std::string &buffer) const;
+
+    void write(const ExecutionRecord &record);
+
+    /**
+     * Write records returned by format(), may be called from several threads
+     */
+    void write(std::string_view records);
+
+    void flush();
+
+    /**
+     * Size at which buffers are worth handing over
+     */
+    [[nodiscard]] size_t getBufferSize() const { return m_bufferSize; }
+};
+
+using RecordWriterPtr = std::shared_ptr<RecordWriter>;
+
+} // namespace wmm::execution
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "StorageStatistics.h"
+
+namespace wmm::execution {
+
+/**
+ * Profiling counters of an executor, its threads and its storage manager.
+ * Like the storage counters they accumulate over all executions.
+ */
+struct ExecutionStatistics {
+    // Steps per thread by the kind of the instruction
+    std::vector<size_t> threadLocalSteps;
+    std::vector<size_t> memorySteps;
+    // Calls of StorageManagerInterface::internalUpdate that did something
+    // and that found nothing to do
+    size_t internalUpdates = 0;
+    size_t idleInternalUpdates = 0;
+    storage::StorageStatistics storage;
+
+    [[nodiscard]] size_t steps() const;
+    void merge(const ExecutionStatistics &other);
+};
+
+/**
+ * Wall-clock time of the consecutive phases of a command
+ */
+class PhaseTimer {
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<std::pair<std::string, double>> m_seconds;
+    std::optional<std::pair<std::string, Clock::time_point>> m_current;
+
+public:
+    // Ends the current phase
+    void start(std::string phase);
+    void stop();
+
+    [[nodiscard]] const std::vector<std::pair<std::string, double>> &
+    getSeconds() const {
+        return m_seconds;
+    }
+};
+
+struct StatisticsReport {
+    // Labelled counters, e.g. one entry per memory model
+    std::vector<std::pair<std::string, ExecutionStatistics>> entries;
+    std::vector<std::pair<std::string, double>> phaseSeconds;
+
+    void write(std::ostream &outputStream) const;
+    void writeJson(std::ostream &outputStream) const;
+};
+
+} // namespace wmm::execution
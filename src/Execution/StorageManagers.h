@@ -0,0 +1,21 @@
+#pragma once
+
+#include "PartialStoreOrderStorageManager.h"
+#include "ReleaseAcquireStorageManager.h"
+#include "SequentialConsistencyStorageManager.h"
+#include "StorageManager.h"
+#include "TotalStoreOrderStorageManager.h"
+
+/**
+ * Explicit instantiations of an execution class template for the storage
+ * manager interface and for every concrete storage manager
+ */
+#define INSTANTIATE_FOR_STORAGE_MANAGERS(class_template)                       \
+    template class class_template<storage::StorageManagerInterface>;           \
+    template class class_template<                                             \
+            storage::SC::SequentialConsistencyStorageManager>;                 \
+    template class class_template<                                             \
+            storage::TSO::TotalStoreOrderStorageManager>;                      \
+    template class class_template<                                             \
+            storage::PSO::PartialStoreOrderStorageManager>;                    \
+    template class class_template<storage::RA::ReleaseAcquireStorageManager>;
@@ -5,33 +5,109 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 
+#include "MemoryLayout.h"
 #include "Program.h"
 #include "Storage.h"
 #include "StorageManager.h"
 
 namespace wmm::execution {
 
-class Thread {
+/**
+ * Interpreter of one program. The storage manager is a template parameter:
+ * with a final storage manager class the memory accesses are direct calls
+ * instead of virtual ones. With a memory layout the locations private to the
+ * thread are kept in the thread and the others are renumbered for the
+ * storage manager.
+ */
+template<class StorageManager>
+class BasicThread {
     const program::Program m_program;
     storage::Storage m_localStorage;
-    storage::StorageManagerPtr m_storageManager;
+    std::shared_ptr<StorageManager> m_storageManager;
+    MemoryLayoutPtr m_layout;
+    // Values of the private locations, indexed by location
+    storage::Storage m_privateStorage;
     size_t m_currentInstruction = 0;
+    // The last load since the last memory access or jump, used to tell
+    // whether the back edge of a spin loop finished a whole iteration
+    std::optional<size_t> m_lastLoadInstruction;
+    int32_t m_lastLoadedValue = 0;
+    bool m_isSpinning = false;
+    // Profiling counters, kept by reset()
+    size_t m_threadLocalSteps = 0;
+    size_t m_memorySteps = 0;
+
+    [[nodiscard]] bool isPrivate(size_t address) const {
+        return m_layout && m_layout->isPrivate(id, address);
+    }
+    // Location in the memory of the storage manager
+    [[nodiscard]] size_t toShared(size_t address) const {
+        return m_layout ? m_layout->getSharedIndex(address) : address;
+    }
+
+    void execute(const program::InstructionPtr &instruction, bool isSpinning,
+                 size_t &nextInstruction);
+
 public:
     const size_t id;
 
-    Thread(program::Program program, storage::StorageManagerPtr storageManager, size_t threadId,
-           size_t localStorageSize = 100)
+    BasicThread(program::Program program,
+                std::shared_ptr<StorageManager> storageManager,
+                size_t threadId, size_t localStorageSize = 100,
+                MemoryLayoutPtr layout = nullptr)
         : m_program(std::move(program)), m_localStorage(localStorageSize),
-          m_storageManager(std::move(storageManager)), id(threadId) {}
+          m_storageManager(std::move(storageManager)),
+          m_layout(std::move(layout)),
+          m_privateStorage((m_layout && m_layout->hasPrivateLocations(threadId))
+                                   ? m_layout->getStorageSize()
+                                   : 0),
+          id(threadId) {}
 
     bool evaluateInstruction();
 
+    /**
+     * Start the program over with zeroed registers
+     */
+    void reset();
+
     std::shared_ptr<program::Instruction> getCurrentInstruction() const;
 
+    size_t getCurrentPosition() const { return m_currentInstruction; }
+
     bool isFinished() const { return m_currentInstruction == m_program.size(); }
 
+    /**
+     * A thread that completed an iteration of a spin loop is blocked until
+     * the load at the head of the loop may return another value
+     */
+    [[nodiscard]] bool isBlocked() const;
+
     const storage::Storage &getLocalStorage() const { return m_localStorage; };
+
+    const storage::Storage &getPrivateStorage() const {
+        return m_privateStorage;
+    }
+
+    [[nodiscard]] size_t getThreadLocalSteps() const {
+        return m_threadLocalSteps;
+    }
+    [[nodiscard]] size_t getMemorySteps() const { return m_memorySteps; }
+
+    /**
+     * Hash of the position in the program, the registers and the private
+     * locations
+     */
+    [[nodiscard]] size_t hashState() const;
+
+    /**
+     * Write what hashState() covers, see storage::PackedState
+     */
+    void encodeState(storage::StateWriter &writer) const;
+    void decodeState(storage::StateReader &reader);
 };
 
+using Thread = BasicThread<storage::StorageManagerInterface>;
+
 } // namespace wmm
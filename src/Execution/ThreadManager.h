@@ -4,31 +4,67 @@
 
 #include "Instructions.h"
 #include "Program.h"
+#include "Statistics.h"
 #include "Thread.h"
 
 namespace wmm::execution {
 
-class ThreadManager {
-    std::vector<Thread> m_threads;
-    storage::StorageManagerPtr m_storageManager;
+template<class StorageManager>
+class BasicThreadManager {
+    std::vector<BasicThread<StorageManager>> m_threads;
+    std::shared_ptr<StorageManager> m_storageManager;
 
 public:
-    ThreadManager(const std::vector<program::Program> &programs,
-                  storage::StorageManagerPtr storageManager,
-                  size_t threadLocalStorageSize);
+    BasicThreadManager(const std::vector<program::Program> &programs,
+                       std::shared_ptr<StorageManager> storageManager,
+                       size_t threadLocalStorageSize,
+                       const MemoryLayoutPtr &layout = nullptr);
 
     bool evaluateThread(size_t threadId);
+    void reset();
     void evaluateThreadLocalInstructions(size_t threadId);
+    [[nodiscard]] bool isNextInstructionThreadLocal(size_t threadId) const;
     [[nodiscard]] bool allThreadsCompleted() const;
     [[nodiscard]] std::vector<storage::Storage> getThreadLocalStorages() const;
     [[nodiscard]] std::vector<size_t> unfinishedThreads() const;
+    /**
+     * @return threads that are neither finished nor blocked in a spin loop
+     */
+    [[nodiscard]] std::vector<size_t> runnableThreads() const;
     [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t hashThreadState(size_t threadId) const;
+    void encodeState(storage::StateWriter &writer) const;
+    void decodeState(storage::StateReader &reader);
+
+    void encodeThreadState(size_t threadId,
+                           storage::StateWriter &writer) const;
+
+    /**
+     * Thread i takes over the registers and the position of thread order[i],
+     * the threads must run equal programs
+     */
+    void permuteThreads(const std::vector<size_t> &order);
 
     [[nodiscard]] std::shared_ptr<program::Instruction>
     getCurrentInstructionForThread(size_t threadId) const;
 
+    /**
+     * @return index of the next instruction of the thread in its program
+     */
+    [[nodiscard]] size_t getCurrentPositionForThread(size_t threadId) const;
+
     [[nodiscard]] const storage::Storage &
     getThreadLocalStorage(size_t threadId) const;
+
+    [[nodiscard]] const storage::Storage &
+    getPrivateStorage(size_t threadId) const;
+
+    /**
+     * Adds the steps of every thread to the statistics
+     */
+    void collectStatistics(ExecutionStatistics &statistics) const;
 };
 
+using ThreadManager = BasicThreadManager<storage::StorageManagerInterface>;
+
 } // namespace wmm::execution
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <string>
+#include <unordered_set>
+
+#include "Executor.h"
+
+namespace wmm::execution {
+
+enum class ExecutionStatus {
+    Completed,
+    // Some threads are blocked in spin loops and nothing can unblock them
+    Deadlocked,
+    // The execution keeps going round the states it has already visited
+    Livelocked,
+    StepLimitExceeded
+};
+
+std::string toString(ExecutionStatus status);
+
+struct ExecutionReport {
+    ExecutionStatus status = ExecutionStatus::Completed;
+    size_t steps = 0;
+    // State of the memory and the registers when a stuck execution was
+    // abandoned, empty for completed executions
+    std::string snapshot;
+};
+
+/**
+ * Runs an executor step by step and abandons executions that are stuck.
+ * Besides the step limit it hashes the global state after every step: when
+ * the given number of consecutive steps only revisits known states the
+ * execution is considered livelocked. This assumes that the executor's
+ * schedule is fair (e.g. random), otherwise a thread that could make
+ * progress may just be starved.
+ */
+class Watchdog {
+public:
+    struct Config {
+        size_t maxSteps = 10000;
+        // 0 disables the livelock detection
+        size_t livelockSteps = 1000;
+    };
+
+    explicit Watchdog(Config config) : m_config(config) {}
+
+    ExecutionReport run(ExecutorInterface &executor) const;
+
+    /**
+     * Same as run(), calls onStep after every step
+     */
+    template<class Callback>
+    ExecutionReport run(ExecutorInterface &executor, Callback &&onStep) const;
+
+private:
+    Config m_config;
+
+    static ExecutionReport abandon(const ExecutorInterface &executor,
+                                   ExecutionStatus status, size_t steps);
+};
+
+template<class Callback>
+ExecutionReport Watchdog::run(ExecutorInterface &executor,
+                              Callback &&onStep) const {
+    std::unordered_set<size_t> visitedStates;
+    size_t revisitingSteps = 0;
+    size_t steps = 0;
+    while (executor.execute()) {
+        onStep();
+        if (++steps > m_config.maxSteps) {
+            return abandon(executor, ExecutionStatus::StepLimitExceeded,
+                           steps);
+        }
+        if (m_config.livelockSteps == 0) { continue; }
+        if (visitedStates.insert(executor.hashState()).second) {
+            revisitingSteps = 0;
+        } else if (++revisitingSteps >= m_config.livelockSteps) {
+            return abandon(executor, ExecutionStatus::Livelocked, steps);
+        }
+    }
+    if (!executor.isFinished()) {
+        return abandon(executor, ExecutionStatus::Deadlocked, steps);
+    }
+    return {ExecutionStatus::Completed, steps, {}};
+}
+
+} // namespace wmm::execution
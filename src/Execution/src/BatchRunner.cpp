@@ -0,0 +1,335 @@
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <mutex>
+#include <thread>
+
+#include "BatchRunner.h"
+#include "LockstepExecutor.h"
+#include "Optimizer.h"
+
+namespace wmm::execution {
+
+namespace {
+unsigned long splitMix(unsigned long value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+unsigned long runSeed(unsigned long seed, size_t testIndex, size_t modelIndex,
+                      size_t runIndex) {
+    return splitMix(splitMix(splitMix(seed ^ testIndex) ^ modelIndex) ^
+                    runIndex);
+}
+
+struct Job {
+    size_t testIndex;
+    size_t modelIndex;
+    size_t firstRun;
+    size_t lastRun;
+};
+} // namespace
+
+void BatchCell::merge(const BatchCell &other) {
+    outcomes.insert(other.outcomes.begin(), other.outcomes.end());
+    completedRuns += other.completedRuns;
+    truncatedRuns += other.truncatedRuns;
+    deadlockedRuns += other.deadlockedRuns;
+    livelockedRuns += other.livelockedRuns;
+    failedRuns += other.failedRuns;
+    if (other.firstStuckRun &&
+        (!firstStuckRun || other.firstStuckRun->run < firstStuckRun->run)) {
+        firstStuckRun = other.firstStuckRun;
+    }
+    statistics.merge(other.statistics);
+}
+
+BatchRunner::Context BatchRunner::makeContext(const LitmusTest &test,
+                                              MemoryModel model) const {
+    auto layout = std::make_shared<const MemoryLayout>(test.programs,
+                                                       m_config.storageSize);
+    // The seeds are replaced by reset() before every run
+    auto storageManager = makeStorageManager(
+            model, m_config.mode, layout->getSharedStorageSize(),
+            test.programs.size(), 0,
+            std::make_unique<storage::FakeStorageLogger>(), nullptr,
+            m_config.scheduling);
+    auto executor = makeExecutor(m_config.mode, test.programs, storageManager,
+                                 m_config.threadLocalStorageSize, 0,
+                                 m_config.scheduling, layout);
+    ExecutionRecord record;
+    record.test = test.name;
+    record.model = model;
+    return {std::move(storageManager), std::move(executor), record};
+}
+
+void BatchRunner::runSingle(Context &context, size_t run, unsigned long seed,
+                            BatchCell &cell, std::string &records) const {
+    auto &record = context.record;
+    record.run = run;
+    record.seed = seed;
+    record.status.reset();
+    record.steps.reset();
+    record.outcome.reset();
+    try {
+        context.storageManager->reset(seed);
+        context.executor->reset(splitMix(seed));
+        auto &executor = context.executor;
+        size_t livelockSteps = (m_config.mode == ExecutionMode::Random)
+                                       ? m_config.livelockSteps
+                                       : 0;
+        auto report = Watchdog({m_config.maxSteps, livelockSteps})
+                              .run(*executor);
+        if (isRecordingRuns()) {
+            record.status = report.status;
+            record.steps = report.steps;
+            if (report.status == ExecutionStatus::Completed) {
+                record.outcome = executor->getOutcome();
+            }
+            m_config.records->format(record, records);
+        }
+        switch (report.status) {
+            case ExecutionStatus::Completed:
+                cell.outcomes.insert(record.outcome ? *record.outcome
+                                                    : executor->getOutcome());
+                ++cell.completedRuns;
+                return;
+            case ExecutionStatus::Deadlocked:
+                ++cell.deadlockedRuns;
+                break;
+            case ExecutionStatus::Livelocked:
+                ++cell.livelockedRuns;
+                break;
+            case ExecutionStatus::StepLimitExceeded:
+                ++cell.truncatedRuns;
+                break;
+        }
+        if (!cell.firstStuckRun) {
+            cell.firstStuckRun = {run, std::move(report)};
+        }
+    } catch (const std::exception &) {
+        ++cell.failedRuns;
+        if (isRecordingRuns()) { m_config.records->format(record, records); }
+    }
+}
+
+bool BatchRunner::isLockstep(MemoryModel model) const {
+    return m_config.lockstepLanes > 0 &&
+           m_config.mode == ExecutionMode::Random &&
+           LockstepExecutor::supports(model);
+}
+
+void BatchRunner::runLockstep(const LitmusTest &test, size_t testIndex,
+                              size_t modelIndex, size_t firstRun,
+                              size_t lastRun, BatchCell &cell,
+                              std::string &records) const {
+    LockstepExecutor executor(test.programs, m_config.models[modelIndex],
+                              {m_config.lockstepLanes, m_config.maxSteps,
+                               m_config.scheduling.flushProbability,
+                               m_config.storageSize,
+                               m_config.threadLocalStorageSize});
+    std::vector<unsigned long> seeds;
+    for (size_t run = firstRun; run < lastRun; ++run) {
+        seeds.push_back(runSeed(m_config.seed, testIndex, modelIndex, run));
+    }
+    auto runs = executor.run(seeds);
+    ExecutionRecord record;
+    record.test = test.name;
+    record.model = m_config.models[modelIndex];
+    for (size_t i = 0; i < runs.size(); ++i) {
+        auto &run = runs[i];
+        if (isRecordingRuns()) {
+            record.run = firstRun + i;
+            record.seed = seeds[i];
+            record.status = run.status;
+            record.steps.reset();
+            record.outcome.reset();
+            if (run.status) { record.steps = run.steps; }
+            if (run.status == ExecutionStatus::Completed) {
+                record.outcome = run.outcome;
+            }
+            m_config.records->format(record, records);
+        }
+        if (!run.status) {
+            ++cell.failedRuns;
+            continue;
+        }
+        switch (*run.status) {
+            case ExecutionStatus::Completed:
+                cell.outcomes.insert(std::move(run.outcome));
+                ++cell.completedRuns;
+                continue;
+            case ExecutionStatus::Deadlocked:
+                ++cell.deadlockedRuns;
+                break;
+            case ExecutionStatus::Livelocked:
+                ++cell.livelockedRuns;
+                break;
+            case ExecutionStatus::StepLimitExceeded:
+                ++cell.truncatedRuns;
+                break;
+        }
+        if (!cell.firstStuckRun) {
+            cell.firstStuckRun = {firstRun + i, {*run.status, run.steps, {}}};
+        }
+    }
+}
+
+BatchResult BatchRunner::run(const std::vector<LitmusTest> &tests) const {
+    BatchResult result;
+    result.models = m_config.models;
+    result.cells.assign(tests.size(),
+                        std::vector<BatchCell>(m_config.models.size()));
+    for (const auto &test: tests) { result.testNames.push_back(test.name); }
+    auto runTests = tests;
+    if (m_config.optimize) {
+        for (auto &test: runTests) {
+            test.programs = program::Optimizer::optimize(test.programs);
+        }
+    }
+
+    std::vector<Job> jobs;
+    for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex) {
+        for (size_t modelIndex = 0; modelIndex < m_config.models.size();
+             ++modelIndex) {
+            // A lockstep job fills all lanes
+            size_t runsPerJob = isLockstep(m_config.models[modelIndex])
+                                        ? m_config.lockstepLanes
+                                        : RUNS_PER_JOB;
+            for (size_t run = 0; run < m_config.runsPerModel;
+                 run += runsPerJob) {
+                jobs.push_back({testIndex, modelIndex, run,
+                                std::min(run + runsPerJob,
+                                         m_config.runsPerModel)});
+            }
+        }
+    }
+
+    std::atomic<size_t> nextJob = 0;
+    std::mutex resultMutex;
+    auto worker = [&]() {
+        while (true) {
+            size_t jobIndex = nextJob++;
+            if (jobIndex >= jobs.size()) { return; }
+            const auto &job = jobs[jobIndex];
+            BatchCell cell;
+            std::string records;
+            try {
+                if (isLockstep(m_config.models[job.modelIndex])) {
+                    runLockstep(runTests[job.testIndex], job.testIndex,
+                                job.modelIndex, job.firstRun, job.lastRun,
+                                cell, records);
+                } else {
+                    auto context =
+                            makeContext(runTests[job.testIndex],
+                                        m_config.models[job.modelIndex]);
+                    for (size_t run = job.firstRun; run < job.lastRun;
+                         ++run) {
+                        runSingle(context, run,
+                                  runSeed(m_config.seed, job.testIndex,
+                                          job.modelIndex, run),
+                                  cell, records);
+                    }
+                    cell.statistics = context.executor->getStatistics();
+                }
+            } catch (const std::exception &) {
+                cell.failedRuns += job.lastRun - job.firstRun;
+            }
+            if (!records.empty()) { m_config.records->write(records); }
+            std::lock_guard lock(resultMutex);
+            result.cells[job.testIndex][job.modelIndex].merge(cell);
+        }
+    };
+
+    size_t nOfWorkers = m_config.nOfWorkers;
+    if (nOfWorkers == 0) {
+        nOfWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nOfWorkers = std::min(nOfWorkers, std::max<size_t>(jobs.size(), 1));
+    std::vector<std::thread> workers;
+    workers.reserve(nOfWorkers);
+    for (size_t i = 0; i < nOfWorkers; ++i) { workers.emplace_back(worker); }
+    for (auto &thread: workers) { thread.join(); }
+
+    if (m_config.records && m_config.recordOutcomes) {
+        for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex) {
+            for (size_t modelIndex = 0; modelIndex < m_config.models.size();
+                 ++modelIndex) {
+                ExecutionRecord record;
+                record.test = tests[testIndex].name;
+                record.model = m_config.models[modelIndex];
+                for (const auto &outcome:
+                     result.cells[testIndex][modelIndex].outcomes) {
+                    record.outcome = outcome;
+                    m_config.records->write(record);
+                }
+            }
+        }
+    }
+    if (m_config.records) { m_config.records->flush(); }
+    return result;
+}
+
+void BatchResult::writeMatrix(std::ostream &outputStream) const {
+    size_t nameWidth = 4;
+    for (const auto &name: testNames) {
+        nameWidth = std::max(nameWidth, name.size());
+    }
+    outputStream << std::string("test") + std::string(nameWidth - 4, ' ');
+    for (auto model: models) {
+        outputStream << std::format(" {:>8}", toString(model));
+    }
+    outputStream << '\n';
+    for (size_t testIndex = 0; testIndex < testNames.size(); ++testIndex) {
+        const auto &name = testNames[testIndex];
+        outputStream << name + std::string(nameWidth - name.size(), ' ');
+        for (const auto &cell: cells[testIndex]) {
+            std::string marker =
+                    (cell.completedRuns < cell.runs()) ? "*" : "";
+            outputStream << std::format(
+                    " {:>8}", std::to_string(cell.outcomes.size()) + marker);
+        }
+        outputStream << '\n';
+    }
+}
+
+StatisticsReport BatchResult::getStatisticsReport() const {
+    StatisticsReport report;
+    for (size_t modelIndex = 0; modelIndex < models.size(); ++modelIndex) {
+        ExecutionStatistics statistics;
+        for (const auto &row: cells) {
+            statistics.merge(row[modelIndex].statistics);
+        }
+        report.entries.emplace_back(toString(models[modelIndex]), statistics);
+    }
+    return report;
+}
+
+void BatchResult::writeOutcomes(std::ostream &outputStream) const {
+    for (size_t testIndex = 0; testIndex < testNames.size(); ++testIndex) {
+        outputStream << "== " << testNames[testIndex] << '\n';
+        for (size_t modelIndex = 0; modelIndex < models.size(); ++modelIndex) {
+            const auto &cell = cells[testIndex][modelIndex];
+            outputStream << std::format(
+                    "-- {}: {} completed, {} truncated, {} deadlocked, {} "
+                    "livelocked, {} failed\n",
+                    toString(models[modelIndex]), cell.completedRuns,
+                    cell.truncatedRuns, cell.deadlockedRuns,
+                    cell.livelockedRuns, cell.failedRuns);
+            for (const auto &outcome: cell.outcomes) {
+                outputStream << "   " << outcome.str() << '\n';
+            }
+            if (cell.firstStuckRun) {
+                const auto &[run, report] = cell.firstStuckRun.value();
+                outputStream << std::format(
+                        "   run {} is {} after {} steps:\n{}", run,
+                        toString(report.status), report.steps,
+                        report.snapshot);
+            }
+        }
+    }
+}
+
+} // namespace wmm::execution
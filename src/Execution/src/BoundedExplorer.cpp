@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "BoundedExplorer.h"
+#include "Footprint.h"
+#include "Optimizer.h"
+
+namespace wmm::execution {
+
+namespace {
+/** Storage manager and executor that are reset for every execution */
+struct Context {
+    storage::ChoiceSequencePtr choices;
+    storage::StorageManagerPtr storageManager;
+    std::unique_ptr<BoundedExecutor> executor;
+    // Fields of the records of the executions, and the formatted records
+    // that weren't handed over to the writer yet
+    ExecutionRecord record;
+    std::string records;
+};
+
+std::vector<Context>
+makeContexts(const BoundedExplorer::Config &config,
+             const std::vector<program::Program> &programs, MemoryModel model,
+             BoundedExecutor::Bound bound, size_t nOfContexts) {
+    std::vector<std::vector<bool>> commutingAccesses;
+    if (config.skipCommutingAccesses) {
+        commutingAccesses = program::findCommutingAccesses(
+                programs, program::analyzeFootprints(programs));
+    }
+    auto layout =
+            std::make_shared<const MemoryLayout>(programs, config.storageSize);
+    std::vector<Context> contexts(nOfContexts);
+    for (auto &context: contexts) {
+        context.choices = std::make_shared<storage::ChoiceSequence>();
+        context.storageManager = makeStorageManager(
+                model, ExecutionMode::Enumerate,
+                layout->getSharedStorageSize(), programs.size(), 0,
+                std::make_unique<storage::FakeStorageLogger>(),
+                context.choices);
+        context.executor = std::make_unique<BoundedExecutor>(
+                programs, context.storageManager,
+                config.threadLocalStorageSize, context.choices, bound,
+                commutingAccesses, layout);
+        context.record.test = config.recordName;
+        context.record.model = model;
+        context.record.bound = bound;
+    }
+    return contexts;
+}
+
+/**
+ * Run the execution the current choice sequence of the context describes
+ */
+void runExecution(Context &context, const BoundedExplorer::Config &config,
+                  BoundedExplorer::Round &round,
+                  BoundedExplorer::Result &result) {
+    auto &executor = *context.executor;
+    auto &record = context.record;
+    record.status.reset();
+    record.steps.reset();
+    record.outcome.reset();
+    try {
+        context.storageManager->reset(0);
+        executor.reset(0);
+        // The schedule isn't fair, so livelocks are not detected: an
+        // unfair infinite execution just runs into the step limit
+        auto report = Watchdog({config.maxSteps, 0}).run(executor);
+        if (executor.isPruned()) { round.isComplete = false; }
+        record.status = report.status;
+        record.steps = report.steps;
+        switch (report.status) {
+            case ExecutionStatus::Completed:
+                record.outcome = executor.getOutcome();
+                result.outcomes.insert(*record.outcome);
+                break;
+            case ExecutionStatus::Deadlocked:
+                ++result.deadlockedExecutions;
+                break;
+            default:
+                ++result.truncatedExecutions;
+                break;
+        }
+    } catch (const std::exception &) { ++result.failedExecutions; }
+    if (config.records) {
+        record.choices = context.choices->getTakenOptions();
+        config.records->format(record, context.records);
+    }
+}
+
+/**
+ * Hand the records of the context over to the writer, unless there are few
+ */
+void writeRecords(Context &context, const BoundedExplorer::Config &config,
+                  bool isForced) {
+    if (!config.records ||
+        (!isForced &&
+         context.records.size() < config.records->getBufferSize())) {
+        return;
+    }
+    config.records->write(context.records);
+    context.records.clear();
+}
+
+/**
+ * Choice sequences split off by busy workers for the idle ones
+ */
+struct WorkQueue {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<storage::ChoiceSequence> sequences;
+    // Only changed with the mutex held, busy workers read it without it
+    std::atomic<size_t> nOfIdle = 0;
+    bool isDone = false;
+    std::atomic<size_t> executions = 0;
+    std::atomic<bool> isCut = false;
+};
+} // namespace
+
+BoundedExplorer::Result
+BoundedExplorer::explore(const std::vector<program::Program> &programs,
+                         MemoryModel model) const {
+    Result result;
+    auto explored = m_config.optimize ? program::Optimizer::optimize(programs)
+                                      : programs;
+    size_t nOfWorkers = m_config.nOfWorkers;
+    if (nOfWorkers == 0) {
+        nOfWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t maxBound = std::max(m_config.maxPreemptions, m_config.maxDelays);
+    for (size_t bound = 0; bound <= maxBound; ++bound) {
+        BoundedExecutor::Bound roundBound = {
+                std::min(bound, m_config.maxPreemptions),
+                std::min(bound, m_config.maxDelays)};
+        std::optional<Round> round;
+        if (nOfWorkers > 1) {
+            round = exploreRoundInParallel(explored, model, roundBound,
+                                           nOfWorkers, result);
+            // Deeper rounds have at least as many executions
+            if (!round) { nOfWorkers = 1; }
+        }
+        if (!round) {
+            round = exploreRound(explored, model, roundBound, result);
+        }
+        result.rounds.push_back(*round);
+        if (round->isComplete) {
+            result.isExhaustive = true;
+            break;
+        }
+    }
+    if (m_config.records) { m_config.records->flush(); }
+    return result;
+}
+
+BoundedExplorer::Round
+BoundedExplorer::exploreRound(const std::vector<program::Program> &programs,
+                              MemoryModel model, BoundedExecutor::Bound bound,
+                              Result &result) const {
+    Round round{bound};
+    auto contexts = makeContexts(m_config, programs, model, bound, 1);
+    auto &context = contexts[0];
+    size_t nOfOutcomes = result.outcomes.size();
+    do {
+        ++round.executions;
+        runExecution(context, m_config, round, result);
+        writeRecords(context, m_config, false);
+        if (round.executions >= m_config.maxExecutionsPerRound) {
+            round.isComplete = false;
+            break;
+        }
+    } while (context.choices->next());
+    writeRecords(context, m_config, true);
+    round.newOutcomes = result.outcomes.size() - nOfOutcomes;
+    result.statistics.merge(context.executor->getStatistics());
+    return round;
+}
+
+std::optional<BoundedExplorer::Round> BoundedExplorer::exploreRoundInParallel(
+        const std::vector<program::Program> &programs, MemoryModel model,
+        BoundedExecutor::Bound bound, size_t nOfWorkers, Result &result) const {
+    auto contexts = makeContexts(m_config, programs, model, bound, nOfWorkers);
+    std::vector<Round> rounds(nOfWorkers, Round{bound});
+    std::vector<Result> results(nOfWorkers);
+    WorkQueue queue;
+
+    auto donate = [&](storage::ChoiceSequence &choices) {
+        std::lock_guard lock(queue.mutex);
+        if (queue.sequences.size() >= queue.nOfIdle) { return; }
+        if (auto other = choices.split()) {
+            queue.sequences.push_back(std::move(*other));
+            queue.condition.notify_one();
+        }
+    };
+    auto cut = [&] {
+        queue.isCut = true;
+        std::lock_guard lock(queue.mutex);
+        queue.isDone = true;
+        queue.condition.notify_all();
+    };
+    auto worker = [&](size_t workerIndex) {
+        auto &context = contexts[workerIndex];
+        // The first worker starts with the whole tree of choices
+        bool hasSequence = workerIndex == 0;
+        while (!queue.isCut) {
+            if (!hasSequence) {
+                std::unique_lock lock(queue.mutex);
+                ++queue.nOfIdle;
+                if (queue.nOfIdle == nOfWorkers && queue.sequences.empty()) {
+                    queue.isDone = true;
+                    queue.condition.notify_all();
+                }
+                queue.condition.wait(lock, [&] {
+                    return queue.isDone || !queue.sequences.empty();
+                });
+                if (queue.isDone) { return; }
+                *context.choices = std::move(queue.sequences.back());
+                queue.sequences.pop_back();
+                --queue.nOfIdle;
+            }
+            hasSequence = false;
+            while (!queue.isCut) {
+                if (queue.executions.fetch_add(1) + 1 >=
+                    m_config.maxExecutionsPerRound) {
+                    cut();
+                    return;
+                }
+                ++rounds[workerIndex].executions;
+                runExecution(context, m_config, rounds[workerIndex],
+                             results[workerIndex]);
+                // Without a limit the round is never explored again
+                if (m_config.maxExecutionsPerRound == SIZE_MAX) {
+                    writeRecords(context, m_config, false);
+                }
+                if (!context.choices->next()) { break; }
+                if (queue.nOfIdle > 0) { donate(*context.choices); }
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(nOfWorkers);
+    for (size_t i = 0; i < nOfWorkers; ++i) { workers.emplace_back(worker, i); }
+    for (auto &thread: workers) { thread.join(); }
+    if (queue.isCut) { return std::nullopt; }
+
+    Round round{bound};
+    size_t nOfOutcomes = result.outcomes.size();
+    for (size_t i = 0; i < nOfWorkers; ++i) {
+        writeRecords(contexts[i], m_config, true);
+        round.executions += rounds[i].executions;
+        round.isComplete = round.isComplete && rounds[i].isComplete;
+        result.outcomes.insert(results[i].outcomes.begin(),
+                               results[i].outcomes.end());
+        result.truncatedExecutions += results[i].truncatedExecutions;
+        result.deadlockedExecutions += results[i].deadlockedExecutions;
+        result.failedExecutions += results[i].failedExecutions;
+        result.statistics.merge(contexts[i].executor->getStatistics());
+    }
+    round.newOutcomes = result.outcomes.size() - nOfOutcomes;
+    return round;
+}
+
+} // namespace wmm::execution
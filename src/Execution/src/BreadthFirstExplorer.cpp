@@ -0,0 +1,520 @@
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <queue>
+#include <random>
+#include <tuple>
+
+#include "BreadthFirstExplorer.h"
+#include "Executor.h"
+#include "Footprint.h"
+#include "Optimizer.h"
+#include "Util.h"
+
+namespace wmm::execution {
+
+namespace {
+namespace fs = std::filesystem;
+
+/**
+ * What tells the nodes apart. With an encoded state the node is the state
+ * before a step and the choices already made in the step, otherwise only
+ * the hash of these is known.
+ */
+struct Key {
+    uint64_t hash = 0;
+    storage::PackedState state;
+    std::vector<uint32_t> stepChoices;
+
+    auto operator<=>(const Key &other) const = default;
+};
+
+/**
+ * Execution stopped right before a choice with nOfOptions options
+ */
+struct Node {
+    Key key;
+    uint32_t nOfOptions = 0;
+    // Choices to replay from the encoded state, or from the start if there
+    // is none
+    std::vector<uint32_t> path;
+
+    // Equal keys are ordered by the path, so the node that is kept doesn't
+    // depend on the runs
+    bool operator<(const Node &other) const {
+        return std::tie(key, path) < std::tie(other.key, other.path);
+    }
+
+    [[nodiscard]] size_t getSize() const {
+        return sizeof(Node) + key.state.getBytes().size() +
+               (key.stepChoices.size() + path.size()) * sizeof(uint32_t);
+    }
+};
+
+template<class T>
+void writeValue(std::ostream &stream, const T &value) {
+    stream.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template<class T>
+bool readValue(std::istream &stream, T &value) {
+    return static_cast<bool>(
+            stream.read(reinterpret_cast<char *>(&value), sizeof(T)));
+}
+
+template<class T>
+void writeVector(std::ostream &stream, const std::vector<T> &values) {
+    writeValue(stream, static_cast<uint32_t>(values.size()));
+    stream.write(reinterpret_cast<const char *>(values.data()),
+                 static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+template<class T>
+bool readVector(std::istream &stream, std::vector<T> &values) {
+    uint32_t size = 0;
+    if (!readValue(stream, size)) { return false; }
+    values.resize(size);
+    return static_cast<bool>(
+            stream.read(reinterpret_cast<char *>(values.data()),
+                        static_cast<std::streamsize>(size * sizeof(T))));
+}
+
+void writeKey(std::ostream &stream, const Key &key) {
+    writeValue(stream, key.hash);
+    writeVector(stream, key.state.getBytes());
+    writeVector(stream, key.stepChoices);
+}
+
+bool readKey(std::istream &stream, Key &key) {
+    std::vector<uint8_t> bytes;
+    if (!readValue(stream, key.hash) || !readVector(stream, bytes) ||
+        !readVector(stream, key.stepChoices)) {
+        return false;
+    }
+    key.state = storage::PackedState(std::move(bytes));
+    return true;
+}
+
+void writeNode(std::ostream &stream, const Node &node) {
+    writeKey(stream, node.key);
+    writeValue(stream, node.nOfOptions);
+    writeVector(stream, node.path);
+}
+
+bool readNode(std::istream &stream, Node &node) {
+    return readKey(stream, node.key) && readValue(stream, node.nOfOptions) &&
+           readVector(stream, node.path);
+}
+
+/**
+ * New directory that is removed with everything in it at the end
+ */
+class ScratchDirectory {
+    fs::path m_path;
+
+public:
+    explicit ScratchDirectory(const fs::path &parent) {
+        std::random_device device;
+        fs::create_directories(parent);
+        do {
+            m_path = parent / std::format("wmm_frontier_{}", device());
+        } while (!fs::create_directory(m_path));
+    }
+
+    ScratchDirectory(const ScratchDirectory &) = delete;
+    ScratchDirectory &operator=(const ScratchDirectory &) = delete;
+
+    ~ScratchDirectory() {
+        std::error_code error;
+        fs::remove_all(m_path, error);
+    }
+
+    [[nodiscard]] fs::path operator/(const std::string &name) const {
+        return m_path / name;
+    }
+};
+
+/**
+ * Collects the nodes of a level and writes them to sorted runs whenever they
+ * take more memory than allowed
+ */
+class RunWriter {
+    const ScratchDirectory &m_directory;
+    size_t m_memoryLimit;
+    std::vector<Node> m_nodes;
+    size_t m_size = 0;
+    std::vector<fs::path> m_runs;
+
+    void flush() {
+        if (m_nodes.empty()) { return; }
+        std::sort(m_nodes.begin(), m_nodes.end());
+        auto path = m_directory / std::format("run_{}", m_runs.size());
+        std::ofstream stream(path, std::ios::binary);
+        for (const auto &node: m_nodes) { writeNode(stream, node); }
+        if (!stream) { throw std::runtime_error("Failed to write a run"); }
+        m_runs.push_back(path);
+        m_nodes.clear();
+        m_size = 0;
+    }
+
+public:
+    RunWriter(const ScratchDirectory &directory, size_t memoryLimit)
+        : m_directory(directory), m_memoryLimit(memoryLimit) {}
+
+    void add(Node node) {
+        m_size += node.getSize();
+        m_nodes.push_back(std::move(node));
+        if (m_size >= m_memoryLimit) { flush(); }
+    }
+
+    std::vector<fs::path> finish() {
+        flush();
+        return std::move(m_runs);
+    }
+};
+
+/**
+ * Keys of the visited states as sorted runs of disjoint keys, one per level.
+ * A run is merged with the one before it while that one has no more keys,
+ * so there are O(log states) runs and a key is rewritten as often.
+ */
+class VisitedSet {
+public:
+    struct Run {
+        fs::path path;
+        size_t keys = 0;
+    };
+
+private:
+    const ScratchDirectory &m_directory;
+    std::vector<Run> m_runs;
+    size_t m_nOfFiles = 0;
+
+    void mergeLastRuns() {
+        auto right = std::move(m_runs.back());
+        m_runs.pop_back();
+        auto left = std::move(m_runs.back());
+        m_runs.pop_back();
+        Run merged{getNextPath(), left.keys + right.keys};
+        std::ifstream leftStream(left.path, std::ios::binary);
+        std::ifstream rightStream(right.path, std::ios::binary);
+        std::ofstream stream(merged.path, std::ios::binary);
+        Key leftKey;
+        Key rightKey;
+        bool hasLeft = readKey(leftStream, leftKey);
+        bool hasRight = readKey(rightStream, rightKey);
+        while (hasLeft || hasRight) {
+            if (!hasRight || (hasLeft && leftKey < rightKey)) {
+                writeKey(stream, leftKey);
+                hasLeft = readKey(leftStream, leftKey);
+            } else {
+                writeKey(stream, rightKey);
+                hasRight = readKey(rightStream, rightKey);
+            }
+        }
+        if (!stream) {
+            throw std::runtime_error("Failed to write the visited set");
+        }
+        leftStream.close();
+        rightStream.close();
+        fs::remove(left.path);
+        fs::remove(right.path);
+        m_runs.push_back(std::move(merged));
+    }
+
+public:
+    explicit VisitedSet(const ScratchDirectory &directory)
+        : m_directory(directory) {}
+
+    [[nodiscard]] fs::path getNextPath() {
+        return m_directory / std::format("visited_{}", m_nOfFiles++);
+    }
+
+    [[nodiscard]] const std::vector<Run> &getRuns() const { return m_runs; }
+
+    /** Takes over the run of new keys written to a path from getNextPath */
+    void add(Run run) {
+        if (run.keys == 0) {
+            fs::remove(run.path);
+            return;
+        }
+        m_runs.push_back(std::move(run));
+        while (m_runs.size() > 1 &&
+               m_runs[m_runs.size() - 2].keys <= m_runs.back().keys) {
+            mergeLastRuns();
+        }
+    }
+};
+
+/**
+ * Merges the sorted runs into the frontier of the next level. Repeated nodes
+ * and nodes whose key is in the visited set are dropped, the keys of the
+ * others are added to the set as a new run.
+ */
+BreadthFirstExplorer::Level mergeRuns(const std::vector<fs::path> &runs,
+                                      VisitedSet &visited,
+                                      const fs::path &frontierPath) {
+    BreadthFirstExplorer::Level level;
+    level.runs = runs.size();
+    std::vector<std::ifstream> streams;
+    std::vector<Node> heads(runs.size());
+    auto isAfter = [&](size_t left, size_t right) {
+        return heads[right] < heads[left];
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(isAfter)> queue(
+            isAfter);
+    for (size_t i = 0; i < runs.size(); ++i) {
+        streams.emplace_back(runs[i], std::ios::binary);
+        if (readNode(streams[i], heads[i])) { queue.push(i); }
+    }
+
+    // The nodes come sorted, so every visited run is read once
+    const auto &visitedRuns = visited.getRuns();
+    std::vector<std::ifstream> visitedStreams;
+    std::vector<std::optional<Key>> visitedKeys(visitedRuns.size());
+    for (size_t i = 0; i < visitedRuns.size(); ++i) {
+        visitedStreams.emplace_back(visitedRuns[i].path, std::ios::binary);
+        visitedKeys[i].emplace();
+        if (!readKey(visitedStreams[i], *visitedKeys[i])) {
+            visitedKeys[i].reset();
+        }
+    }
+    auto isVisited = [&](const Key &key) {
+        for (size_t i = 0; i < visitedKeys.size(); ++i) {
+            auto &visitedKey = visitedKeys[i];
+            while (visitedKey && *visitedKey < key) {
+                if (!readKey(visitedStreams[i], *visitedKey)) {
+                    visitedKey.reset();
+                }
+            }
+            if (visitedKey == key) { return true; }
+        }
+        return false;
+    };
+
+    VisitedSet::Run newKeys{visited.getNextPath()};
+    std::ofstream nextVisited(newKeys.path, std::ios::binary);
+    std::ofstream frontier(frontierPath, std::ios::binary);
+    std::optional<Key> lastKey;
+    while (!queue.empty()) {
+        size_t run = queue.top();
+        queue.pop();
+        const auto &node = heads[run];
+        if (node.key == lastKey || isVisited(node.key)) {
+            ++level.duplicates;
+        } else {
+            writeNode(frontier, node);
+            writeKey(nextVisited, node.key);
+            lastKey = node.key;
+            ++level.states;
+        }
+        if (readNode(streams[run], heads[run])) { queue.push(run); }
+    }
+    if (!frontier || !nextVisited) {
+        throw std::runtime_error("Failed to write the frontier");
+    }
+    visitedStreams.clear();
+    nextVisited.close();
+    newKeys.keys = level.states;
+    visited.add(std::move(newKeys));
+    for (const auto &run: runs) { fs::remove(run); }
+    return level;
+}
+
+/**
+ * Adds the outcome with the registers of every class of symmetric threads
+ * (see program::findSymmetricThreads) in every order, starting from the
+ * class of the given thread
+ */
+void addOutcomes(Outcome outcome, const std::vector<size_t> &symmetricThreads,
+                 std::set<Outcome> &outcomes, size_t first = 0) {
+    while (first < symmetricThreads.size() &&
+           symmetricThreads[first] != first) {
+        ++first;
+    }
+    if (first >= symmetricThreads.size()) {
+        outcomes.insert(std::move(outcome));
+        return;
+    }
+    std::vector<size_t> members;
+    std::vector<std::vector<int32_t>> registers;
+    for (size_t threadId = first; threadId < symmetricThreads.size();
+         ++threadId) {
+        if (symmetricThreads[threadId] == first) {
+            members.push_back(threadId);
+            registers.push_back(outcome.threadLocalStorages[threadId]);
+        }
+    }
+    std::sort(registers.begin(), registers.end());
+    do {
+        for (size_t i = 0; i < members.size(); ++i) {
+            outcome.threadLocalStorages[members[i]] = registers[i];
+        }
+        addOutcomes(outcome, symmetricThreads, outcomes, first + 1);
+    } while (std::next_permutation(registers.begin(), registers.end()));
+}
+
+/** Storage manager and executor that are reset for every replay */
+struct Context {
+    storage::ChoiceSequencePtr choices;
+    storage::StorageManagerPtr storageManager;
+    std::unique_ptr<BoundedExecutor> executor;
+    // Empty if no threads are treated as symmetric
+    std::vector<size_t> symmetricThreads;
+};
+
+/**
+ * Restores the state, replays the path and runs the execution up to the
+ * next choice. Without an encoded state the path is replayed from the start.
+ * Symmetric threads are renumbered before every step, so the encoded states
+ * are canonical and the choices of the step refer to the renumbered threads.
+ *
+ * @return the node before the choice, std::nullopt if the execution ended
+ */
+std::optional<Node> advance(Context &context,
+                            const storage::PackedState &state,
+                            std::vector<uint32_t> path, size_t maxSteps,
+                            BreadthFirstExplorer::Result &result) {
+    auto &executor = *context.executor;
+    auto &choices = *context.choices;
+    bool canEncodeState = executor.canEncodeState();
+    auto encodeState = [&context, &executor] {
+        if (!context.symmetricThreads.empty()) {
+            executor.canonicalizeThreads(context.symmetricThreads);
+        }
+        return executor.encodeState();
+    };
+    try {
+        choices.replay(path);
+        context.storageManager->reset(0);
+        executor.reset(0);
+        if (!state.empty()) { executor.decodeState(state); }
+        // State before the current step
+        Key key;
+        if (canEncodeState) {
+            key.state = state.empty() ? encodeState() : state;
+        } else {
+            key.hash = executor.hashState();
+        }
+        size_t stepStart = 0;
+        size_t steps = 0;
+        while (true) {
+            bool isExecuted = executor.execute();
+            if (size_t nOfOptions = choices.getNOfOpenOptions()) {
+                // A step can make several choices, the ones made before the
+                // open one belong to the node as well
+                key.stepChoices.assign(path.begin() + stepStart, path.end());
+                if (canEncodeState) {
+                    key.hash = key.state.hash();
+                    path = key.stepChoices;
+                }
+                for (auto choice: key.stepChoices) {
+                    util::hashCombine(key.hash, choice);
+                }
+                if (!canEncodeState) { key.stepChoices.clear(); }
+                return Node{std::move(key),
+                            static_cast<uint32_t>(nOfOptions),
+                            std::move(path)};
+            }
+            if (!isExecuted) { break; }
+            if (++steps > maxSteps) {
+                ++result.truncatedExecutions;
+                return std::nullopt;
+            }
+            if (canEncodeState) {
+                key.state = encodeState();
+            } else {
+                key.hash = executor.hashState();
+            }
+            if (choices.getPosition() != stepStart) { steps = 0; }
+            stepStart = choices.getPosition();
+        }
+        if (executor.isFinished()) {
+            addOutcomes(executor.getOutcome(), context.symmetricThreads,
+                        result.outcomes);
+        } else {
+            ++result.deadlockedExecutions;
+        }
+    } catch (const std::exception &) { ++result.failedExecutions; }
+    return std::nullopt;
+}
+} // namespace
+
+BreadthFirstExplorer::Result
+BreadthFirstExplorer::explore(const std::vector<program::Program> &programs,
+                              MemoryModel model) const {
+    Result result;
+    auto explored = m_config.optimize ? program::Optimizer::optimize(programs)
+                                      : programs;
+    std::vector<std::vector<bool>> commutingAccesses;
+    if (m_config.skipCommutingAccesses) {
+        commutingAccesses = program::findCommutingAccesses(
+                explored, program::analyzeFootprints(explored));
+    }
+    auto layout = std::make_shared<const MemoryLayout>(explored,
+                                                       m_config.storageSize);
+    Context context;
+    context.choices = std::make_shared<storage::ChoiceSequence>();
+    context.storageManager = makeStorageManager(
+            model, ExecutionMode::Enumerate, layout->getSharedStorageSize(),
+            explored.size(), 0, std::make_unique<storage::FakeStorageLogger>(),
+            context.choices);
+    // Every state is expanded once, so nothing is pruned by bounds
+    context.executor = std::make_unique<BoundedExecutor>(
+            explored, context.storageManager, m_config.threadLocalStorageSize,
+            context.choices, BoundedExecutor::Bound{SIZE_MAX, SIZE_MAX},
+            std::move(commutingAccesses), layout);
+    if (m_config.reduceSymmetry && context.executor->canEncodeState()) {
+        auto symmetricThreads = program::findSymmetricThreads(explored);
+        for (size_t threadId = 0; threadId < explored.size(); ++threadId) {
+            if (symmetricThreads[threadId] != threadId) {
+                context.symmetricThreads = std::move(symmetricThreads);
+                break;
+            }
+        }
+    }
+
+    ScratchDirectory directory(m_config.directory);
+    VisitedSet visited(directory);
+    RunWriter writer(directory, m_config.memoryLimit);
+    if (auto root = advance(context, {}, {}, m_config.maxSteps, result)) {
+        writer.add(std::move(*root));
+    }
+    auto frontierPath = directory / "frontier_0";
+    auto level = mergeRuns(writer.finish(), visited, frontierPath);
+    while (level.states > 0) {
+        result.levels.push_back(level);
+        result.states += level.states;
+        RunWriter nextWriter(directory, m_config.memoryLimit);
+        {
+            std::ifstream frontier(frontierPath, std::ios::binary);
+            Node node;
+            while (readNode(frontier, node)) {
+                if (result.levels.size() > m_config.maxDepth) {
+                    ++result.truncatedExecutions;
+                    continue;
+                }
+                for (uint32_t option = 0; option < node.nOfOptions;
+                     ++option) {
+                    auto path = node.path;
+                    path.push_back(option);
+                    if (auto child = advance(context, node.key.state,
+                                             std::move(path),
+                                             m_config.maxSteps, result)) {
+                        nextWriter.add(std::move(*child));
+                    }
+                }
+            }
+        }
+        fs::remove(frontierPath);
+        frontierPath = directory /
+                       std::format("frontier_{}", result.levels.size());
+        level = mergeRuns(nextWriter.finish(), visited, frontierPath);
+    }
+    result.isExhaustive = result.truncatedExecutions == 0;
+    result.statistics.merge(context.executor->getStatistics());
+    return result;
+}
+
+} // namespace wmm::execution
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <thread>
+
+#include "DifferentialChecker.h"
+
+namespace wmm::execution {
+
+DifferentialChecker::DifferentialChecker(Config config)
+    : m_config(std::move(config)) {
+    for (const auto &inclusion: m_config.inclusions) {
+        for (auto model: {inclusion.stronger, inclusion.weaker}) {
+            if (std::find(m_models.begin(), m_models.end(), model) ==
+                m_models.end()) {
+                m_models.push_back(model);
+            }
+        }
+    }
+    m_config.sampling.models = m_models;
+    m_config.sampling.nOfWorkers = m_config.nOfWorkers;
+}
+
+DifferentialChecker::Result
+DifferentialChecker::check(const std::vector<LitmusTest> &tests) const {
+    auto sampled = BatchRunner(m_config.sampling).run(tests);
+
+    // explored[testIndex][modelIndex]
+    std::vector<std::vector<BoundedExplorer::Result>> explored(
+            tests.size(),
+            std::vector<BoundedExplorer::Result>(m_models.size()));
+    std::atomic<size_t> nextJob = 0;
+    size_t nOfJobs = tests.size() * m_models.size();
+    auto worker = [&]() {
+        BoundedExplorer explorer(m_config.exploration);
+        while (true) {
+            size_t job = nextJob++;
+            if (job >= nOfJobs) { return; }
+            size_t testIndex = job / m_models.size();
+            size_t modelIndex = job % m_models.size();
+            explored[testIndex][modelIndex] = explorer.explore(
+                    tests[testIndex].programs, m_models[modelIndex]);
+        }
+    };
+    size_t nOfWorkers = m_config.nOfWorkers;
+    if (nOfWorkers == 0) {
+        nOfWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    nOfWorkers = std::min(nOfWorkers, std::max<size_t>(nOfJobs, 1));
+    std::vector<std::thread> workers;
+    workers.reserve(nOfWorkers);
+    for (size_t i = 0; i < nOfWorkers; ++i) { workers.emplace_back(worker); }
+    for (auto &thread: workers) { thread.join(); }
+
+    auto modelIndex = [this](MemoryModel model) {
+        return std::find(m_models.begin(), m_models.end(), model) -
+               m_models.begin();
+    };
+    Result result;
+    for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex) {
+        for (const auto &inclusion: m_config.inclusions) {
+            auto stronger = modelIndex(inclusion.stronger);
+            auto weaker = modelIndex(inclusion.weaker);
+            auto strongerOutcomes = sampled.cells[testIndex][stronger].outcomes;
+            strongerOutcomes.merge(explored[testIndex][stronger].outcomes);
+            auto weakerOutcomes = sampled.cells[testIndex][weaker].outcomes;
+            const auto &exploration = explored[testIndex][weaker];
+            weakerOutcomes.insert(exploration.outcomes.begin(),
+                                  exploration.outcomes.end());
+            // Truncated or failed executions may hide outcomes
+            bool isComplete = exploration.isExhaustive &&
+                              exploration.truncatedExecutions == 0 &&
+                              exploration.failedExecutions == 0;
+
+            ++result.checks;
+            bool isInconclusive = false;
+            for (const auto &outcome: strongerOutcomes) {
+                if (weakerOutcomes.count(outcome) > 0) { continue; }
+                if (!isComplete) {
+                    isInconclusive = true;
+                    continue;
+                }
+                result.violations.push_back(
+                        {tests[testIndex].name, inclusion, outcome});
+            }
+            if (isInconclusive) { ++result.inconclusiveChecks; }
+        }
+    }
+    return result;
+}
+
+void DifferentialChecker::Result::write(std::ostream &outputStream) const {
+    outputStream << std::format(
+            "{} checks, {} violations, {} inconclusive\n", checks,
+            violations.size(), inconclusiveChecks);
+    for (const auto &violation: violations) {
+        outputStream << std::format(
+                "{}: {} outcome is not reachable under {}\n  {}\n",
+                violation.testName, toString(violation.inclusion.stronger),
+                toString(violation.inclusion.weaker),
+                violation.outcome.str());
+    }
+}
+
+} // namespace wmm::execution
@@ -7,21 +7,14 @@
 #include <sstream>
 
 #include "Executor.h"
+#include "StorageManagers.h"
+#include "Util.h"
 
 namespace wmm::execution {
 
-bool RandomExecutor::executeThread() {
-    auto unfinishedThreads = m_threadManager.unfinishedThreads();
-    if (unfinishedThreads.empty()) { return false; }
-    std::shuffle(unfinishedThreads.begin(), unfinishedThreads.end(),
-                 m_randomGenerator);
-    for (auto threadId: unfinishedThreads) {
-        if (m_threadManager.evaluateThread(threadId)) { return true; }
-    }
-    throw std::runtime_error("All threads are blocked");
-}
-
-void RandomExecutor::writeState(std::ostream &outputStream) const {
+template<class StorageManager>
+void BasicExecutor<StorageManager>::writeState(
+        std::ostream &outputStream) const {
     m_storageManager->writeStorage(outputStream);
     auto localStorages = m_threadManager.getThreadLocalStorages();
     outputStream << "Thread-local storages:\n";
@@ -31,18 +24,209 @@ void RandomExecutor::writeState(std::ostream &outputStream) const {
         for (auto elm: storage) { outputStream << elm << ' '; }
         outputStream << '\n';
     }
+    if (m_layout) {
+        // The storage manager only shows the shared locations, renumbered
+        outputStream << "All locations: "
+                     << util::join(getOutcome().sharedStorage) << '\n';
+    }
+}
+
+template<class StorageManager>
+Outcome BasicExecutor<StorageManager>::getOutcome() const {
+    Outcome outcome{m_storageManager->getSharedStorage(), {}};
+    if (m_layout) {
+        std::vector<const storage::Storage *> privateStorages;
+        for (size_t threadId = 0; threadId < m_threadManager.size();
+             ++threadId) {
+            privateStorages.push_back(
+                    &m_threadManager.getPrivateStorage(threadId));
+        }
+        outcome.sharedStorage =
+                m_layout->merge(outcome.sharedStorage, privateStorages);
+    }
+    outcome.threadLocalStorages.reserve(m_threadManager.size());
+    for (size_t threadId = 0; threadId < m_threadManager.size(); ++threadId) {
+        outcome.threadLocalStorages.push_back(
+                m_threadManager.getThreadLocalStorage(threadId).getStorage());
+    }
+    return outcome;
+}
+
+template<class StorageManager>
+ExecutionStatistics BasicExecutor<StorageManager>::getStatistics() const {
+    ExecutionStatistics statistics;
+    m_threadManager.collectStatistics(statistics);
+    statistics.internalUpdates = m_internalUpdates;
+    statistics.idleInternalUpdates = m_idleInternalUpdates;
+    statistics.storage = m_storageManager->getStatistics();
+    return statistics;
+}
+
+template<class StorageManager>
+size_t BasicExecutor<StorageManager>::hashState() const {
+    size_t seed = m_storageManager->hashState();
+    for (size_t threadId = 0; threadId < m_threadManager.size(); ++threadId) {
+        util::hashCombine(seed, m_threadManager.hashThreadState(threadId));
+    }
+    return seed;
+}
+
+template<class StorageManager>
+storage::PackedState BasicExecutor<StorageManager>::encodeState() const {
+    storage::StateWriter writer;
+    m_storageManager->encodeState(writer);
+    m_threadManager.encodeState(writer);
+    return writer.finish();
+}
+
+template<class StorageManager>
+void BasicExecutor<StorageManager>::decodeState(
+        const storage::PackedState &state) {
+    storage::StateReader reader(state);
+    m_storageManager->decodeState(reader);
+    m_threadManager.decodeState(reader);
 }
 
-bool RandomExecutor::execute() {
-    bool tryExecuteThreadFirst =
-            std::uniform_int_distribution<size_t>(0, 1)(m_randomGenerator);
+template<class StorageManager>
+void BasicExecutor<StorageManager>::canonicalizeThreads(
+        const std::vector<size_t> &symmetricThreads) {
+    size_t nOfThreads = m_threadManager.size();
+    std::vector<storage::PackedState> states;
+    states.reserve(nOfThreads);
+    for (size_t threadId = 0; threadId < nOfThreads; ++threadId) {
+        storage::StateWriter writer;
+        m_storageManager->encodeThreadState(threadId, writer);
+        m_threadManager.encodeThreadState(threadId, writer);
+        states.push_back(writer.finish());
+    }
+    std::vector<size_t> order(nOfThreads);
+    bool isPermuted = false;
+    for (size_t first = 0; first < nOfThreads; ++first) {
+        if (symmetricThreads[first] != first) { continue; }
+        std::vector<size_t> members;
+        for (size_t threadId = first; threadId < nOfThreads; ++threadId) {
+            if (symmetricThreads[threadId] == first) {
+                members.push_back(threadId);
+            }
+        }
+        auto sorted = members;
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [&states](size_t lhs, size_t rhs) {
+                             return states[lhs] < states[rhs];
+                         });
+        for (size_t i = 0; i < members.size(); ++i) {
+            order[members[i]] = sorted[i];
+            isPermuted = isPermuted || members[i] != sorted[i];
+        }
+    }
+    if (!isPermuted) { return; }
+    m_storageManager->permuteThreads(order);
+    m_threadManager.permuteThreads(order);
+}
+
+template<class StorageManager>
+bool BasicRandomExecutor<StorageManager>::executeThread() {
+    auto runnableThreads = m_threadManager.runnableThreads();
+    if (runnableThreads.empty()) { return false; }
+    std::shuffle(runnableThreads.begin(), runnableThreads.end(),
+                 m_randomGenerator);
+    for (auto threadId: runnableThreads) {
+        if (m_threadManager.evaluateThread(threadId)) { return true; }
+    }
+    return false;
+}
+
+template<class StorageManager>
+bool BasicRandomExecutor<StorageManager>::execute() {
+    bool tryExecuteThreadFirst = !m_updateFirstDistribution(m_randomGenerator);
     if (tryExecuteThreadFirst) {
-        return executeThread() || executeInternalMemoryUpdate();
+        return executeThread() || this->executeInternalMemoryUpdate();
+    } else {
+        return this->executeInternalMemoryUpdate() || executeThread();
+    }
+}
+
+template<class StorageManager>
+void BasicRandomExecutor<StorageManager>::reset(unsigned long seed) {
+    BasicExecutor<StorageManager>::reset(seed);
+    m_randomGenerator.seed(seed);
+    m_updateFirstDistribution.reset();
+}
+
+template<class StorageManager>
+BasicPctExecutor<StorageManager>::BasicPctExecutor(
+        const std::vector<program::Program> &programs,
+        const std::shared_ptr<StorageManager> &storageManager,
+        size_t threadLocalStorageSize, unsigned long seed, size_t depth,
+        size_t expectedSteps, double flushProbability,
+        const MemoryLayoutPtr &layout)
+    : BasicExecutor<StorageManager>(programs, storageManager,
+                                    threadLocalStorageSize, layout),
+      m_updateFirstDistribution(flushProbability), m_depth(depth),
+      m_expectedSteps(expectedSteps) {
+    if (depth == 0) {
+        throw std::invalid_argument("PCT depth must be positive");
+    }
+    BasicPctExecutor::reset(seed);
+}
+
+template<class StorageManager>
+void BasicPctExecutor<StorageManager>::reset(unsigned long seed) {
+    BasicExecutor<StorageManager>::reset(seed);
+    m_randomGenerator.seed(seed);
+    m_updateFirstDistribution.reset();
+    m_priorities.resize(m_threadManager.size());
+    for (size_t i = 0; i < m_priorities.size(); ++i) {
+        m_priorities[i] = m_depth + i;
+    }
+    std::shuffle(m_priorities.begin(), m_priorities.end(), m_randomGenerator);
+    std::uniform_int_distribution<size_t> stepDistribution(
+            1, std::max<size_t>(m_expectedSteps, 1));
+    m_changePoints.clear();
+    for (size_t i = 1; i < m_depth; ++i) {
+        m_changePoints.push_back(stepDistribution(m_randomGenerator));
+    }
+    std::sort(m_changePoints.begin(), m_changePoints.end());
+    m_nextChangePoint = 0;
+    m_step = 0;
+}
+
+template<class StorageManager>
+bool BasicPctExecutor<StorageManager>::executeThread() {
+    auto runnableThreads = m_threadManager.runnableThreads();
+    if (runnableThreads.empty()) { return false; }
+    ++m_step;
+    auto byPriority = [this](size_t lhs, size_t rhs) {
+        return m_priorities[lhs] > m_priorities[rhs];
+    };
+    std::sort(runnableThreads.begin(), runnableThreads.end(), byPriority);
+    while (m_nextChangePoint < m_changePoints.size() &&
+           m_changePoints[m_nextChangePoint] <= m_step) {
+        // Change point i lowers the priority to depth - 1 - i, which is
+        // below every initial priority
+        m_priorities[runnableThreads.front()] =
+                m_changePoints.size() - m_nextChangePoint++;
+        std::sort(runnableThreads.begin(), runnableThreads.end(), byPriority);
+    }
+    for (auto threadId: runnableThreads) {
+        if (m_threadManager.evaluateThread(threadId)) { return true; }
+    }
+    return false;
+}
+
+template<class StorageManager>
+bool BasicPctExecutor<StorageManager>::execute() {
+    if (m_updateFirstDistribution(m_randomGenerator)) {
+        return this->executeInternalMemoryUpdate() || executeThread();
     } else {
-        return executeInternalMemoryUpdate() || executeThread();
+        return executeThread() || this->executeInternalMemoryUpdate();
     }
 }
 
+INSTANTIATE_FOR_STORAGE_MANAGERS(BasicExecutor)
+INSTANTIATE_FOR_STORAGE_MANAGERS(BasicRandomExecutor)
+INSTANTIATE_FOR_STORAGE_MANAGERS(BasicPctExecutor)
+
 void InteractiveExecutor::writeState(std::ostream &outputStream) const {
     m_storageManager->writeStorage(outputStream);
     auto localStorages = m_threadManager.getThreadLocalStorages();
@@ -113,11 +297,85 @@ bool InteractiveExecutor::execute() {
 }
 
 bool InteractiveExecutor::executeInternalMemoryUpdate() {
-    bool returnValue = ExecutorInterface::executeInternalMemoryUpdate();
+    bool returnValue = BasicExecutor::executeInternalMemoryUpdate();
     if (!returnValue) {
         std::cout << "No internal memory updates could be performed.\n";
     }
     return returnValue;
 }
 
+void BoundedExecutor::reset(unsigned long seed) {
+    BasicExecutor::reset(seed);
+    m_preemptions = 0;
+    m_delays = 0;
+    m_delayedUpdates = 0;
+    m_isPruned = false;
+    m_currentThreadId.reset();
+}
+
+bool BoundedExecutor::isNextStepInvisible(size_t threadId) const {
+    if (m_threadManager.isNextInstructionThreadLocal(threadId)) {
+        return true;
+    }
+    if (threadId >= m_commutingAccesses.size()) { return false; }
+    const auto &commuting = m_commutingAccesses[threadId];
+    size_t position = m_threadManager.getCurrentPositionForThread(threadId);
+    return position < commuting.size() && commuting[position];
+}
+
+bool BoundedExecutor::execute() {
+    auto runnableThreads = m_threadManager.runnableThreads();
+    for (auto threadId: runnableThreads) {
+        if (isNextStepInvisible(threadId)) {
+            return m_threadManager.evaluateThread(threadId);
+        }
+    }
+    return executeThread();
+}
+
+bool BoundedExecutor::executeThread() {
+    // A thread blocked in a spin loop can't continue, so switching away from
+    // it is not a preemption
+    auto runnableThreads = m_threadManager.runnableThreads();
+    size_t pendingUpdates = m_storageManager->countPendingInternalUpdates();
+    m_delayedUpdates = std::min(m_delayedUpdates, pendingUpdates);
+    size_t newDelays = pendingUpdates - m_delayedUpdates;
+    bool isCurrentThreadRunnable =
+            m_currentThreadId &&
+            std::count(runnableThreads.begin(), runnableThreads.end(),
+                       m_currentThreadId.value()) > 0;
+    if (isCurrentThreadRunnable) {
+        // Continuing the current thread is the cheapest option, try it first
+        std::erase(runnableThreads, m_currentThreadId.value());
+        runnableThreads.insert(runnableThreads.begin(),
+                               m_currentThreadId.value());
+    }
+
+    struct Option {
+        std::optional<size_t> threadId;
+        bool isPreemption;
+    };
+    std::vector<Option> options;
+    if (pendingUpdates > 0) { options.push_back({{}, false}); }
+    for (auto threadId: runnableThreads) {
+        bool isPreemption = isCurrentThreadRunnable &&
+                            threadId != m_currentThreadId.value();
+        if ((isPreemption && m_preemptions >= m_bound.preemptions) ||
+            m_delays + newDelays > m_bound.delays) {
+            m_isPruned = true;
+            continue;
+        }
+        options.push_back({threadId, isPreemption});
+    }
+    if (options.empty()) { return false; }
+
+    const auto &option = options[m_choices->choose(options.size())];
+    if (!option.threadId) { return executeInternalMemoryUpdate(); }
+    if (option.isPreemption) { ++m_preemptions; }
+    m_delays += newDelays;
+    m_delayedUpdates = pendingUpdates;
+    m_currentThreadId = option.threadId;
+    return m_threadManager.evaluateThread(option.threadId.value());
+}
+
 } // namespace wmm::execution
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include "ExecutorFactory.h"
+#include "PartialStoreOrderStorageManager.h"
+#include "ReleaseAcquireStorageManager.h"
+#include "SequentialConsistencyStorageManager.h"
+#include "TotalStoreOrderStorageManager.h"
+
+namespace wmm::execution {
+
+using namespace storage;
+
+#define INIT_INTERNAL_UPDATE_MANAGER(var_name, namespace_name, ...)            \
+    {                                                                          \
+        using namespace namespace_name;                                        \
+        switch (mode) {                                                        \
+            case ExecutionMode::Random:                                        \
+            case ExecutionMode::Pct:                                           \
+                (var_name) = std::make_unique<RandomInternalUpdateManager>(    \
+                        seed __VA_OPT__(, ) __VA_ARGS__);                      \
+                break;                                                         \
+            case ExecutionMode::Interactive:                                   \
+                (var_name) =                                                   \
+                        std::make_unique<InteractiveInternalUpdateManager>();  \
+                break;                                                         \
+            case ExecutionMode::Enumerate:                                     \
+                if (!choices) {                                                \
+                    throw std::runtime_error(                                  \
+                            "Enumerate execution requires a choice sequence"); \
+                }                                                              \
+                (var_name) = std::make_unique<EnumerateInternalUpdateManager>( \
+                        choices);                                              \
+                break;                                                         \
+        }                                                                      \
+    }
+
+MemoryModel parseMemoryModel(const std::string &model) {
+    if (model == "tso") {
+        return MemoryModel::TSO;
+    } else if (model == "pso") {
+        return MemoryModel::PSO;
+    } else if (model == "sc") {
+        return MemoryModel::SC;
+    } else if (model == "ra") {
+        return MemoryModel::RA;
+    } else if (model == "sra") {
+        return MemoryModel::SRA;
+    } else {
+        throw std::runtime_error("Unknown memory model: " + model);
+    }
+}
+
+std::string toString(MemoryModel model) {
+    switch (model) {
+        case MemoryModel::TSO:
+            return "tso";
+        case MemoryModel::PSO:
+            return "pso";
+        case MemoryModel::SC:
+            return "sc";
+        case MemoryModel::RA:
+            return "ra";
+        case MemoryModel::SRA:
+            return "sra";
+    }
+    return "";
+}
+
+ExecutionMode parseExecutionMode(const std::string &mode) {
+    if (mode == "rand") {
+        return ExecutionMode::Random;
+    } else if (mode == "interact") {
+        return ExecutionMode::Interactive;
+    } else if (mode == "enum") {
+        return ExecutionMode::Enumerate;
+    } else if (mode == "pct") {
+        return ExecutionMode::Pct;
+    } else {
+        throw std::runtime_error("Unknown execution mode: " + mode);
+    }
+}
+
+StorageManagerPtr makeStorageManager(MemoryModel model, ExecutionMode mode,
+                                     size_t storageSize, size_t nOfThreads,
+                                     unsigned long seed, LoggerPtr &&logger,
+                                     const ChoiceSequencePtr &choices,
+                                     const SchedulingOptions &options) {
+    switch (model) {
+        case MemoryModel::TSO: {
+            TSO::InternalUpdateManagerPtr internalUpdateManager;
+            INIT_INTERNAL_UPDATE_MANAGER(internalUpdateManager, TSO)
+            return std::make_shared<TSO::TotalStoreOrderStorageManager>(
+                    storageSize, nOfThreads, std::move(internalUpdateManager),
+                    std::move(logger));
+        }
+        case MemoryModel::PSO: {
+            PSO::InternalUpdateManagerPtr internalUpdateManager;
+            INIT_INTERNAL_UPDATE_MANAGER(internalUpdateManager, PSO)
+            return std::make_shared<PSO::PartialStoreOrderStorageManager>(
+                    storageSize, nOfThreads, std::move(internalUpdateManager),
+                    std::move(logger));
+        }
+        case MemoryModel::SC:
+            return std::make_shared<SC::SequentialConsistencyStorageManager>(
+                    storageSize, std::move(logger));
+        case MemoryModel::RA:
+        case MemoryModel::SRA: {
+            RA::InternalUpdateManagerPtr internalUpdateManager;
+            INIT_INTERNAL_UPDATE_MANAGER(internalUpdateManager, RA,
+                                         options.oldMessageBias)
+            return std::make_shared<RA::ReleaseAcquireStorageManager>(
+                    storageSize, nOfThreads,
+                    (model == MemoryModel::RA) ? RA::Model::RA
+                                               : RA::Model::SRA,
+                    std::move(internalUpdateManager), std::move(logger));
+        }
+    }
+    throw std::runtime_error("Unreachable state");
+}
+
+/**
+ * Instantiates the executor for the concrete type of the storage manager, so
+ * the memory accesses of its threads are not virtual calls
+ */
+template<template<class> class Executor, class... Args>
+static ExecutorPtr
+makeTypedExecutor(const std::vector<program::Program> &programs,
+                  const StorageManagerPtr &storageManager,
+                  const Args &...args) {
+    if (auto manager = std::dynamic_pointer_cast<
+                SC::SequentialConsistencyStorageManager>(storageManager)) {
+        return std::make_unique<
+                Executor<SC::SequentialConsistencyStorageManager>>(
+                programs, manager, args...);
+    }
+    if (auto manager = std::dynamic_pointer_cast<
+                TSO::TotalStoreOrderStorageManager>(storageManager)) {
+        return std::make_unique<Executor<TSO::TotalStoreOrderStorageManager>>(
+                programs, manager, args...);
+    }
+    if (auto manager = std::dynamic_pointer_cast<
+                PSO::PartialStoreOrderStorageManager>(storageManager)) {
+        return std::make_unique<
+                Executor<PSO::PartialStoreOrderStorageManager>>(
+                programs, manager, args...);
+    }
+    if (auto manager = std::dynamic_pointer_cast<
+                RA::ReleaseAcquireStorageManager>(storageManager)) {
+        return std::make_unique<Executor<RA::ReleaseAcquireStorageManager>>(
+                programs, manager, args...);
+    }
+    return std::make_unique<Executor<StorageManagerInterface>>(
+            programs, storageManager, args...);
+}
+
+ExecutorPtr makeExecutor(ExecutionMode mode,
+                         const std::vector<program::Program> &programs,
+                         const StorageManagerPtr &storageManager,
+                         size_t threadLocalStorageSize, unsigned long seed,
+                         const SchedulingOptions &options,
+                         const MemoryLayoutPtr &layout) {
+    switch (mode) {
+        case ExecutionMode::Random:
+            return makeTypedExecutor<BasicRandomExecutor>(
+                    programs, storageManager, threadLocalStorageSize, seed,
+                    options.flushProbability, layout);
+        case ExecutionMode::Pct:
+            return makeTypedExecutor<BasicPctExecutor>(
+                    programs, storageManager, threadLocalStorageSize, seed,
+                    options.pctDepth, options.pctExpectedSteps,
+                    options.flushProbability, layout);
+        case ExecutionMode::Interactive:
+            if (layout) {
+                throw std::runtime_error(
+                        "Interactive execution shows the whole memory");
+            }
+            return std::make_unique<InteractiveExecutor>(
+                    programs, storageManager, threadLocalStorageSize);
+        case ExecutionMode::Enumerate:
+            throw std::runtime_error(
+                    "Enumerate execution is performed by BoundedExplorer");
+    }
+    throw std::runtime_error("Unreachable state");
+}
+
+} // namespace wmm::execution
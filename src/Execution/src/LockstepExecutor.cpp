@@ -0,0 +1,589 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+#include "LockstepExecutor.h"
+
+namespace wmm::execution {
+
+using namespace program;
+
+namespace {
+uint64_t seedRandom(unsigned long seed) {
+    // splitmix64, xorshift needs a nonzero state
+    uint64_t value = seed + 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value ? value : 1;
+}
+
+// Index of the n-th set bit
+uint32_t nthBit(uint64_t mask, uint32_t n) {
+    for (; n > 0; --n) { mask &= mask - 1; }
+    return std::countr_zero(mask);
+}
+
+// Uniform in [0, n) from 32 random bits
+uint32_t pick(uint64_t random, uint32_t n) {
+    return static_cast<uint32_t>(((random & 0xffffffffULL) * n) >> 32);
+}
+} // namespace
+
+LockstepExecutor::LockstepExecutor(const std::vector<Program> &programs,
+                                   MemoryModel model, Config config)
+    : m_config(config), m_isBuffered(model == MemoryModel::TSO),
+      m_nOfThreads(programs.size()) {
+    if (!supports(model)) {
+        throw std::invalid_argument("Lockstep execution supports SC and TSO "
+                                    "only");
+    }
+    if (m_nOfThreads > MAX_THREADS) {
+        throw std::invalid_argument("Too many threads for lockstep execution");
+    }
+    if (m_config.lanes == 0 || m_config.bufferCapacity == 0) {
+        throw std::invalid_argument("Lockstep execution needs lanes and "
+                                    "buffer slots");
+    }
+    size_t nOfRegisters = m_config.threadLocalStorageSize;
+    for (const auto &program: programs) {
+        auto &decoded = m_programs.emplace_back();
+        decoded.reserve(program.size());
+        for (size_t position = 0; position < program.size(); ++position) {
+            auto instruction = program.getInstruction(position);
+            decoded.push_back(decode(program, position, *instruction));
+        }
+    }
+
+    size_t lanes = m_config.lanes;
+    size_t threadRows = m_nOfThreads * lanes;
+    m_memory.resize(m_config.storageSize * lanes);
+    m_registers.resize(nOfRegisters * threadRows);
+    m_positions.resize(threadRows);
+    m_lastLoads.resize(threadRows);
+    m_lastLoadedValues.resize(threadRows);
+    m_isSpinning.resize(threadRows);
+    if (m_isBuffered) {
+        m_bufferAddresses.resize(m_config.bufferCapacity * threadRows);
+        m_bufferValues.resize(m_config.bufferCapacity * threadRows);
+        m_bufferStarts.resize(threadRows);
+        m_bufferSizes.resize(threadRows);
+    }
+    m_random.resize(lanes);
+    m_threads.resize(lanes);
+    m_isFailed.resize(lanes);
+}
+
+LockstepExecutor::Instruction
+LockstepExecutor::decode(const Program &program, size_t position,
+                         const program::Instruction &instruction) {
+    Instruction result;
+    std::vector<size_t> registers;
+    switch (instruction.action) {
+        case InstructionAction::StoreConstInRegister: {
+            const auto &cmd =
+                    static_cast<const StoreConstInRegister &>(instruction);
+            result.opcode = Opcode::StoreConst;
+            registers = {cmd.storeRegister};
+            result.value = cmd.value;
+            break;
+        }
+        case InstructionAction::StoreExprInRegister: {
+            const auto &cmd =
+                    static_cast<const StoreExprInRegister &>(instruction);
+            result.opcode = Opcode::StoreExpr;
+            registers = {cmd.storeRegister, cmd.leftRegister,
+                         cmd.rightRegister};
+            result.operation = cmd.operation;
+            break;
+        }
+        case InstructionAction::Goto: {
+            const auto &cmd = static_cast<const Goto &>(instruction);
+            result.opcode = Opcode::Goto;
+            registers = {cmd.conditionRegister};
+            auto label = program.getLabels().find(cmd.label);
+            if (label != program.getLabels().end()) {
+                result.target = label->second;
+            }
+            auto head = program.getSpinLoopHead(position);
+            if (head) { result.spinLoopHead = *head; }
+            break;
+        }
+        case InstructionAction::Load: {
+            const auto &cmd = static_cast<const Load &>(instruction);
+            result.opcode = Opcode::Load;
+            registers = {cmd.addressRegister, cmd.resultRegister};
+            break;
+        }
+        case InstructionAction::Store: {
+            const auto &cmd = static_cast<const Store &>(instruction);
+            result.opcode = Opcode::Store;
+            registers = {cmd.addressRegister, cmd.valueRegister};
+            break;
+        }
+        case InstructionAction::CompareAndSwap: {
+            const auto &cmd = static_cast<const CompareAndSwap &>(instruction);
+            result.opcode = Opcode::CompareAndSwap;
+            registers = {cmd.addressRegister, cmd.expectedValueRegister,
+                         cmd.newValueRegister};
+            if (cmd.resultRegister) {
+                registers.push_back(*cmd.resultRegister);
+            } else {
+                result.registers[3] = NONE;
+            }
+            break;
+        }
+        case InstructionAction::FetchAndIncrement: {
+            const auto &cmd =
+                    static_cast<const FetchAndIncrement &>(instruction);
+            result.opcode = Opcode::FetchAndIncrement;
+            registers = {cmd.addressRegister, cmd.incrementRegister};
+            break;
+        }
+        case InstructionAction::Fence:
+            result.opcode = Opcode::Fence;
+            break;
+        case InstructionAction::CompareAndSwapLoop: {
+            const auto &cmd =
+                    static_cast<const CompareAndSwapLoop &>(instruction);
+            result.opcode = Opcode::CompareAndSwapLoop;
+            registers = {cmd.conditionRegister};
+            std::vector<Instruction> body;
+            for (const auto &bodyInstruction: cmd.body) {
+                body.push_back(decode(program, position, *bodyInstruction));
+                if (body.back().opcode == Opcode::Invalid) {
+                    return body.back();
+                }
+            }
+            result.body = m_loopBodies.size();
+            result.bodySize = body.size();
+            m_loopBodies.insert(m_loopBodies.end(), body.begin(), body.end());
+            break;
+        }
+    }
+    for (size_t i = 0; i < registers.size(); ++i) {
+        if (registers[i] >= m_config.threadLocalStorageSize) {
+            result.opcode = Opcode::Invalid;
+            break;
+        }
+        result.registers[i] = static_cast<uint32_t>(registers[i]);
+    }
+    return result;
+}
+
+void LockstepExecutor::reset(std::span<const unsigned long> seeds) {
+    std::fill(m_memory.begin(), m_memory.end(), 0);
+    std::fill(m_registers.begin(), m_registers.end(), 0);
+    std::fill(m_positions.begin(), m_positions.end(), 0);
+    std::fill(m_lastLoads.begin(), m_lastLoads.end(), NONE);
+    std::fill(m_lastLoadedValues.begin(), m_lastLoadedValues.end(), 0);
+    std::fill(m_isSpinning.begin(), m_isSpinning.end(), 0);
+    std::fill(m_bufferStarts.begin(), m_bufferStarts.end(), 0);
+    std::fill(m_bufferSizes.begin(), m_bufferSizes.end(), 0);
+    std::fill(m_isFailed.begin(), m_isFailed.end(), 0);
+    for (size_t lane = 0; lane < seeds.size(); ++lane) {
+        m_random[lane] = seedRandom(seeds[lane]);
+    }
+}
+
+int32_t LockstepExecutor::load(size_t threadId, uint32_t address,
+                               size_t lane) const {
+    if (m_isBuffered) {
+        // The newest buffered store to the address
+        size_t row = at(threadId, lane);
+        size_t capacity = m_config.bufferCapacity;
+        for (size_t i = m_bufferSizes[row]; i > 0; --i) {
+            size_t slot = (m_bufferStarts[row] + i - 1) % capacity;
+            size_t index = at(threadId * capacity + slot, lane);
+            if (m_bufferAddresses[index] == address) {
+                return m_bufferValues[index];
+            }
+        }
+    }
+    return m_memory[at(address, lane)];
+}
+
+void LockstepExecutor::store(size_t threadId, uint32_t address, int32_t value,
+                             size_t lane) {
+    if (!m_isBuffered) {
+        m_memory[at(address, lane)] = value;
+        return;
+    }
+    size_t row = at(threadId, lane);
+    size_t capacity = m_config.bufferCapacity;
+    if (m_bufferSizes[row] == capacity) { propagate(threadId, lane); }
+    size_t slot = (m_bufferStarts[row] + m_bufferSizes[row]) % capacity;
+    size_t index = at(threadId * capacity + slot, lane);
+    m_bufferAddresses[index] = address;
+    m_bufferValues[index] = value;
+    ++m_bufferSizes[row];
+}
+
+void LockstepExecutor::propagate(size_t threadId, size_t lane) {
+    size_t row = at(threadId, lane);
+    size_t capacity = m_config.bufferCapacity;
+    size_t index = at(threadId * capacity + m_bufferStarts[row], lane);
+    m_memory[at(m_bufferAddresses[index], lane)] = m_bufferValues[index];
+    m_bufferStarts[row] = (m_bufferStarts[row] + 1) % capacity;
+    --m_bufferSizes[row];
+}
+
+void LockstepExecutor::flush(size_t threadId, size_t lane) {
+    if (!m_isBuffered) { return; }
+    while (m_bufferSizes[at(threadId, lane)] > 0) { propagate(threadId, lane); }
+}
+
+int32_t LockstepExecutor::compareAndSwap(size_t threadId, uint32_t address,
+                                         int32_t expectedValue,
+                                         int32_t newValue, size_t lane) {
+    flush(threadId, lane);
+    auto &memory = m_memory[at(address, lane)];
+    int32_t value = memory;
+    if (value == expectedValue) { memory = newValue; }
+    return value;
+}
+
+bool LockstepExecutor::evaluateInLoop(const Instruction &instruction,
+                                      size_t threadId, size_t lane) {
+    auto registerAt = [&](size_t i) -> int32_t & {
+        return reg(threadId, instruction.registers[i], lane);
+    };
+    auto addressOf = [this](int32_t address) {
+        return (address >= 0 &&
+                static_cast<size_t>(address) < m_config.storageSize)
+                       ? static_cast<uint32_t>(address)
+                       : NONE;
+    };
+    switch (instruction.opcode) {
+        case Opcode::StoreConst:
+            registerAt(0) = instruction.value;
+            return true;
+        case Opcode::StoreExpr: {
+            auto value = program::applyOperation(instruction.operation,
+                                                 registerAt(1), registerAt(2));
+            if (!value) { return false; }
+            registerAt(0) = *value;
+            return true;
+        }
+        case Opcode::Load: {
+            uint32_t address = addressOf(registerAt(0));
+            if (address == NONE) { return false; }
+            registerAt(1) = load(threadId, address, lane);
+            return true;
+        }
+        case Opcode::CompareAndSwap: {
+            uint32_t address = addressOf(registerAt(0));
+            if (address == NONE) { return false; }
+            int32_t value = compareAndSwap(threadId, address, registerAt(1),
+                                           registerAt(2), lane);
+            if (instruction.registers[3] != NONE) {
+                registerAt(3) = value == registerAt(1);
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool LockstepExecutor::isBlocked(size_t threadId, size_t lane) const {
+    size_t row = at(threadId, lane);
+    if (!m_isSpinning[row]) { return false; }
+    const auto &head = m_programs[threadId][m_positions[row]];
+    int32_t address = m_registers[at(
+            threadId * m_config.threadLocalStorageSize + head.registers[0],
+            lane)];
+    // An address out of range fails the execution when the load runs
+    if (address < 0 || static_cast<size_t>(address) >= m_config.storageSize) {
+        return false;
+    }
+    return load(threadId, address, lane) == m_lastLoadedValues[row];
+}
+
+std::optional<std::pair<uint32_t, bool>>
+LockstepExecutor::choose(size_t lane) const {
+    uint64_t runnable = 0;
+    uint64_t buffered = 0;
+    for (size_t threadId = 0; threadId < m_nOfThreads; ++threadId) {
+        size_t row = at(threadId, lane);
+        if (m_positions[row] < m_programs[threadId].size() &&
+            !isBlocked(threadId, lane)) {
+            runnable |= uint64_t(1) << threadId;
+        }
+        if (m_isBuffered && m_bufferSizes[row] > 0) {
+            buffered |= uint64_t(1) << threadId;
+        }
+    }
+    uint64_t random = m_random[lane];
+    // The top 24 bits decide the order, the low 32 bits pick the thread
+    bool isFlushFirst = static_cast<double>(random >> 40) <
+                        m_config.flushProbability * double(1 << 24);
+    auto pickFrom = [random](uint64_t mask) {
+        return nthBit(mask, pick(random, std::popcount(mask)));
+    };
+    if (buffered && (isFlushFirst || !runnable)) {
+        return std::pair{pickFrom(buffered), true};
+    }
+    if (runnable) { return std::pair{pickFrom(runnable), false}; }
+    return {};
+}
+
+void LockstepExecutor::execute(Opcode opcode, std::span<const uint32_t> lanes) {
+    size_t nOfRegisters = m_config.threadLocalStorageSize;
+    size_t storageSize = m_config.storageSize;
+    // Runs the instruction of the chosen thread in every lane with the shared
+    // bookkeeping of BasicThread::evaluateInstruction around it
+    auto forEachLane = [&](auto &&evaluate) {
+        for (auto lane: lanes) {
+            size_t threadId = m_threads[lane];
+            size_t row = at(threadId, lane);
+            uint32_t position = m_positions[row];
+            const auto &instruction = m_programs[threadId][position];
+            auto registerAt = [&](size_t i) -> int32_t & {
+                return m_registers[at(threadId * nOfRegisters +
+                                              instruction.registers[i],
+                                      lane)];
+            };
+            m_isSpinning[row] = 0;
+            uint32_t next = position + 1;
+            if (!evaluate(lane, threadId, row, position, instruction,
+                          registerAt, next)) {
+                m_isFailed[lane] = 1;
+                continue;
+            }
+            m_positions[row] = next;
+        }
+    };
+    auto addressOf = [storageSize](int32_t address) {
+        return (address >= 0 && static_cast<size_t>(address) < storageSize)
+                       ? static_cast<uint32_t>(address)
+                       : NONE;
+    };
+
+    switch (opcode) {
+        case Opcode::StoreConst:
+            forEachLane([](size_t, size_t, size_t, uint32_t,
+                           const Instruction &instruction, auto &&registerAt,
+                           uint32_t &) {
+                registerAt(0) = instruction.value;
+                return true;
+            });
+            break;
+        case Opcode::StoreExpr:
+            forEachLane([](size_t, size_t, size_t, uint32_t,
+                           const Instruction &instruction, auto &&registerAt,
+                           uint32_t &) {
+                auto value = program::applyOperation(
+                        instruction.operation, registerAt(1), registerAt(2));
+                if (!value) { return false; }
+                registerAt(0) = *value;
+                return true;
+            });
+            break;
+        case Opcode::Goto:
+            forEachLane([this](size_t, size_t, size_t row, uint32_t,
+                               const Instruction &instruction,
+                               auto &&registerAt, uint32_t &next) {
+                if (registerAt(0) != 0) {
+                    if (instruction.target == NONE) { return false; }
+                    next = instruction.target;
+                    m_isSpinning[row] =
+                            instruction.spinLoopHead != NONE &&
+                            instruction.spinLoopHead == m_lastLoads[row];
+                }
+                m_lastLoads[row] = NONE;
+                return true;
+            });
+            break;
+        case Opcode::Load:
+            forEachLane([&](size_t lane, size_t threadId, size_t row,
+                            uint32_t position, const Instruction &,
+                            auto &&registerAt, uint32_t &) {
+                uint32_t address = addressOf(registerAt(0));
+                if (address == NONE) { return false; }
+                // A spinning thread is only unblocked by another value, and
+                // SC and TSO loads are deterministic
+                int32_t value = load(threadId, address, lane);
+                registerAt(1) = value;
+                m_lastLoads[row] = position;
+                m_lastLoadedValues[row] = value;
+                return true;
+            });
+            break;
+        case Opcode::Store:
+            forEachLane([&](size_t lane, size_t threadId, size_t row,
+                            uint32_t, const Instruction &, auto &&registerAt,
+                            uint32_t &) {
+                m_lastLoads[row] = NONE;
+                uint32_t address = addressOf(registerAt(0));
+                if (address == NONE) { return false; }
+                store(threadId, address, registerAt(1), lane);
+                return true;
+            });
+            break;
+        case Opcode::CompareAndSwap:
+            forEachLane([&](size_t lane, size_t threadId, size_t row,
+                            uint32_t, const Instruction &instruction,
+                            auto &&registerAt, uint32_t &) {
+                m_lastLoads[row] = NONE;
+                uint32_t address = addressOf(registerAt(0));
+                if (address == NONE) { return false; }
+                int32_t value = compareAndSwap(threadId, address,
+                                               registerAt(1), registerAt(2),
+                                               lane);
+                if (instruction.registers[3] != NONE) {
+                    registerAt(3) = value == registerAt(1);
+                }
+                return true;
+            });
+            break;
+        case Opcode::FetchAndIncrement:
+            forEachLane([&](size_t lane, size_t threadId, size_t row,
+                            uint32_t, const Instruction &, auto &&registerAt,
+                            uint32_t &) {
+                m_lastLoads[row] = NONE;
+                uint32_t address = addressOf(registerAt(0));
+                if (address == NONE) { return false; }
+                flush(threadId, lane);
+                auto &value = m_memory[at(address, lane)];
+                value = static_cast<int32_t>(static_cast<uint32_t>(value) +
+                                             registerAt(1));
+                return true;
+            });
+            break;
+        case Opcode::Fence:
+            forEachLane([&](size_t lane, size_t threadId, size_t row,
+                            uint32_t, const Instruction &, auto &&,
+                            uint32_t &) {
+                m_lastLoads[row] = NONE;
+                flush(threadId, lane);
+                return true;
+            });
+            break;
+        case Opcode::CompareAndSwapLoop:
+            forEachLane([&](size_t lane, size_t threadId, size_t row,
+                            uint32_t position, const Instruction &instruction,
+                            auto &&registerAt, uint32_t &next) {
+                m_lastLoads[row] = NONE;
+                for (uint32_t i = 0; i < instruction.bodySize; ++i) {
+                    if (!evaluateInLoop(m_loopBodies[instruction.body + i],
+                                        threadId, lane)) {
+                        return false;
+                    }
+                }
+                // A failed iteration is followed by another one
+                if (registerAt(0) != 0) { next = position; }
+                return true;
+            });
+            break;
+        case Opcode::Invalid:
+            for (auto lane: lanes) { m_isFailed[lane] = 1; }
+            break;
+    }
+}
+
+Outcome LockstepExecutor::getOutcome(size_t lane) const {
+    Outcome outcome;
+    outcome.sharedStorage.reserve(m_config.storageSize);
+    for (size_t address = 0; address < m_config.storageSize; ++address) {
+        outcome.sharedStorage.push_back(m_memory[at(address, lane)]);
+    }
+    size_t nOfRegisters = m_config.threadLocalStorageSize;
+    for (size_t threadId = 0; threadId < m_nOfThreads; ++threadId) {
+        auto &registers = outcome.threadLocalStorages.emplace_back();
+        registers.reserve(nOfRegisters);
+        for (size_t reg = 0; reg < nOfRegisters; ++reg) {
+            registers.push_back(
+                    m_registers[at(threadId * nOfRegisters + reg, lane)]);
+        }
+    }
+    return outcome;
+}
+
+std::vector<LockstepExecutor::Run>
+LockstepExecutor::run(std::span<const unsigned long> seeds) {
+    std::vector<Run> runs(seeds.size());
+    std::vector<uint32_t> active;
+    std::vector<uint32_t> flushes;
+    std::array<std::vector<uint32_t>, N_OF_OPCODES> groups;
+    for (size_t first = 0; first < seeds.size(); first += m_config.lanes) {
+        auto chunk = seeds.subspan(
+                first, std::min(m_config.lanes, seeds.size() - first));
+        reset(chunk);
+        active.resize(chunk.size());
+        for (uint32_t lane = 0; lane < chunk.size(); ++lane) {
+            active[lane] = lane;
+        }
+        auto finish = [&](uint32_t lane, std::optional<ExecutionStatus> status,
+                          size_t steps) {
+            auto &run = runs[first + lane];
+            run.status = status;
+            run.steps = steps;
+            if (status == ExecutionStatus::Completed) {
+                run.outcome = getOutcome(lane);
+            }
+        };
+
+        for (size_t steps = 0; !active.empty(); ++steps) {
+            // xorshift64 over all lanes, a loop the compiler vectorizes
+            for (size_t lane = 0; lane < chunk.size(); ++lane) {
+                uint64_t value = m_random[lane];
+                value ^= value << 13;
+                value ^= value >> 7;
+                value ^= value << 17;
+                m_random[lane] = value;
+            }
+
+            flushes.clear();
+            for (auto &group: groups) { group.clear(); }
+            size_t nOfActive = 0;
+            for (auto lane: active) {
+                auto choice = choose(lane);
+                if (!choice) {
+                    bool isFinished = true;
+                    for (size_t threadId = 0; threadId < m_nOfThreads;
+                         ++threadId) {
+                        isFinished &= m_positions[at(threadId, lane)] ==
+                                      m_programs[threadId].size();
+                    }
+                    finish(lane,
+                           isFinished ? ExecutionStatus::Completed
+                                      : ExecutionStatus::Deadlocked,
+                           steps);
+                    continue;
+                }
+                if (steps == m_config.maxSteps) {
+                    finish(lane, ExecutionStatus::StepLimitExceeded,
+                           steps + 1);
+                    continue;
+                }
+                auto [threadId, isFlush] = *choice;
+                m_threads[lane] = threadId;
+                if (isFlush) {
+                    flushes.push_back(lane);
+                } else {
+                    size_t position = m_positions[at(threadId, lane)];
+                    auto opcode = m_programs[threadId][position].opcode;
+                    groups[static_cast<size_t>(opcode)].push_back(lane);
+                }
+                active[nOfActive++] = lane;
+            }
+            active.resize(nOfActive);
+
+            for (auto lane: flushes) { propagate(m_threads[lane], lane); }
+            for (size_t opcode = 0; opcode < N_OF_OPCODES; ++opcode) {
+                if (groups[opcode].empty()) { continue; }
+                execute(static_cast<Opcode>(opcode), groups[opcode]);
+            }
+            std::erase_if(active, [&](uint32_t lane) {
+                if (!m_isFailed[lane]) { return false; }
+                finish(lane, std::nullopt, steps + 1);
+                return true;
+            });
+        }
+    }
+    return runs;
+}
+
+} // namespace wmm::execution
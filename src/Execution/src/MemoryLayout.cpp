@@ -0,0 +1,102 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "Footprint.h"
+#include "MemoryLayout.h"
+
+namespace wmm::execution {
+
+using namespace program;
+
+MemoryLayout::MemoryLayout(const std::vector<Program> &programs,
+                           size_t storageSize)
+    : m_storageSize(storageSize), m_owners(storageSize),
+      m_sharedIndices(storageSize) {
+    auto footprints = analyzeFootprints(programs);
+    bool isComplete = std::all_of(
+            footprints.begin(), footprints.end(),
+            [](const auto &footprint) { return footprint.isComplete(); });
+    if (!isComplete) {
+        for (size_t location = 0; location < storageSize; ++location) {
+            m_sharedIndices[location] = location;
+            m_sharedLocations.push_back(location);
+        }
+        return;
+    }
+
+    std::vector<size_t> nOfAccessingThreads(storageSize);
+    std::vector<bool> isUpdated(storageSize);
+    for (size_t threadId = 0; threadId < programs.size(); ++threadId) {
+        const auto &footprint = footprints[threadId];
+        std::vector<size_t> locations;
+        std::set_union(footprint.getReads().begin(),
+                       footprint.getReads().end(),
+                       footprint.getWrites().begin(),
+                       footprint.getWrites().end(),
+                       std::back_inserter(locations));
+        for (auto location: locations) {
+            if (location >= storageSize) { continue; }
+            ++nOfAccessingThreads[location];
+            m_owners[location] = threadId;
+        }
+        // Read-modify-writes flush the buffers of the thread, so they stay
+        // with the storage manager
+        const auto &program = programs[threadId];
+        for (size_t position = 0; position < program.size(); ++position) {
+            auto action = program.getInstruction(position)->action;
+            auto location = footprint.getAddress(position);
+            if (location && *location < storageSize &&
+                (action == InstructionAction::CompareAndSwap ||
+                 action == InstructionAction::CompareAndSwapLoop ||
+                 action == InstructionAction::FetchAndIncrement)) {
+                isUpdated[*location] = true;
+            }
+        }
+    }
+    for (size_t location = 0; location < storageSize; ++location) {
+        if (nOfAccessingThreads[location] == 1 && !isUpdated[location]) {
+            continue;
+        }
+        m_owners[location].reset();
+        if (nOfAccessingThreads[location] > 0) {
+            m_sharedIndices[location] = m_sharedLocations.size();
+            m_sharedLocations.push_back(location);
+        }
+    }
+}
+
+bool MemoryLayout::hasPrivateLocations(size_t threadId) const {
+    return std::find(m_owners.begin(), m_owners.end(), threadId) !=
+           m_owners.end();
+}
+
+size_t MemoryLayout::getSharedIndex(size_t location) const {
+    if (location >= m_storageSize) {
+        throw std::out_of_range("Location " + std::to_string(location) +
+                                " is out of the storage");
+    }
+    if (!m_sharedIndices[location]) {
+        throw std::logic_error("Location " + std::to_string(location) +
+                               " is not in the shared memory");
+    }
+    return *m_sharedIndices[location];
+}
+
+std::vector<int32_t> MemoryLayout::merge(
+        const std::vector<int32_t> &sharedStorage,
+        const std::vector<const storage::Storage *> &privateStorages) const {
+    std::vector<int32_t> storage(m_storageSize);
+    for (size_t index = 0; index < m_sharedLocations.size(); ++index) {
+        storage[m_sharedLocations[index]] = sharedStorage.at(index);
+    }
+    for (size_t location = 0; location < m_storageSize; ++location) {
+        if (m_owners[location]) {
+            storage[location] =
+                    privateStorages.at(*m_owners[location])->load(location);
+        }
+    }
+    return storage;
+}
+
+} // namespace wmm::execution
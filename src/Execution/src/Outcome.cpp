@@ -0,0 +1,25 @@
+#include "Outcome.h"
+
+namespace wmm::execution {
+
+static std::string joinValues(const std::vector<int32_t> &values) {
+    std::string result;
+    bool isFirstIteration = true;
+    for (auto value: values) {
+        if (!isFirstIteration) result += ' ';
+        result += std::to_string(value);
+        isFirstIteration = false;
+    }
+    return result;
+}
+
+std::string Outcome::str() const {
+    std::string result = "[" + joinValues(sharedStorage) + "]";
+    for (size_t i = 0; i < threadLocalStorages.size(); ++i) {
+        result += " t" + std::to_string(i) + ": [" +
+                  joinValues(threadLocalStorages[i]) + "]";
+    }
+    return result;
+}
+
+} // namespace wmm::execution
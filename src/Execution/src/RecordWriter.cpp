@@ -0,0 +1,209 @@
+#include <charconv>
+#include <stdexcept>
+
+#include "RecordWriter.h"
+
+namespace wmm::execution {
+
+namespace {
+template<class T>
+void appendNumber(std::string &buffer, T value) {
+    char digits[24];
+    auto end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end);
+}
+
+template<class T>
+void appendNumbers(std::string &buffer, const std::vector<T> &values,
+                   std::string_view separator) {
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) { buffer += separator; }
+        appendNumber(buffer, values[i]);
+    }
+}
+
+void appendJsonString(std::string &buffer, std::string_view string) {
+    static const char *HEX_DIGITS = "0123456789abcdef";
+    buffer += '"';
+    for (char c: string) {
+        if (c == '"' || c == '\\') {
+            buffer += '\\';
+            buffer += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            buffer += "\\u00";
+            buffer += HEX_DIGITS[(c >> 4) & 0xf];
+            buffer += HEX_DIGITS[c & 0xf];
+        } else {
+            buffer += c;
+        }
+    }
+    buffer += '"';
+}
+
+void appendCsvString(std::string &buffer, std::string_view string) {
+    if (string.find_first_of(",\"\n\r") == std::string_view::npos) {
+        buffer += string;
+        return;
+    }
+    buffer += '"';
+    for (char c: string) {
+        if (c == '"') { buffer += '"'; }
+        buffer += c;
+    }
+    buffer += '"';
+}
+
+void formatJson(const ExecutionRecord &record, std::string &buffer) {
+    buffer += "{\"test\": ";
+    appendJsonString(buffer, record.test);
+    buffer += ", \"model\": \"";
+    buffer += toString(record.model);
+    buffer += '"';
+    if (record.run) {
+        buffer += ", \"run\": ";
+        appendNumber(buffer, *record.run);
+    }
+    if (record.seed) {
+        buffer += ", \"seed\": ";
+        appendNumber(buffer, *record.seed);
+    }
+    if (record.status) {
+        buffer += ", \"status\": \"";
+        buffer += toString(*record.status);
+        buffer += '"';
+    }
+    if (record.steps) {
+        buffer += ", \"steps\": ";
+        appendNumber(buffer, *record.steps);
+    }
+    if (record.outcome) {
+        buffer += ", \"storage\": [";
+        appendNumbers(buffer, record.outcome->sharedStorage, ", ");
+        buffer += "], \"registers\": [";
+        const auto &registers = record.outcome->threadLocalStorages;
+        for (size_t i = 0; i < registers.size(); ++i) {
+            buffer += (i > 0) ? ", [" : "[";
+            appendNumbers(buffer, registers[i], ", ");
+            buffer += ']';
+        }
+        buffer += ']';
+    }
+    if (record.bound) {
+        buffer += ", \"preemptions\": ";
+        appendNumber(buffer, record.bound->preemptions);
+        buffer += ", \"delays\": ";
+        appendNumber(buffer, record.bound->delays);
+    }
+    if (record.choices) {
+        buffer += ", \"choices\": [";
+        appendNumbers(buffer, *record.choices, ", ");
+        buffer += ']';
+    }
+    buffer += "}\n";
+}
+
+const char *CSV_HEADER = "test,model,run,seed,status,steps,storage,registers,"
+                         "preemptions,delays,choices\n";
+
+void formatCsv(const ExecutionRecord &record, std::string &buffer) {
+    appendCsvString(buffer, record.test);
+    buffer += ',';
+    buffer += toString(record.model);
+    buffer += ',';
+    if (record.run) { appendNumber(buffer, *record.run); }
+    buffer += ',';
+    if (record.seed) { appendNumber(buffer, *record.seed); }
+    buffer += ',';
+    if (record.status) { buffer += toString(*record.status); }
+    buffer += ',';
+    if (record.steps) { appendNumber(buffer, *record.steps); }
+    buffer += ',';
+    if (record.outcome) {
+        appendNumbers(buffer, record.outcome->sharedStorage, " ");
+        buffer += ',';
+        const auto &registers = record.outcome->threadLocalStorages;
+        for (size_t i = 0; i < registers.size(); ++i) {
+            if (i > 0) { buffer += '|'; }
+            appendNumbers(buffer, registers[i], " ");
+        }
+    } else {
+        buffer += ',';
+    }
+    buffer += ',';
+    if (record.bound) {
+        appendNumber(buffer, record.bound->preemptions);
+        buffer += ',';
+        appendNumber(buffer, record.bound->delays);
+    } else {
+        buffer += ',';
+    }
+    buffer += ',';
+    if (record.choices) { appendNumbers(buffer, *record.choices, " "); }
+    buffer += '\n';
+}
+} // namespace
+
+RecordFormat parseRecordFormat(const std::string &format) {
+    if (format == "jsonl" || format == "json") {
+        return RecordFormat::JsonLines;
+    } else if (format == "csv") {
+        return RecordFormat::Csv;
+    } else {
+        throw std::runtime_error("Unknown record format: " + format);
+    }
+}
+
+RecordWriter::RecordWriter(std::ostream &stream, RecordFormat format,
+                           size_t bufferSize)
+    : m_stream(stream), m_format(format), m_bufferSize(bufferSize) {
+    m_buffer.reserve(m_bufferSize);
+    if (m_format == RecordFormat::Csv) { m_buffer += CSV_HEADER; }
+}
+
+RecordWriter::~RecordWriter() { flush(); }
+
+void RecordWriter::format(const ExecutionRecord &record,
+                          std::string &buffer) const {
+    if (m_format == RecordFormat::Csv) {
+        formatCsv(record, buffer);
+    } else {
+        formatJson(record, buffer);
+    }
+}
+
+void RecordWriter::write(const ExecutionRecord &record) {
+    std::lock_guard lock(m_mutex);
+    format(record, m_buffer);
+    if (m_buffer.size() >= m_bufferSize) {
+        m_stream.write(m_buffer.data(),
+                       static_cast<std::streamsize>(m_buffer.size()));
+        m_buffer.clear();
+    }
+}
+
+void RecordWriter::write(std::string_view records) {
+    std::lock_guard lock(m_mutex);
+    if (m_buffer.size() + records.size() < m_bufferSize) {
+        m_buffer += records;
+        return;
+    }
+    m_stream.write(m_buffer.data(),
+                   static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+    if (records.size() >= m_bufferSize) {
+        m_stream.write(records.data(),
+                       static_cast<std::streamsize>(records.size()));
+    } else {
+        m_buffer += records;
+    }
+}
+
+void RecordWriter::flush() {
+    std::lock_guard lock(m_mutex);
+    m_stream.write(m_buffer.data(),
+                   static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+    m_stream.flush();
+}
+
+} // namespace wmm::execution
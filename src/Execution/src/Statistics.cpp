@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <format>
+#include <numeric>
+
+#include "Statistics.h"
+
+namespace wmm::execution {
+
+namespace {
+void addElementwise(std::vector<size_t> &target,
+                    const std::vector<size_t> &other) {
+    if (target.size() < other.size()) { target.resize(other.size()); }
+    for (size_t i = 0; i < other.size(); ++i) { target[i] += other[i]; }
+}
+
+size_t sum(const std::vector<size_t> &values) {
+    return std::accumulate(values.begin(), values.end(), size_t(0));
+}
+
+std::string joinNumbers(const std::vector<size_t> &values,
+                        const std::string &separator) {
+    std::string result;
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) { result += separator; }
+        result += std::to_string(values[i]);
+    }
+    return result;
+}
+
+std::string escapeJson(const std::string &string) {
+    std::string result;
+    for (char c: string) {
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            result += std::format("\\u{:04x}", static_cast<int>(c));
+        } else {
+            result += c;
+        }
+    }
+    return result;
+}
+} // namespace
+
+size_t ExecutionStatistics::steps() const {
+    return sum(threadLocalSteps) + sum(memorySteps);
+}
+
+void ExecutionStatistics::merge(const ExecutionStatistics &other) {
+    addElementwise(threadLocalSteps, other.threadLocalSteps);
+    addElementwise(memorySteps, other.memorySteps);
+    internalUpdates += other.internalUpdates;
+    idleInternalUpdates += other.idleInternalUpdates;
+    storage.merge(other.storage);
+}
+
+void PhaseTimer::start(std::string phase) {
+    stop();
+    m_current.emplace(std::move(phase), Clock::now());
+}
+
+void PhaseTimer::stop() {
+    if (!m_current) { return; }
+    std::chrono::duration<double> elapsed = Clock::now() - m_current->second;
+    m_seconds.emplace_back(std::move(m_current->first), elapsed.count());
+    m_current.reset();
+}
+
+void StatisticsReport::write(std::ostream &outputStream) const {
+    for (const auto &[label, statistics]: entries) {
+        std::vector<size_t> stepsPerThread = statistics.threadLocalSteps;
+        addElementwise(stepsPerThread, statistics.memorySteps);
+        outputStream << std::format(
+                "== {}\n"
+                "steps: {} ({} thread-local, {} memory)\n"
+                "steps per thread: {}\n"
+                "internal updates: {} performed, {} idle\n"
+                "max buffer depth: {}\n"
+                "max history length per location: {}\n"
+                "history pops: {}\n"
+                "view joins: {}\n",
+                label, statistics.steps(), sum(statistics.threadLocalSteps),
+                sum(statistics.memorySteps), joinNumbers(stepsPerThread, " "),
+                statistics.internalUpdates, statistics.idleInternalUpdates,
+                statistics.storage.maxBufferDepth,
+                statistics.storage.maxHistoryLengths.empty()
+                        ? "none"
+                        : joinNumbers(statistics.storage.maxHistoryLengths,
+                                      " "),
+                statistics.storage.historyPops, statistics.storage.viewJoins);
+    }
+    if (phaseSeconds.empty()) { return; }
+    outputStream << "== phases\n";
+    for (const auto &[phase, seconds]: phaseSeconds) {
+        outputStream << std::format("{}: {:.6f} s\n", phase, seconds);
+    }
+}
+
+void StatisticsReport::writeJson(std::ostream &outputStream) const {
+    outputStream << "{\"statistics\": {";
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto &[label, statistics] = entries[i];
+        outputStream << std::format(
+                "{}\"{}\": {{\"steps\": {}, \"threadLocalSteps\": [{}], "
+                "\"memorySteps\": [{}], \"internalUpdates\": {}, "
+                "\"idleInternalUpdates\": {}, \"maxBufferDepth\": {}, "
+                "\"maxHistoryLengths\": [{}], \"historyPops\": {}, "
+                "\"viewJoins\": {}}}",
+                i > 0 ? ", " : "", escapeJson(label), statistics.steps(),
+                joinNumbers(statistics.threadLocalSteps, ", "),
+                joinNumbers(statistics.memorySteps, ", "),
+                statistics.internalUpdates, statistics.idleInternalUpdates,
+                statistics.storage.maxBufferDepth,
+                joinNumbers(statistics.storage.maxHistoryLengths, ", "),
+                statistics.storage.historyPops, statistics.storage.viewJoins);
+    }
+    outputStream << "}, \"phases\": {";
+    for (size_t i = 0; i < phaseSeconds.size(); ++i) {
+        const auto &[phase, seconds] = phaseSeconds[i];
+        outputStream << std::format("{}\"{}\": {:.6f}", i > 0 ? ", " : "",
+                                    escapeJson(phase), seconds);
+    }
+    outputStream << "}}\n";
+}
+
+} // namespace wmm::execution
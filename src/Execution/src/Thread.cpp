@@ -2,36 +2,100 @@
 // Created by veronika on 21.10.23.
 //
 
+#include <stdexcept>
+#include <utility>
+
+#include "Probes.h"
+#include "StorageManagers.h"
 #include "Thread.h"
+#include "Util.h"
 
 namespace wmm::execution {
 
 using namespace program;
 
-static int32_t applyBinaryOperation(BinaryOperation operation, int32_t lhs,
-                                    int32_t rhs) {
-    int32_t value = 0;
-    switch (operation) {
-        case BinaryOperation::Addition:
-            value = lhs + rhs;
-            break;
-        case BinaryOperation::Subtraction:
-            value = lhs - rhs;
-            break;
-        case BinaryOperation::Multiplication:
-            value = lhs * rhs;
-            break;
-        case BinaryOperation::Division:
-            value = lhs / rhs;
-            break;
+template<class StorageManager>
+bool BasicThread<StorageManager>::isBlocked() const {
+    if (!m_isSpinning) return false;
+    auto cmd = std::dynamic_pointer_cast<Load>(getCurrentInstruction());
+    size_t address = m_localStorage.load(cmd->addressRegister);
+    // Nothing but the thread itself changes a private location
+    if (isPrivate(address)) { return true; }
+    return !m_storageManager->canLoadOtherValue(id, toShared(address),
+                                                m_lastLoadedValue);
+}
+
+template<class StorageManager>
+size_t BasicThread<StorageManager>::hashState() const {
+    size_t seed = m_localStorage.hash();
+    util::hashCombine(seed, m_privateStorage.hash());
+    util::hashCombine(seed, m_currentInstruction);
+    util::hashCombine(seed, m_isSpinning);
+    util::hashCombine(seed, m_lastLoadInstruction.value_or(SIZE_MAX));
+    util::hashCombine(seed, m_lastLoadedValue);
+    return seed;
+}
+
+template<class StorageManager>
+void BasicThread<StorageManager>::encodeState(
+        storage::StateWriter &writer) const {
+    m_localStorage.encode(writer);
+    m_privateStorage.encode(writer);
+    writer.writeIndex(m_currentInstruction, m_program.size() + 1);
+    writer.writeFlag(m_isSpinning);
+    writer.writeFlag(m_lastLoadInstruction.has_value());
+    if (m_lastLoadInstruction) {
+        writer.writeIndex(*m_lastLoadInstruction, m_program.size());
+    }
+    writer.writeValue(m_lastLoadedValue);
+}
+
+template<class StorageManager>
+void BasicThread<StorageManager>::decodeState(storage::StateReader &reader) {
+    m_localStorage.decode(reader);
+    m_privateStorage.decode(reader);
+    m_currentInstruction = reader.readIndex(m_program.size() + 1);
+    m_isSpinning = reader.readFlag();
+    m_lastLoadInstruction.reset();
+    if (reader.readFlag()) {
+        m_lastLoadInstruction = reader.readIndex(m_program.size());
     }
-    return value;
+    m_lastLoadedValue = reader.readValue();
 }
 
-bool Thread::evaluateInstruction() {
-    if (isFinished()) return false;
+template<class StorageManager>
+void BasicThread<StorageManager>::reset() {
+    m_localStorage.clear();
+    m_privateStorage.clear();
+    m_currentInstruction = 0;
+    m_lastLoadInstruction.reset();
+    m_lastLoadedValue = 0;
+    m_isSpinning = false;
+}
+
+template<class StorageManager>
+bool BasicThread<StorageManager>::evaluateInstruction() {
+    if (isFinished() || isBlocked()) return false;
     auto instruction = m_program.getInstruction(m_currentInstruction);
+    WMM_PROBE(instruction, id, m_currentInstruction,
+              static_cast<int>(instruction->action));
     size_t nextInstruction = m_currentInstruction + 1;
+    bool isSpinning = std::exchange(m_isSpinning, false);
+    if (isThreadLocal(instruction->action)) {
+        ++m_threadLocalSteps;
+    } else {
+        ++m_memorySteps;
+        m_lastLoadInstruction.reset();
+    }
+    execute(instruction, isSpinning, nextInstruction);
+    m_currentInstruction = nextInstruction;
+    return true;
+}
+
+template<class StorageManager>
+void BasicThread<StorageManager>::execute(const InstructionPtr &instruction,
+                                          bool isSpinning,
+                                          size_t &nextInstruction) {
     switch (instruction->action) {
         case InstructionAction::StoreConstInRegister: {
             auto cmd = *std::dynamic_pointer_cast<StoreConstInRegister>(
@@ -44,8 +108,11 @@ bool Thread::evaluateInstruction() {
                     instruction);
             int32_t lhs = m_localStorage.load(cmd.leftRegister);
             int32_t rhs = m_localStorage.load(cmd.rightRegister);
-            int32_t value = applyBinaryOperation(cmd.operation, lhs, rhs);
-            m_localStorage.store(cmd.storeRegister, value);
+            auto value = applyOperation(cmd.operation, lhs, rhs);
+            if (!value) {
+                throw std::domain_error("Failed to evaluate " + cmd.str());
+            }
+            m_localStorage.store(cmd.storeRegister, *value);
             break;
         }
         case InstructionAction::Goto: {
@@ -53,25 +120,48 @@ bool Thread::evaluateInstruction() {
             int32_t condition = m_localStorage.load(cmd.conditionRegister);
             if (condition != 0) {
                 nextInstruction = m_program.getLabelMapping(cmd.label);
+                auto spinLoopHead =
+                        m_program.getSpinLoopHead(m_currentInstruction);
+                m_isSpinning = spinLoopHead.has_value() &&
+                               spinLoopHead == m_lastLoadInstruction;
             }
+            m_lastLoadInstruction.reset();
             break;
         }
         case InstructionAction::Load: {
             auto cmd = *std::dynamic_pointer_cast<Load>(instruction);
             size_t address = m_localStorage.load(cmd.addressRegister);
-            int32_t value = m_storageManager->load(
-                    id, address,
-                    static_cast<storage::MemoryAccessMode>(cmd.mode));
+            auto mode = static_cast<storage::MemoryAccessMode>(cmd.mode);
+            int32_t value;
+            if (isPrivate(address)) {
+                value = m_privateStorage.load(address);
+            } else {
+                // Another iteration of a spin loop that loads the same value
+                // changes nothing, so it is skipped
+                value = isSpinning ? m_storageManager->loadOtherValue(
+                                             id, toShared(address),
+                                             m_lastLoadedValue, mode)
+                                   : m_storageManager->load(
+                                             id, toShared(address), mode);
+                WMM_PROBE(load, id, address, value, static_cast<int>(mode));
+            }
             m_localStorage.store(cmd.resultRegister, value);
+            m_lastLoadInstruction = m_currentInstruction;
+            m_lastLoadedValue = value;
             break;
         }
         case InstructionAction::Store: {
             auto cmd = *std::dynamic_pointer_cast<Store>(instruction);
             size_t address = m_localStorage.load(cmd.addressRegister);
             int32_t value = m_localStorage.load(cmd.valueRegister);
+            if (isPrivate(address)) {
+                m_privateStorage.store(address, value);
+                break;
+            }
             m_storageManager->store(
-                    id, address, value,
+                    id, toShared(address), value,
                     static_cast<storage::MemoryAccessMode>(cmd.mode));
+            WMM_PROBE(store, id, address, value, static_cast<int>(cmd.mode));
             break;
         }
         case InstructionAction::CompareAndSwap: {
@@ -80,9 +170,15 @@ bool Thread::evaluateInstruction() {
             int32_t expectedValue =
                     m_localStorage.load(cmd.expectedValueRegister);
             int32_t newValue = m_localStorage.load(cmd.newValueRegister);
-            m_storageManager->compareAndSwap(
-                    id, address, expectedValue, newValue,
+            int32_t value = m_storageManager->compareAndSwap(
+                    id, toShared(address), expectedValue, newValue,
                     static_cast<storage::MemoryAccessMode>(cmd.mode));
+            WMM_PROBE(compare_and_swap, id, address, expectedValue, newValue,
+                      static_cast<int>(cmd.mode));
+            if (cmd.resultRegister) {
+                m_localStorage.store(*cmd.resultRegister,
+                                     value == expectedValue);
+            }
             break;
         }
         case InstructionAction::FetchAndIncrement: {
@@ -91,22 +187,41 @@ bool Thread::evaluateInstruction() {
             size_t address = m_localStorage.load(cmd.addressRegister);
             int32_t increment = m_localStorage.load(cmd.incrementRegister);
             m_storageManager->fetchAndIncrement(
-                    id, address, increment,
+                    id, toShared(address), increment,
                     static_cast<storage::MemoryAccessMode>(cmd.mode));
+            WMM_PROBE(fetch_and_increment, id, address, increment,
+                      static_cast<int>(cmd.mode));
             break;
         }
         case InstructionAction::Fence: {
             auto cmd = *std::dynamic_pointer_cast<Fence>(instruction);
             m_storageManager->fence(id, static_cast<storage::MemoryAccessMode>(
                                                 cmd.memoryAccessMode));
+            WMM_PROBE(fence, id, static_cast<int>(cmd.memoryAccessMode));
+            break;
+        }
+        case InstructionAction::CompareAndSwapLoop: {
+            const auto &cmd =
+                    static_cast<const CompareAndSwapLoop &>(*instruction);
+            for (const auto &bodyInstruction: cmd.body) {
+                execute(bodyInstruction, false, nextInstruction);
+            }
+            // A failed iteration is followed by another one
+            if (m_localStorage.load(cmd.conditionRegister) != 0) {
+                nextInstruction = m_currentInstruction;
+            }
+            m_lastLoadInstruction.reset();
             break;
         }
     }
-    m_currentInstruction = nextInstruction;
-    return true;
 }
-std::shared_ptr<program::Instruction> Thread::getCurrentInstruction() const {
+
+template<class StorageManager>
+std::shared_ptr<program::Instruction>
+BasicThread<StorageManager>::getCurrentInstruction() const {
     return m_program.getInstruction(m_currentInstruction);
 }
 
+INSTANTIATE_FOR_STORAGE_MANAGERS(BasicThread)
+
 } // namespace wmm::executor
\ No newline at end of file
@@ -1,30 +1,43 @@
 #include "ThreadManager.h"
 #include <algorithm>
 
+#include "StorageManagers.h"
+
 namespace wmm::execution {
 
-ThreadManager::ThreadManager(const std::vector<program::Program> &programs,
-                             storage::StorageManagerPtr storageManager,
-                             size_t threadLocalStorageSize)
+template<class StorageManager>
+BasicThreadManager<StorageManager>::BasicThreadManager(
+        const std::vector<program::Program> &programs,
+        std::shared_ptr<StorageManager> storageManager,
+        size_t threadLocalStorageSize, const MemoryLayoutPtr &layout)
     : m_storageManager(std::move(storageManager)) {
     m_threads.reserve(programs.size());
     for (const auto &program: programs) {
         m_threads.emplace_back(program, m_storageManager, m_threads.size(),
-                               threadLocalStorageSize);
+                               threadLocalStorageSize, layout);
     }
 }
 
-bool ThreadManager::evaluateThread(size_t threadId) {
+template<class StorageManager>
+void BasicThreadManager<StorageManager>::reset() {
+    for (auto &thread: m_threads) { thread.reset(); }
+}
+
+template<class StorageManager>
+bool BasicThreadManager<StorageManager>::evaluateThread(size_t threadId) {
     bool returnValue = m_threads.at(threadId).evaluateInstruction();
     return returnValue;
 }
 
-bool ThreadManager::allThreadsCompleted() const {
+template<class StorageManager>
+bool BasicThreadManager<StorageManager>::allThreadsCompleted() const {
     return std::all_of(m_threads.begin(), m_threads.end(),
                        [](const auto &thread) { return thread.isFinished(); });
 }
 
-std::vector<storage::Storage> ThreadManager::getThreadLocalStorages() const {
+template<class StorageManager>
+std::vector<storage::Storage>
+BasicThreadManager<StorageManager>::getThreadLocalStorages() const {
     std::vector<storage::Storage> storages;
     storages.reserve(m_threads.size());
     for (const auto &thread: m_threads) {
@@ -33,11 +46,22 @@ std::vector<storage::Storage> ThreadManager::getThreadLocalStorages() const {
     return storages;
 }
 
-const storage::Storage &ThreadManager::getThreadLocalStorage(size_t threadId) const {
+template<class StorageManager>
+const storage::Storage &
+BasicThreadManager<StorageManager>::getThreadLocalStorage(
+        size_t threadId) const {
     return m_threads.at(threadId).getLocalStorage();
 }
 
-std::vector<size_t> ThreadManager::unfinishedThreads() const {
+template<class StorageManager>
+const storage::Storage &
+BasicThreadManager<StorageManager>::getPrivateStorage(size_t threadId) const {
+    return m_threads.at(threadId).getPrivateStorage();
+}
+
+template<class StorageManager>
+std::vector<size_t>
+BasicThreadManager<StorageManager>::unfinishedThreads() const {
     std::vector<size_t> unfinishedThreads;
     for (const auto &thread: m_threads) {
         if (!thread.isFinished()) { unfinishedThreads.push_back(thread.id); }
@@ -45,29 +69,104 @@ std::vector<size_t> ThreadManager::unfinishedThreads() const {
     return unfinishedThreads;
 }
 
-size_t ThreadManager::size() const { return m_threads.size(); }
+template<class StorageManager>
+std::vector<size_t>
+BasicThreadManager<StorageManager>::runnableThreads() const {
+    std::vector<size_t> runnableThreads;
+    for (const auto &thread: m_threads) {
+        if (!thread.isFinished() && !thread.isBlocked()) {
+            runnableThreads.push_back(thread.id);
+        }
+    }
+    return runnableThreads;
+}
+
+template<class StorageManager>
+size_t BasicThreadManager<StorageManager>::size() const {
+    return m_threads.size();
+}
+
+template<class StorageManager>
+size_t
+BasicThreadManager<StorageManager>::hashThreadState(size_t threadId) const {
+    return m_threads.at(threadId).hashState();
+}
+
+template<class StorageManager>
+void BasicThreadManager<StorageManager>::encodeState(
+        storage::StateWriter &writer) const {
+    for (const auto &thread: m_threads) { thread.encodeState(writer); }
+}
+
+template<class StorageManager>
+void BasicThreadManager<StorageManager>::decodeState(
+        storage::StateReader &reader) {
+    for (auto &thread: m_threads) { thread.decodeState(reader); }
+}
 
+template<class StorageManager>
+void BasicThreadManager<StorageManager>::encodeThreadState(
+        size_t threadId, storage::StateWriter &writer) const {
+    m_threads.at(threadId).encodeState(writer);
+}
+
+template<class StorageManager>
+void BasicThreadManager<StorageManager>::permuteThreads(
+        const std::vector<size_t> &order) {
+    std::vector<storage::PackedState> states;
+    states.reserve(order.size());
+    for (auto threadId: order) {
+        storage::StateWriter writer;
+        m_threads.at(threadId).encodeState(writer);
+        states.push_back(writer.finish());
+    }
+    for (size_t threadId = 0; threadId < states.size(); ++threadId) {
+        storage::StateReader reader(states[threadId]);
+        m_threads[threadId].decodeState(reader);
+    }
+}
+
+template<class StorageManager>
 std::shared_ptr<program::Instruction>
-ThreadManager::getCurrentInstructionForThread(size_t threadId) const {
+BasicThreadManager<StorageManager>::getCurrentInstructionForThread(
+        size_t threadId) const {
     return m_threads.at(threadId).getCurrentInstruction();
 }
 
-void ThreadManager::evaluateThreadLocalInstructions(size_t threadId) {
+template<class StorageManager>
+size_t BasicThreadManager<StorageManager>::getCurrentPositionForThread(
+        size_t threadId) const {
+    return m_threads.at(threadId).getCurrentPosition();
+}
+
+template<class StorageManager>
+void BasicThreadManager<StorageManager>::collectStatistics(
+        ExecutionStatistics &statistics) const {
+    ExecutionStatistics threadStatistics;
+    for (const auto &thread: m_threads) {
+        threadStatistics.threadLocalSteps.push_back(
+                thread.getThreadLocalSteps());
+        threadStatistics.memorySteps.push_back(thread.getMemorySteps());
+    }
+    statistics.merge(threadStatistics);
+}
+
+template<class StorageManager>
+void BasicThreadManager<StorageManager>::evaluateThreadLocalInstructions(
+        size_t threadId) {
     while (auto instruction = m_threads.at(threadId).getCurrentInstruction()) {
-        switch (instruction->action) {
-            case program::InstructionAction::StoreConstInRegister:
-            case program::InstructionAction::StoreExprInRegister:
-            case program::InstructionAction::Goto:
-                m_threads[threadId].evaluateInstruction();
-                break;
-            case program::InstructionAction::Load:
-            case program::InstructionAction::Store:
-            case program::InstructionAction::CompareAndSwap:
-            case program::InstructionAction::FetchAndIncrement:
-            case program::InstructionAction::Fence:
-                return;
-        }
+        if (!program::isThreadLocal(instruction->action)) { return; }
+        m_threads[threadId].evaluateInstruction();
     }
 }
 
+template<class StorageManager>
+bool BasicThreadManager<StorageManager>::isNextInstructionThreadLocal(
+        size_t threadId) const {
+    auto instruction = m_threads.at(threadId).getCurrentInstruction();
+    return instruction && program::isThreadLocal(instruction->action);
+}
+
+INSTANTIATE_FOR_STORAGE_MANAGERS(BasicThreadManager)
+
 } // namespace wmm::execution
\ No newline at end of file
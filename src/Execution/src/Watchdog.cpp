@@ -0,0 +1,32 @@
+#include <sstream>
+
+#include "Watchdog.h"
+
+namespace wmm::execution {
+
+std::string toString(ExecutionStatus status) {
+    switch (status) {
+        case ExecutionStatus::Completed:
+            return "completed";
+        case ExecutionStatus::Deadlocked:
+            return "deadlocked";
+        case ExecutionStatus::Livelocked:
+            return "livelocked";
+        case ExecutionStatus::StepLimitExceeded:
+            return "step limit exceeded";
+    }
+    return "";
+}
+
+ExecutionReport Watchdog::run(ExecutorInterface &executor) const {
+    return run(executor, []() {});
+}
+
+ExecutionReport Watchdog::abandon(const ExecutorInterface &executor,
+                                  ExecutionStatus status, size_t steps) {
+    std::stringstream snapshot;
+    executor.writeState(snapshot);
+    return {status, steps, snapshot.str()};
+}
+
+} // namespace wmm::execution
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Program.h"
+
+namespace wmm::program {
+
+/**
+ * Compiled programs (`.wmmb`). The file starts with a header and a table of
+ * the programs, followed by fixed-size instruction records and label tables
+ * that are addressed by offsets from the start of the file, so the file can
+ * be mapped and read in place. Integers are stored in the native byte order.
+ * Labels are stored with their instruction positions, so nothing is resolved
+ * at load time, and the instructions of all programs of a file are built in a
+ * single allocation. Version 2 added the result register of a cas, files of
+ * version 1 have none and are read the same way.
+ */
+class BinaryFormat {
+public:
+    static constexpr uint32_t VERSION = 2;
+    static constexpr uint32_t OLDEST_VERSION = 1;
+    static constexpr std::string_view EXTENSION = ".wmmb";
+
+    static void write(const std::vector<Program> &programs,
+                      std::ostream &stream);
+    static std::vector<Program> read(std::string_view buffer);
+
+    /**
+     * @return true if the buffer starts with the magic of the format
+     */
+    static bool isBinary(std::string_view buffer);
+};
+
+} // namespace wmm::program
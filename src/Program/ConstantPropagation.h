@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "Program.h"
+
+namespace wmm::program {
+
+/**
+ * Register values known at the start of every instruction of a program.
+ * Registers start at zero; a register written by a load or a cas, or computed
+ * from an unknown register, is unknown. Jumps on a known condition only
+ * follow the taken edge, and a jump to a missing label stops the execution.
+ */
+class ConstantPropagation {
+public:
+    // Value of every register, nullopt if it is unknown, registers past the
+    // end are zero
+    using RegisterValues = std::vector<std::optional<int32_t>>;
+
+    explicit ConstantPropagation(const Program &program);
+
+    [[nodiscard]] bool isReachable(size_t position) const {
+        return position < m_states.size() && m_states[position].has_value();
+    }
+
+    /**
+     * @return value of the register before the instruction, nullopt if it is
+     * unknown or the instruction is unreachable
+     */
+    [[nodiscard]] std::optional<int32_t> getValue(size_t position,
+                                                  size_t reg) const;
+
+private:
+    std::vector<std::optional<RegisterValues>> m_states;
+};
+
+} // namespace wmm::program
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <optional>
+#include <set>
+#include <vector>
+
+#include "Program.h"
+
+namespace wmm::program {
+
+/**
+ * Shared locations accessed by a thread, found by constant propagation over
+ * its registers (see ConstantPropagation)
+ */
+class Footprint {
+    // Address of every instruction, nullopt if the instruction doesn't access
+    // memory or its address is not known statically
+    std::vector<std::optional<size_t>> m_addresses;
+    std::set<size_t> m_reads;
+    std::set<size_t> m_writes;
+    bool m_isComplete = true;
+
+public:
+    explicit Footprint(const Program &program);
+
+    /**
+     * @return the location accessed by the instruction, if it is the same in
+     * every execution
+     */
+    [[nodiscard]] std::optional<size_t> getAddress(size_t instruction) const;
+
+    [[nodiscard]] const std::set<size_t> &getReads() const { return m_reads; }
+    [[nodiscard]] const std::set<size_t> &getWrites() const {
+        return m_writes;
+    }
+
+    /**
+     * @return false if some reachable access has an unknown address, the
+     * reads and writes are then a lower bound
+     */
+    [[nodiscard]] bool isComplete() const { return m_isComplete; }
+};
+
+std::vector<Footprint> analyzeFootprints(const std::vector<Program> &programs);
+
+/**
+ * @return one more than the highest accessed location, if every address is
+ * known
+ */
+std::optional<size_t>
+getRequiredStorageSize(const std::vector<Footprint> &footprints);
+
+/**
+ * A load of a location no other thread writes, or a store to a location no
+ * other thread accesses, gives the same result in any order with the steps of
+ * the other threads. Sequentially consistent accesses and read-modify-writes
+ * are never commuting, as they may synchronize with other locations.
+ *
+ * @return commuting[threadId][instruction], all false unless every address
+ * is known
+ */
+std::vector<std::vector<bool>>
+findCommutingAccesses(const std::vector<Program> &programs,
+                      const std::vector<Footprint> &footprints);
+
+} // namespace wmm::program
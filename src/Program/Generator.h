@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include "Instructions.h"
+#include "Program.h"
+
+namespace wmm::program {
+
+/**
+ * Random valid programs for stress tests and benchmarks. The programs are
+ * built in memory, Parser::writeToStream turns them into `.wmm` text.
+ *
+ * Register layout of every thread: register 0 holds 1, registers
+ * 1..nOfAddresses hold the addresses 0..nOfAddresses-1, the next one is the
+ * loop counter and the rest hold values. Loops are bounded by the counter,
+ * so every generated program terminates.
+ */
+class Generator {
+public:
+    struct Config {
+        size_t nOfThreads = 2;
+        // Instructions per thread, the register setup is not counted
+        size_t programLength = 10;
+        size_t nOfAddresses = 2;
+        // Must fit the thread-local storage of the executor
+        size_t nOfRegisters = 10;
+        // Relative weights of SEQ_CST, REL, ACQ, REL_ACQ and RLX
+        std::array<double, 5> modeWeights = {1, 1, 1, 1, 1};
+        // Relative weights of load, store, cas, fai, fence and register
+        // arithmetic
+        std::array<double, 6> instructionWeights = {4, 4, 1, 1, 1, 2};
+        // Probability that a loop starts at an instruction
+        double loopDensity = 0.1;
+        size_t maxLoopLength = 4;
+        size_t maxLoopIterations = 3;
+    };
+
+    Generator(Config config, unsigned long seed);
+
+    [[nodiscard]] std::vector<Program> generate();
+
+private:
+    Config m_config;
+    std::mt19937 m_randomGenerator;
+    std::discrete_distribution<size_t> m_modeDistribution;
+    std::discrete_distribution<size_t> m_instructionDistribution;
+
+    [[nodiscard]] Program generateThread();
+    [[nodiscard]] InstructionPtr generateInstruction();
+    [[nodiscard]] MemoryAccessMode generateMode();
+    [[nodiscard]] size_t addressRegister();
+    [[nodiscard]] size_t valueRegister();
+    [[nodiscard]] size_t counterRegister() const;
+};
+
+} // namespace wmm::program
@@ -2,6 +2,8 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace wmm::program {
@@ -25,10 +27,25 @@ enum class InstructionAction {
     CompareAndSwap,
     FetchAndIncrement,
     Fence,
+    // Superinstruction made by Optimizer, not part of the text format
+    CompareAndSwapLoop,
 };
 
+/**
+ * @return true if the instruction only accesses thread-local registers
+ */
+bool isThreadLocal(InstructionAction action);
+
 enum class BinaryOperation { Addition, Subtraction, Multiplication, Division };
 
+/**
+ * The value StoreExprInRegister computes, shared by all engines. Overflows
+ * wrap, a division by zero or of the minimum by -1 has no value and fails the
+ * execution.
+ */
+std::optional<int32_t> applyOperation(BinaryOperation operation, int32_t lhs,
+                                      int32_t rhs);
+
 struct Instruction;
 using InstructionPtr = std::shared_ptr<Instruction>;
 
@@ -110,13 +127,61 @@ InstructionImplementation3(Load, MemoryAccessMode, mode, size_t,
                            addressRegister, size_t, resultRegister);
 InstructionImplementation3(Store, MemoryAccessMode, mode, size_t,
                            addressRegister, size_t, valueRegister);
-InstructionImplementation4(CompareAndSwap, MemoryAccessMode, mode, size_t,
-                           addressRegister, size_t, expectedValueRegister,
-                           size_t, newValueRegister);
 InstructionImplementation3(FetchAndIncrement, MemoryAccessMode, mode, size_t,
                            addressRegister, size_t, incrementRegister);
 InstructionImplementation1(Fence, MemoryAccessMode, memoryAccessMode);
 
+struct CompareAndSwap : Instruction {
+    const MemoryAccessMode mode;
+    const size_t addressRegister;
+    const size_t expectedValueRegister;
+    const size_t newValueRegister;
+    // Set to 1 if the new value was written and to 0 otherwise
+    const std::optional<size_t> resultRegister;
+
+    std::string str() const override;
+
+    explicit CompareAndSwap(MemoryAccessMode mode_, size_t addressRegister_,
+                            size_t expectedValueRegister_,
+                            size_t newValueRegister_,
+                            std::optional<size_t> resultRegister_ = {})
+        : Instruction(InstructionAction::CompareAndSwap), mode(mode_),
+          addressRegister(addressRegister_),
+          expectedValueRegister(expectedValueRegister_),
+          newValueRegister(newValueRegister_),
+          resultRegister(resultRegister_) {}
+};
+
+/**
+ * A compare-and-swap retry loop fused into one instruction: a load, register
+ * instructions, a cas of the loaded value to the same address, an
+ * instruction that computes whether the cas failed and a jump back to the
+ * load on failure. One step runs a whole iteration, so no other thread runs
+ * between the load and the cas, and the thread stays at the instruction
+ * while the condition is nonzero.
+ */
+struct CompareAndSwapLoop : Instruction {
+    // The instructions of an iteration without the jump
+    const std::vector<InstructionPtr> body;
+    const size_t conditionRegister;
+
+    std::string str() const override;
+
+    CompareAndSwapLoop(std::vector<InstructionPtr> body_,
+                       size_t conditionRegister_)
+        : Instruction(InstructionAction::CompareAndSwapLoop),
+          body(std::move(body_)), conditionRegister(conditionRegister_) {}
+
+    [[nodiscard]] const CompareAndSwap &getCompareAndSwap() const {
+        return static_cast<const CompareAndSwap &>(*body[body.size() - 2]);
+    }
+};
+
+/**
+ * @return the registers the instruction may write
+ */
+std::vector<size_t> getWrittenRegisters(const Instruction &instruction);
+
 #undef InstructionImplementation1
 #undef InstructionImplementation2
 #undef InstructionImplementation3
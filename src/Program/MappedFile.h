@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace wmm::program {
+
+/**
+ * Read-only memory mapping of a whole file
+ */
+class MappedFile {
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] std::string_view view() const { return {m_data, m_size}; }
+};
+
+} // namespace wmm::program
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <vector>
+
+#include "Program.h"
+
+namespace wmm::program {
+
+/**
+ * Rewrites a program into one with the same memory accesses and the same
+ * final registers that takes fewer steps:
+ * - register arithmetic on known values is folded into constants,
+ * - jumps that are never taken and unreachable instructions are removed,
+ * - a jump to a jump that is always (or never) taken is redirected to where
+ *   the second jump leads,
+ * - register writes that are overwritten before being read are removed. All
+ *   registers are observable when the program ends, so only writes that are
+ *   overwritten on every path are dead,
+ * - a compare-and-swap retry loop becomes a CompareAndSwapLoop. Running the
+ *   load and the cas of an iteration without other threads in between only
+ *   drops failed iterations: the last iteration overwrites their registers,
+ *   and the views they raise under RA only restrict later reads.
+ */
+class Optimizer {
+public:
+    struct Stats {
+        size_t foldedExpressions = 0;
+        size_t removedJumps = 0;
+        size_t threadedJumps = 0;
+        size_t removedUnreachable = 0;
+        size_t removedDeadStores = 0;
+        size_t fusedLoops = 0;
+    };
+
+    [[nodiscard]] static Program optimize(const Program &program,
+                                          Stats *stats = nullptr);
+    [[nodiscard]] static std::vector<Program>
+    optimize(const std::vector<Program> &programs, Stats *stats = nullptr);
+};
+
+} // namespace wmm::program
@@ -5,10 +5,12 @@
 #pragma once
 
 #include <map>
+#include <optional>
+#include <span>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
-#include <optional>
 
 #include "Instructions.h"
 #include "Program.h"
@@ -25,7 +27,7 @@ enum class Command {
     Other
 };
 
-const std::map<std::string, Command> STRING_TO_COMMAND = {
+const std::map<std::string, Command, std::less<>> STRING_TO_COMMAND = {
         {"if", Command::If},
         {"load", Command::Load},
         {"store", Command::Store},
@@ -34,7 +36,7 @@ const std::map<std::string, Command> STRING_TO_COMMAND = {
         {"fence", Command::Fence},
 };
 
-const std::map<std::string, MemoryAccessMode> STRING_TO_MODE = {
+const std::map<std::string, MemoryAccessMode, std::less<>> STRING_TO_MODE = {
         {"SEQ_CST", MemoryAccessMode::SequentialConsistency},
         {"REL", MemoryAccessMode::Release},
         {"ACQ", MemoryAccessMode::Acquire},
@@ -58,13 +60,32 @@ struct ParsingError : std::runtime_error {
 };
 
 class Parser {
-    static InstructionPtr parseStoreInRegister(const std::vector<std::string> &tokens);
+    static InstructionPtr
+    parseStoreInRegister(std::span<const std::string_view> tokens);
 
 public:
-    static std::tuple<std::optional<Label>, InstructionPtr> parseLine(const std::string &line);
+    static std::tuple<std::optional<Label>, InstructionPtr>
+    parseLine(std::string_view line);
     static std::vector<Program> parseFromStream(std::istream &stream);
     static std::vector<Program> parseFromString(const std::string &input);
 
+    /**
+     * Parses the programs in place, without copying the lines or the tokens
+     */
+    static std::vector<Program> parseFromBuffer(std::string_view input);
+
+    /**
+     * Maps the file into memory and parses it with parseFromBuffer, compiled
+     * programs (see BinaryFormat) are recognized by their header
+     */
+    static std::vector<Program> parseFromFile(const std::string &path);
+
+    /**
+     * Writes the programs in the syntax accepted by parseFromStream
+     */
+    static void writeToStream(const std::vector<Program> &programs,
+                              std::ostream &stream);
+
     static constexpr std::string THREAD_SEPARATOR = "MAKETHREAD";
 };
 
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "Instructions.h"
 
@@ -9,21 +11,60 @@ namespace wmm::program {
 
 using Label = size_t;
 
+/**
+ * Immutable parsed program, copies share the instructions and the label table
+ */
 class Program {
-    const std::vector<std::shared_ptr<Instruction>> m_program;
-    const std::unordered_map<Label, size_t> m_labelMapping;
+    struct Code {
+        std::vector<std::shared_ptr<Instruction>> instructions;
+        std::unordered_map<Label, size_t> labelMapping;
+        // Back edge of a spin loop -> the load at the head of the loop
+        std::unordered_map<size_t, size_t> spinLoops;
+    };
+
+    std::shared_ptr<const Code> m_code;
+
+    static std::unordered_map<size_t, size_t>
+    findSpinLoops(const std::vector<std::shared_ptr<Instruction>> &program,
+                  const std::unordered_map<Label, size_t> &labelMapping);
 
 public:
     [[nodiscard]] std::shared_ptr<Instruction>
     getInstruction(size_t instruction) const;
 
     [[nodiscard]] size_t getLabelMapping(size_t label) const;
+    [[nodiscard]] const std::unordered_map<Label, size_t> &getLabels() const;
     [[nodiscard]] size_t size() const;
 
+    /**
+     * A spin loop is a load followed by register-only instructions and a
+     * conditional jump back to the load, where every iteration recomputes the
+     * registers it reads from the loaded value. Repeating an iteration that
+     * loads the same value changes nothing, so the thread can wait until
+     * another value may be loaded.
+     *
+     * @return position of the load if the instruction is the back edge of a
+     * spin loop
+     */
+    [[nodiscard]] std::optional<size_t>
+    getSpinLoopHead(size_t instruction) const;
+
     Program(std::vector<std::shared_ptr<Instruction>> &&program,
-            std::unordered_map<Label, size_t> &&labelMapping)
-        : m_program(std::move(program)), m_labelMapping(std::move(labelMapping)) {
-    }
+            std::unordered_map<Label, size_t> &&labelMapping);
+
+    /**
+     * @return true if the instructions and the labels are the same
+     */
+    bool operator==(const Program &other) const;
 };
 
+/**
+ * Threads with equal programs start with the same registers, as registers
+ * are only set by instructions, and behave the same. Swapping two of them in
+ * any state gives a state with the same behaviour up to the swap.
+ *
+ * @return for every thread the first thread with an equal program
+ */
+std::vector<size_t> findSymmetricThreads(const std::vector<Program> &programs);
+
 } // namespace wmm
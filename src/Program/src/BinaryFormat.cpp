@@ -0,0 +1,313 @@
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <variant>
+
+#include "BinaryFormat.h"
+
+namespace wmm::program {
+
+namespace {
+
+// Not a valid first byte of a text program
+constexpr char MAGIC[4] = {'\x7f', 'W', 'M', 'B'};
+
+struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t nOfPrograms;
+    uint32_t reserved;
+};
+
+struct ProgramEntry {
+    uint64_t instructionsOffset;
+    uint64_t nOfInstructions;
+    uint64_t labelsOffset;
+    uint64_t nOfLabels;
+};
+
+// Set in EncodedInstruction::flags if the cas has a result register
+constexpr uint8_t HAS_RESULT_REGISTER = 1;
+
+struct EncodedInstruction {
+    uint8_t action;
+    // Memory access mode or binary operation
+    uint8_t mode;
+    uint8_t flags;
+    uint8_t reserved;
+    uint32_t resultRegister;
+    uint64_t operands[3];
+};
+
+struct EncodedLabel {
+    uint64_t label;
+    uint64_t position;
+};
+
+using AnyInstruction =
+        std::variant<StoreConstInRegister, StoreExprInRegister, Goto, Load,
+                     Store, CompareAndSwap, FetchAndIncrement, Fence>;
+
+EncodedInstruction encode(const Instruction &instruction) {
+    EncodedInstruction encoded{};
+    encoded.action = static_cast<uint8_t>(instruction.action);
+    auto *operands = encoded.operands;
+    switch (instruction.action) {
+        case InstructionAction::StoreConstInRegister: {
+            const auto &cmd =
+                    static_cast<const StoreConstInRegister &>(instruction);
+            operands[0] = cmd.storeRegister;
+            operands[1] = static_cast<uint32_t>(cmd.value);
+            break;
+        }
+        case InstructionAction::StoreExprInRegister: {
+            const auto &cmd =
+                    static_cast<const StoreExprInRegister &>(instruction);
+            encoded.mode = static_cast<uint8_t>(cmd.operation);
+            operands[0] = cmd.storeRegister;
+            operands[1] = cmd.leftRegister;
+            operands[2] = cmd.rightRegister;
+            break;
+        }
+        case InstructionAction::Goto: {
+            const auto &cmd = static_cast<const Goto &>(instruction);
+            operands[0] = cmd.conditionRegister;
+            operands[1] = cmd.label;
+            break;
+        }
+        case InstructionAction::Load: {
+            const auto &cmd = static_cast<const Load &>(instruction);
+            encoded.mode = static_cast<uint8_t>(cmd.mode);
+            operands[0] = cmd.addressRegister;
+            operands[1] = cmd.resultRegister;
+            break;
+        }
+        case InstructionAction::Store: {
+            const auto &cmd = static_cast<const Store &>(instruction);
+            encoded.mode = static_cast<uint8_t>(cmd.mode);
+            operands[0] = cmd.addressRegister;
+            operands[1] = cmd.valueRegister;
+            break;
+        }
+        case InstructionAction::CompareAndSwap: {
+            const auto &cmd = static_cast<const CompareAndSwap &>(instruction);
+            encoded.mode = static_cast<uint8_t>(cmd.mode);
+            operands[0] = cmd.addressRegister;
+            operands[1] = cmd.expectedValueRegister;
+            operands[2] = cmd.newValueRegister;
+            if (cmd.resultRegister) {
+                if (*cmd.resultRegister > UINT32_MAX) {
+                    throw std::runtime_error("Result register out of range");
+                }
+                encoded.flags = HAS_RESULT_REGISTER;
+                encoded.resultRegister = *cmd.resultRegister;
+            }
+            break;
+        }
+        case InstructionAction::FetchAndIncrement: {
+            const auto &cmd =
+                    static_cast<const FetchAndIncrement &>(instruction);
+            encoded.mode = static_cast<uint8_t>(cmd.mode);
+            operands[0] = cmd.addressRegister;
+            operands[1] = cmd.incrementRegister;
+            break;
+        }
+        case InstructionAction::Fence: {
+            const auto &cmd = static_cast<const Fence &>(instruction);
+            encoded.mode = static_cast<uint8_t>(cmd.memoryAccessMode);
+            break;
+        }
+        case InstructionAction::CompareAndSwapLoop:
+            throw std::runtime_error("Fused loops can't be compiled");
+    }
+    return encoded;
+}
+
+MemoryAccessMode decodeMode(uint8_t mode) {
+    if (mode > static_cast<uint8_t>(MemoryAccessMode::Relaxed)) {
+        throw std::runtime_error("Invalid memory access mode");
+    }
+    return static_cast<MemoryAccessMode>(mode);
+}
+
+BinaryOperation decodeOperation(uint8_t operation) {
+    if (operation > static_cast<uint8_t>(BinaryOperation::Division)) {
+        throw std::runtime_error("Invalid binary operation");
+    }
+    return static_cast<BinaryOperation>(operation);
+}
+
+template<typename T, typename... Args>
+Instruction &emplace(std::vector<AnyInstruction> &instructions,
+                     Args... args) {
+    return std::get<T>(
+            instructions.emplace_back(std::in_place_type<T>, args...));
+}
+
+Instruction &decode(const EncodedInstruction &encoded,
+                    std::vector<AnyInstruction> &instructions) {
+    const auto *operands = encoded.operands;
+    if (encoded.action > static_cast<uint8_t>(InstructionAction::Fence)) {
+        throw std::runtime_error("Invalid instruction");
+    }
+    switch (static_cast<InstructionAction>(encoded.action)) {
+        case InstructionAction::StoreConstInRegister:
+            return emplace<StoreConstInRegister>(
+                    instructions, operands[0],
+                    static_cast<int32_t>(operands[1]));
+        case InstructionAction::StoreExprInRegister:
+            return emplace<StoreExprInRegister>(
+                    instructions, operands[0], operands[1],
+                    decodeOperation(encoded.mode), operands[2]);
+        case InstructionAction::Goto:
+            return emplace<Goto>(instructions, operands[0], operands[1]);
+        case InstructionAction::Load:
+            return emplace<Load>(instructions, decodeMode(encoded.mode),
+                                 operands[0], operands[1]);
+        case InstructionAction::Store:
+            return emplace<Store>(instructions, decodeMode(encoded.mode),
+                                  operands[0], operands[1]);
+        case InstructionAction::CompareAndSwap: {
+            std::optional<size_t> resultRegister;
+            if (encoded.flags & HAS_RESULT_REGISTER) {
+                resultRegister = encoded.resultRegister;
+            }
+            return emplace<CompareAndSwap>(instructions,
+                                           decodeMode(encoded.mode),
+                                           operands[0], operands[1],
+                                           operands[2], resultRegister);
+        }
+        case InstructionAction::FetchAndIncrement:
+            return emplace<FetchAndIncrement>(instructions,
+                                              decodeMode(encoded.mode),
+                                              operands[0], operands[1]);
+        case InstructionAction::Fence:
+            return emplace<Fence>(instructions, decodeMode(encoded.mode));
+        case InstructionAction::CompareAndSwapLoop:
+            break;
+    }
+    throw std::runtime_error("Invalid instruction");
+}
+
+// Checks that `count` records of the type fit the buffer at the offset
+template<typename T>
+void checkRange(std::string_view buffer, uint64_t offset, uint64_t count) {
+    if (offset > buffer.size() ||
+        count > (buffer.size() - offset) / sizeof(T)) {
+        throw std::runtime_error("Truncated compiled program");
+    }
+}
+
+template<typename T>
+T readRecord(std::string_view buffer, uint64_t offset) {
+    T record;
+    std::memcpy(&record, buffer.data() + offset, sizeof(T));
+    return record;
+}
+
+template<typename T>
+void writeRecord(std::ostream &stream, const T &record) {
+    stream.write(reinterpret_cast<const char *>(&record), sizeof(T));
+}
+
+static_assert(sizeof(Header) == 16);
+static_assert(sizeof(ProgramEntry) == 32);
+static_assert(sizeof(EncodedInstruction) == 32);
+static_assert(sizeof(EncodedLabel) == 16);
+
+} // namespace
+
+void BinaryFormat::write(const std::vector<Program> &programs,
+                         std::ostream &stream) {
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.nOfPrograms = programs.size();
+    writeRecord(stream, header);
+
+    uint64_t offset =
+            sizeof(Header) + programs.size() * sizeof(ProgramEntry);
+    for (const auto &program: programs) {
+        ProgramEntry entry{};
+        entry.instructionsOffset = offset;
+        entry.nOfInstructions = program.size();
+        offset += program.size() * sizeof(EncodedInstruction);
+        entry.labelsOffset = offset;
+        entry.nOfLabels = program.getLabels().size();
+        offset += entry.nOfLabels * sizeof(EncodedLabel);
+        writeRecord(stream, entry);
+    }
+    for (const auto &program: programs) {
+        for (size_t i = 0; i < program.size(); ++i) {
+            writeRecord(stream, encode(*program.getInstruction(i)));
+        }
+        // Sorted, so that the same programs give the same file
+        std::map<Label, size_t> labels(program.getLabels().begin(),
+                                       program.getLabels().end());
+        for (auto [label, position]: labels) {
+            writeRecord(stream, EncodedLabel{label, position});
+        }
+    }
+}
+
+std::vector<Program> BinaryFormat::read(std::string_view buffer) {
+    if (!isBinary(buffer)) {
+        throw std::runtime_error("Not a compiled program");
+    }
+    checkRange<Header>(buffer, 0, 1);
+    auto header = readRecord<Header>(buffer, 0);
+    if (header.version < OLDEST_VERSION || header.version > VERSION) {
+        throw std::runtime_error("Unsupported compiled program version " +
+                                 std::to_string(header.version));
+    }
+    checkRange<ProgramEntry>(buffer, sizeof(Header), header.nOfPrograms);
+    std::vector<ProgramEntry> entries;
+    entries.reserve(header.nOfPrograms);
+    uint64_t nOfInstructions = 0;
+    for (size_t i = 0; i < header.nOfPrograms; ++i) {
+        auto entry = readRecord<ProgramEntry>(
+                buffer, sizeof(Header) + i * sizeof(ProgramEntry));
+        checkRange<EncodedInstruction>(buffer, entry.instructionsOffset,
+                                       entry.nOfInstructions);
+        checkRange<EncodedLabel>(buffer, entry.labelsOffset,
+                                 entry.nOfLabels);
+        nOfInstructions += entry.nOfInstructions;
+        entries.push_back(entry);
+    }
+
+    // The instruction pointers share the ownership of a single array, it must
+    // not be reallocated while it is filled
+    auto instructions = std::make_shared<std::vector<AnyInstruction>>();
+    instructions->reserve(nOfInstructions);
+    std::vector<Program> programs;
+    programs.reserve(entries.size());
+    for (const auto &entry: entries) {
+        std::vector<InstructionPtr> program;
+        program.reserve(entry.nOfInstructions);
+        for (size_t i = 0; i < entry.nOfInstructions; ++i) {
+            auto encoded = readRecord<EncodedInstruction>(
+                    buffer,
+                    entry.instructionsOffset + i * sizeof(EncodedInstruction));
+            program.emplace_back(instructions,
+                                 &decode(encoded, *instructions));
+        }
+        std::unordered_map<Label, size_t> labelMapping;
+        labelMapping.reserve(entry.nOfLabels);
+        for (size_t i = 0; i < entry.nOfLabels; ++i) {
+            auto label = readRecord<EncodedLabel>(
+                    buffer, entry.labelsOffset + i * sizeof(EncodedLabel));
+            if (label.position > entry.nOfInstructions) {
+                throw std::runtime_error("Invalid label position");
+            }
+            labelMapping.emplace(label.label, label.position);
+        }
+        programs.emplace_back(std::move(program), std::move(labelMapping));
+    }
+    return programs;
+}
+
+bool BinaryFormat::isBinary(std::string_view buffer) {
+    return buffer.starts_with(std::string_view(MAGIC, sizeof(MAGIC)));
+}
+
+} // namespace wmm::program
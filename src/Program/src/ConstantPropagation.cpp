@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "ConstantPropagation.h"
+
+namespace wmm::program {
+
+namespace {
+
+using RegisterValues = ConstantPropagation::RegisterValues;
+
+std::optional<int32_t> getValue(const RegisterValues &values, size_t reg) {
+    return (reg < values.size()) ? values[reg] : 0;
+}
+
+void setValue(RegisterValues &values, size_t reg,
+              std::optional<int32_t> value) {
+    if (reg >= values.size()) { values.resize(reg + 1, 0); }
+    values[reg] = value;
+}
+
+// @return true if the join changed the values at the target
+bool join(std::optional<RegisterValues> &target,
+          const RegisterValues &values) {
+    if (!target) {
+        target = values;
+        return true;
+    }
+    bool isChanged = false;
+    size_t size = std::max(target->size(), values.size());
+    for (size_t reg = 0; reg < size; ++reg) {
+        auto current = getValue(*target, reg);
+        if (current && current != getValue(values, reg)) {
+            setValue(*target, reg, std::nullopt);
+            isChanged = true;
+        }
+    }
+    return isChanged;
+}
+
+} // namespace
+
+ConstantPropagation::ConstantPropagation(const Program &program)
+    : m_states(program.size()) {
+    std::vector<size_t> worklist;
+    auto propagate = [&](size_t position, const RegisterValues &values) {
+        if (position < program.size() && join(m_states[position], values)) {
+            worklist.push_back(position);
+        }
+    };
+    propagate(0, {});
+    while (!worklist.empty()) {
+        size_t position = worklist.back();
+        worklist.pop_back();
+        RegisterValues values = *m_states[position];
+        auto instruction = program.getInstruction(position);
+        switch (instruction->action) {
+            case InstructionAction::StoreConstInRegister: {
+                const auto &cmd =
+                        static_cast<const StoreConstInRegister &>(*instruction);
+                setValue(values, cmd.storeRegister, cmd.value);
+                break;
+            }
+            case InstructionAction::StoreExprInRegister: {
+                const auto &cmd =
+                        static_cast<const StoreExprInRegister &>(*instruction);
+                auto lhs = program::getValue(values, cmd.leftRegister);
+                auto rhs = program::getValue(values, cmd.rightRegister);
+                setValue(values, cmd.storeRegister,
+                         (lhs && rhs) ? applyOperation(cmd.operation, *lhs,
+                                                       *rhs)
+                                      : std::nullopt);
+                break;
+            }
+            case InstructionAction::Goto: {
+                const auto &cmd = static_cast<const Goto &>(*instruction);
+                auto condition =
+                        program::getValue(values, cmd.conditionRegister);
+                auto label = program.getLabels().find(cmd.label);
+                if (label != program.getLabels().end() && condition != 0) {
+                    propagate(label->second, values);
+                }
+                if (condition && condition != 0) { continue; }
+                break;
+            }
+            case InstructionAction::Load:
+            case InstructionAction::CompareAndSwap:
+            case InstructionAction::CompareAndSwapLoop:
+                // Every iteration of a loop may load another value
+                for (auto reg: getWrittenRegisters(*instruction)) {
+                    setValue(values, reg, std::nullopt);
+                }
+                break;
+            default:
+                break;
+        }
+        propagate(position + 1, values);
+    }
+}
+
+std::optional<int32_t> ConstantPropagation::getValue(size_t position,
+                                                     size_t reg) const {
+    if (!isReachable(position)) { return {}; }
+    return program::getValue(*m_states[position], reg);
+}
+
+} // namespace wmm::program
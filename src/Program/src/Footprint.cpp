@@ -0,0 +1,131 @@
+#include <algorithm>
+
+#include "ConstantPropagation.h"
+#include "Footprint.h"
+
+namespace wmm::program {
+
+namespace {
+
+std::optional<size_t> getAddressRegister(const Instruction &instruction) {
+    switch (instruction.action) {
+        case InstructionAction::Load:
+            return static_cast<const Load &>(instruction).addressRegister;
+        case InstructionAction::Store:
+            return static_cast<const Store &>(instruction).addressRegister;
+        case InstructionAction::CompareAndSwap:
+            return static_cast<const CompareAndSwap &>(instruction)
+                    .addressRegister;
+        case InstructionAction::FetchAndIncrement:
+            return static_cast<const FetchAndIncrement &>(instruction)
+                    .addressRegister;
+        case InstructionAction::CompareAndSwapLoop:
+            return static_cast<const CompareAndSwapLoop &>(instruction)
+                    .getCompareAndSwap()
+                    .addressRegister;
+        default:
+            return {};
+    }
+}
+
+} // namespace
+
+Footprint::Footprint(const Program &program)
+    : m_addresses(program.size()) {
+    ConstantPropagation constants(program);
+    for (size_t position = 0; position < program.size(); ++position) {
+        auto instruction = program.getInstruction(position);
+        auto addressRegister = getAddressRegister(*instruction);
+        if (!constants.isReachable(position) || !addressRegister) {
+            continue;
+        }
+        auto value = constants.getValue(position, *addressRegister);
+        if (!value) {
+            m_isComplete = false;
+            continue;
+        }
+        // Converted to a location as the thread does it
+        auto address = static_cast<size_t>(*value);
+        m_addresses[position] = address;
+        if (instruction->action != InstructionAction::Store) {
+            m_reads.insert(address);
+        }
+        if (instruction->action != InstructionAction::Load) {
+            m_writes.insert(address);
+        }
+    }
+}
+
+std::optional<size_t> Footprint::getAddress(size_t instruction) const {
+    if (instruction >= m_addresses.size()) { return {}; }
+    return m_addresses[instruction];
+}
+
+std::vector<Footprint> analyzeFootprints(const std::vector<Program> &programs) {
+    std::vector<Footprint> footprints;
+    footprints.reserve(programs.size());
+    for (const auto &program: programs) { footprints.emplace_back(program); }
+    return footprints;
+}
+
+std::optional<size_t>
+getRequiredStorageSize(const std::vector<Footprint> &footprints) {
+    size_t size = 0;
+    for (const auto &footprint: footprints) {
+        if (!footprint.isComplete()) { return {}; }
+        for (const auto *addresses:
+             {&footprint.getReads(), &footprint.getWrites()}) {
+            if (!addresses->empty()) {
+                size = std::max(size, *addresses->rbegin() + 1);
+            }
+        }
+    }
+    return size;
+}
+
+std::vector<std::vector<bool>>
+findCommutingAccesses(const std::vector<Program> &programs,
+                      const std::vector<Footprint> &footprints) {
+    std::vector<std::vector<bool>> commuting;
+    for (const auto &program: programs) {
+        commuting.emplace_back(program.size(), false);
+    }
+    bool isComplete = std::all_of(
+            footprints.begin(), footprints.end(),
+            [](const auto &footprint) { return footprint.isComplete(); });
+    if (!isComplete) { return commuting; }
+
+    auto isAccessedByOthers = [&](size_t threadId, size_t address,
+                                  bool includeReads) {
+        for (size_t other = 0; other < footprints.size(); ++other) {
+            if (other == threadId) { continue; }
+            if (footprints[other].getWrites().contains(address) ||
+                (includeReads && footprints[other].getReads().contains(address))) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (size_t threadId = 0; threadId < programs.size(); ++threadId) {
+        const auto &program = programs[threadId];
+        for (size_t position = 0; position < program.size(); ++position) {
+            auto address = footprints[threadId].getAddress(position);
+            if (!address) { continue; }
+            auto instruction = program.getInstruction(position);
+            if (instruction->action == InstructionAction::Load) {
+                const auto &cmd = static_cast<const Load &>(*instruction);
+                commuting[threadId][position] =
+                        cmd.mode != MemoryAccessMode::SequentialConsistency &&
+                        !isAccessedByOthers(threadId, *address, false);
+            } else if (instruction->action == InstructionAction::Store) {
+                const auto &cmd = static_cast<const Store &>(*instruction);
+                commuting[threadId][position] =
+                        cmd.mode != MemoryAccessMode::SequentialConsistency &&
+                        !isAccessedByOthers(threadId, *address, true);
+            }
+        }
+    }
+    return commuting;
+}
+
+} // namespace wmm::program
@@ -0,0 +1,135 @@
+#include <stdexcept>
+
+#include "Generator.h"
+
+namespace wmm::program {
+
+// Values the value registers start with, stores of non-zero values are
+// distinguishable from the initial memory
+static constexpr int32_t MAX_INITIAL_VALUE = 3;
+
+Generator::Generator(Config config, unsigned long seed)
+    : m_config(std::move(config)), m_randomGenerator(seed),
+      m_modeDistribution(m_config.modeWeights.begin(),
+                         m_config.modeWeights.end()),
+      m_instructionDistribution(m_config.instructionWeights.begin(),
+                                m_config.instructionWeights.end()) {
+    if (m_config.nOfThreads == 0 || m_config.nOfAddresses == 0) {
+        throw std::invalid_argument(
+                "Generated programs need at least one thread and address");
+    }
+    // The constant 1, the addresses, the loop counter and a value register
+    if (m_config.nOfRegisters < m_config.nOfAddresses + 3) {
+        throw std::invalid_argument("Not enough registers for the addresses");
+    }
+    if (m_config.maxLoopLength == 0 || m_config.maxLoopIterations == 0) {
+        throw std::invalid_argument("Loops need a positive length and bound");
+    }
+}
+
+std::vector<Program> Generator::generate() {
+    std::vector<Program> programs;
+    programs.reserve(m_config.nOfThreads);
+    for (size_t i = 0; i < m_config.nOfThreads; ++i) {
+        programs.push_back(generateThread());
+    }
+    return programs;
+}
+
+Program Generator::generateThread() {
+    std::vector<InstructionPtr> instructions;
+    std::unordered_map<Label, size_t> labels;
+    instructions.push_back(std::make_shared<StoreConstInRegister>(0, 1));
+    for (size_t address = 0; address < m_config.nOfAddresses; ++address) {
+        instructions.push_back(std::make_shared<StoreConstInRegister>(
+                address + 1, static_cast<int32_t>(address)));
+    }
+    std::uniform_int_distribution<int32_t> initialValue(1, MAX_INITIAL_VALUE);
+    for (size_t reg = counterRegister() + 1; reg < m_config.nOfRegisters;
+         ++reg) {
+        instructions.push_back(std::make_shared<StoreConstInRegister>(
+                reg, initialValue(m_randomGenerator)));
+    }
+
+    std::bernoulli_distribution startsLoop(m_config.loopDensity);
+    size_t length = 0;
+    Label nextLabel = 1;
+    while (length < m_config.programLength) {
+        if (!startsLoop(m_randomGenerator)) {
+            instructions.push_back(generateInstruction());
+            ++length;
+            continue;
+        }
+        size_t maxLoopLength = std::min(m_config.maxLoopLength,
+                                        m_config.programLength - length);
+        size_t loopLength = std::uniform_int_distribution<size_t>(
+                1, maxLoopLength)(m_randomGenerator);
+        auto iterations = std::uniform_int_distribution<int32_t>(
+                1, static_cast<int32_t>(m_config.maxLoopIterations))(
+                m_randomGenerator);
+        instructions.push_back(std::make_shared<StoreConstInRegister>(
+                counterRegister(), iterations));
+        labels[nextLabel] = instructions.size();
+        for (size_t i = 0; i < loopLength; ++i) {
+            instructions.push_back(generateInstruction());
+        }
+        // The counter is read before it is written, so this is never taken
+        // for a spin loop
+        instructions.push_back(std::make_shared<StoreExprInRegister>(
+                counterRegister(), counterRegister(),
+                BinaryOperation::Subtraction, 0));
+        instructions.push_back(
+                std::make_shared<Goto>(counterRegister(), nextLabel++));
+        length += loopLength;
+    }
+    return {std::move(instructions), std::move(labels)};
+}
+
+InstructionPtr Generator::generateInstruction() {
+    switch (m_instructionDistribution(m_randomGenerator)) {
+        case 0:
+            return std::make_shared<Load>(generateMode(), addressRegister(),
+                                          valueRegister());
+        case 1:
+            return std::make_shared<Store>(generateMode(), addressRegister(),
+                                           valueRegister());
+        case 2:
+            return std::make_shared<CompareAndSwap>(
+                    generateMode(), addressRegister(), valueRegister(),
+                    valueRegister());
+        case 3:
+            return std::make_shared<FetchAndIncrement>(
+                    generateMode(), addressRegister(), valueRegister());
+        case 4:
+            return std::make_shared<Fence>(generateMode());
+        default: {
+            // No division, so there is no division by zero
+            auto operation = std::bernoulli_distribution()(m_randomGenerator)
+                                     ? BinaryOperation::Addition
+                                     : BinaryOperation::Subtraction;
+            return std::make_shared<StoreExprInRegister>(
+                    valueRegister(), valueRegister(), operation,
+                    valueRegister());
+        }
+    }
+}
+
+MemoryAccessMode Generator::generateMode() {
+    return static_cast<MemoryAccessMode>(
+            m_modeDistribution(m_randomGenerator));
+}
+
+size_t Generator::addressRegister() {
+    return std::uniform_int_distribution<size_t>(
+            1, m_config.nOfAddresses)(m_randomGenerator);
+}
+
+size_t Generator::valueRegister() {
+    return std::uniform_int_distribution<size_t>(
+            counterRegister() + 1,
+            m_config.nOfRegisters - 1)(m_randomGenerator);
+}
+
+size_t Generator::counterRegister() const { return m_config.nOfAddresses + 1; }
+
+} // namespace wmm::program
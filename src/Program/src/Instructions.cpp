@@ -1,4 +1,5 @@
 #include <algorithm>
+#include <limits>
 #include <sstream>
 
 #include "Instructions.h"
@@ -14,6 +15,74 @@ std::string toString(MemoryAccessMode mode) {
             ->first;
 }
 
+bool isThreadLocal(InstructionAction action) {
+    switch (action) {
+        case InstructionAction::StoreConstInRegister:
+        case InstructionAction::StoreExprInRegister:
+        case InstructionAction::Goto:
+            return true;
+        case InstructionAction::Load:
+        case InstructionAction::Store:
+        case InstructionAction::CompareAndSwap:
+        case InstructionAction::FetchAndIncrement:
+        case InstructionAction::Fence:
+        case InstructionAction::CompareAndSwapLoop:
+            return false;
+    }
+    return false;
+}
+
+std::optional<int32_t>
+applyOperation(BinaryOperation operation, int32_t lhs, int32_t rhs) {
+    auto left = static_cast<uint32_t>(lhs);
+    auto right = static_cast<uint32_t>(rhs);
+    switch (operation) {
+        case BinaryOperation::Addition:
+            return static_cast<int32_t>(left + right);
+        case BinaryOperation::Subtraction:
+            return static_cast<int32_t>(left - right);
+        case BinaryOperation::Multiplication:
+            return static_cast<int32_t>(left * right);
+        case BinaryOperation::Division:
+            if (rhs == 0 ||
+                (lhs == std::numeric_limits<int32_t>::min() && rhs == -1)) {
+                return {};
+            }
+            return lhs / rhs;
+    }
+    return {};
+}
+
+std::vector<size_t> getWrittenRegisters(const Instruction &instruction) {
+    switch (instruction.action) {
+        case InstructionAction::StoreConstInRegister:
+            return {static_cast<const StoreConstInRegister &>(instruction)
+                            .storeRegister};
+        case InstructionAction::StoreExprInRegister:
+            return {static_cast<const StoreExprInRegister &>(instruction)
+                            .storeRegister};
+        case InstructionAction::Load:
+            return {static_cast<const Load &>(instruction).resultRegister};
+        case InstructionAction::CompareAndSwap: {
+            const auto &cmd = static_cast<const CompareAndSwap &>(instruction);
+            if (cmd.resultRegister) { return {*cmd.resultRegister}; }
+            return {};
+        }
+        case InstructionAction::CompareAndSwapLoop: {
+            std::vector<size_t> registers;
+            for (const auto &bodyInstruction:
+                 static_cast<const CompareAndSwapLoop &>(instruction).body) {
+                auto written = getWrittenRegisters(*bodyInstruction);
+                registers.insert(registers.end(), written.begin(),
+                                 written.end());
+            }
+            return registers;
+        }
+        default:
+            return {};
+    }
+}
+
 std::string StoreConstInRegister::str() const {
     std::stringstream output;
     output << storeRegister << " = " << value;
@@ -69,13 +138,24 @@ std::string CompareAndSwap::str() const {
     std::string modeString = program::toString(mode);
     output << "cas " + modeString + " #" << addressRegister << " "
            << expectedValueRegister << " " << newValueRegister;
+    if (resultRegister) { output << " " << *resultRegister; }
+    return output.str();
+}
+
+std::string CompareAndSwapLoop::str() const {
+    std::stringstream output;
+    output << "casloop {";
+    for (const auto &instruction: body) {
+        output << ' ' << instruction->str() << ';';
+    }
+    output << " if " << conditionRegister << " repeat }";
     return output.str();
 }
 
 std::string FetchAndIncrement::str() const {
     std::stringstream output;
     std::string modeString = program::toString(mode);
-    output << "fei " + modeString + " #" << addressRegister << " "
+    output << "fai " + modeString + " #" << addressRegister << " "
            << incrementRegister;
     return output.str();
 }
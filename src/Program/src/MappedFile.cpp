@@ -0,0 +1,37 @@
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+namespace wmm::program {
+
+MappedFile::MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) { throw std::runtime_error("Couldn't open file " + path); }
+    struct stat status {};
+    if (fstat(fd, &status) != 0) {
+        close(fd);
+        throw std::runtime_error("Couldn't read file " + path);
+    }
+    m_size = status.st_size;
+    // An empty file can't be mapped, it is just an empty view
+    if (m_size > 0) {
+        void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Couldn't map file " + path);
+        }
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char *>(data);
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data) { munmap(const_cast<char *>(m_data), m_size); }
+}
+
+} // namespace wmm::program
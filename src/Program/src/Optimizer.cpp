@@ -0,0 +1,399 @@
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+
+#include "ConstantPropagation.h"
+#include "Optimizer.h"
+
+namespace wmm::program {
+
+namespace {
+
+// Removed instructions are null, label positions refer to the old program
+Program rebuild(const std::vector<InstructionPtr> &instructions,
+                std::unordered_map<Label, size_t> labels) {
+    std::vector<size_t> newPositions(instructions.size() + 1);
+    std::vector<InstructionPtr> kept;
+    for (size_t position = 0; position < instructions.size(); ++position) {
+        newPositions[position] = kept.size();
+        if (instructions[position]) { kept.push_back(instructions[position]); }
+    }
+    newPositions[instructions.size()] = kept.size();
+    for (auto &[label, position]: labels) {
+        position = newPositions[std::min(position, instructions.size())];
+    }
+    return {std::move(kept), std::move(labels)};
+}
+
+std::optional<size_t> findTarget(const Program &program, Label label) {
+    auto it = program.getLabels().find(label);
+    if (it == program.getLabels().end()) { return {}; }
+    return it->second;
+}
+
+/**
+ * Folding, removal of unreachable code and of jumps that are never taken,
+ * jump threading
+ */
+Program simplify(const Program &program, Optimizer::Stats &stats) {
+    ConstantPropagation constants(program);
+    std::vector<InstructionPtr> instructions(program.size());
+    auto labels = program.getLabels();
+    Label nextLabel = 0;
+    for (auto [label, position]: labels) {
+        nextLabel = std::max(nextLabel, label + 1);
+    }
+    auto labelAt = [&](size_t position) {
+        for (auto [label, labelPosition]: labels) {
+            if (labelPosition == position) { return label; }
+        }
+        labels.emplace(nextLabel, position);
+        return nextLabel++;
+    };
+    // Where a jump to the position ends up, following jumps with a known
+    // condition
+    auto followJumps = [&](size_t position) {
+        std::unordered_set<size_t> visited;
+        while (position < program.size() && visited.insert(position).second) {
+            auto instruction = program.getInstruction(position);
+            if (instruction->action != InstructionAction::Goto) { break; }
+            const auto &cmd = static_cast<const Goto &>(*instruction);
+            auto condition = constants.getValue(position, cmd.conditionRegister);
+            if (!condition) { break; }
+            if (*condition == 0) {
+                ++position;
+                continue;
+            }
+            auto target = findTarget(program, cmd.label);
+            if (!target) { break; }
+            position = *target;
+        }
+        return position;
+    };
+
+    for (size_t position = 0; position < program.size(); ++position) {
+        if (!constants.isReachable(position)) {
+            ++stats.removedUnreachable;
+            continue;
+        }
+        auto instruction = program.getInstruction(position);
+        instructions[position] = instruction;
+        if (instruction->action == InstructionAction::StoreExprInRegister) {
+            const auto &cmd =
+                    static_cast<const StoreExprInRegister &>(*instruction);
+            auto lhs = constants.getValue(position, cmd.leftRegister);
+            auto rhs = constants.getValue(position, cmd.rightRegister);
+            if (!lhs || !rhs) { continue; }
+            auto value = applyOperation(cmd.operation, *lhs, *rhs);
+            if (!value) { continue; }
+            instructions[position] = std::make_shared<StoreConstInRegister>(
+                    cmd.storeRegister, *value);
+            ++stats.foldedExpressions;
+        } else if (instruction->action == InstructionAction::Goto) {
+            const auto &cmd = static_cast<const Goto &>(*instruction);
+            if (constants.getValue(position, cmd.conditionRegister) == 0) {
+                instructions[position] = nullptr;
+                ++stats.removedJumps;
+                continue;
+            }
+            auto target = findTarget(program, cmd.label);
+            if (!target) { continue; }
+            size_t finalTarget = followJumps(*target);
+            if (finalTarget == *target) { continue; }
+            instructions[position] = std::make_shared<Goto>(
+                    cmd.conditionRegister, labelAt(finalTarget));
+            ++stats.threadedJumps;
+        }
+    }
+    return rebuild(instructions, std::move(labels));
+}
+
+struct RegisterAccess {
+    // Registers read before the instruction writes them
+    std::vector<size_t> reads;
+    std::vector<size_t> writes;
+};
+
+RegisterAccess getRegisterAccess(const Instruction &instruction) {
+    switch (instruction.action) {
+        case InstructionAction::StoreConstInRegister: {
+            const auto &cmd =
+                    static_cast<const StoreConstInRegister &>(instruction);
+            return {{}, {cmd.storeRegister}};
+        }
+        case InstructionAction::StoreExprInRegister: {
+            const auto &cmd =
+                    static_cast<const StoreExprInRegister &>(instruction);
+            return {{cmd.leftRegister, cmd.rightRegister},
+                    {cmd.storeRegister}};
+        }
+        case InstructionAction::Goto:
+            return {{static_cast<const Goto &>(instruction).conditionRegister},
+                    {}};
+        case InstructionAction::Load: {
+            const auto &cmd = static_cast<const Load &>(instruction);
+            return {{cmd.addressRegister}, {cmd.resultRegister}};
+        }
+        case InstructionAction::Store: {
+            const auto &cmd = static_cast<const Store &>(instruction);
+            return {{cmd.addressRegister, cmd.valueRegister}, {}};
+        }
+        case InstructionAction::CompareAndSwap: {
+            const auto &cmd = static_cast<const CompareAndSwap &>(instruction);
+            return {{cmd.addressRegister, cmd.expectedValueRegister,
+                     cmd.newValueRegister},
+                    getWrittenRegisters(cmd)};
+        }
+        case InstructionAction::FetchAndIncrement: {
+            const auto &cmd =
+                    static_cast<const FetchAndIncrement &>(instruction);
+            return {{cmd.addressRegister, cmd.incrementRegister}, {}};
+        }
+        case InstructionAction::Fence:
+            return {};
+        case InstructionAction::CompareAndSwapLoop: {
+            // Every iteration runs the whole body
+            RegisterAccess access;
+            std::set<size_t> written;
+            for (const auto &bodyInstruction:
+                 static_cast<const CompareAndSwapLoop &>(instruction).body) {
+                auto bodyAccess = getRegisterAccess(*bodyInstruction);
+                for (auto reg: bodyAccess.reads) {
+                    if (!written.contains(reg)) { access.reads.push_back(reg); }
+                }
+                written.insert(bodyAccess.writes.begin(),
+                               bodyAccess.writes.end());
+            }
+            access.writes.assign(written.begin(), written.end());
+            return access;
+        }
+    }
+    return {};
+}
+
+// Registers overwritten before being read on every path, nullopt stands for
+// all registers
+using DeadRegisters = std::optional<std::set<size_t>>;
+
+void intersect(DeadRegisters &target, const DeadRegisters &other) {
+    if (!other) { return; }
+    if (!target) {
+        target = other;
+        return;
+    }
+    std::erase_if(*target, [&](size_t reg) { return !other->contains(reg); });
+}
+
+/**
+ * Backward liveness, all registers are live at the end of the program
+ */
+Program removeDeadStores(const Program &program, Optimizer::Stats &stats) {
+    size_t size = program.size();
+    std::vector<RegisterAccess> accesses;
+    std::vector<std::vector<size_t>> successors(size);
+    std::vector<std::vector<size_t>> predecessors(size + 1);
+    for (size_t position = 0; position < size; ++position) {
+        auto instruction = program.getInstruction(position);
+        accesses.push_back(getRegisterAccess(*instruction));
+        successors[position].push_back(position + 1);
+        if (instruction->action == InstructionAction::Goto) {
+            // A jump to a missing label ends the execution
+            auto target = findTarget(program,
+                                     static_cast<const Goto &>(*instruction)
+                                             .label);
+            successors[position].push_back(target.value_or(size));
+        }
+        for (auto successor: successors[position]) {
+            predecessors[std::min(successor, size)].push_back(position);
+        }
+    }
+
+    // Dead registers before every instruction, the end has none
+    std::vector<DeadRegisters> deadBefore(size + 1);
+    deadBefore[size] = std::set<size_t>{};
+    auto deadAfter = [&](size_t position) {
+        DeadRegisters dead;
+        for (auto successor: successors[position]) {
+            intersect(dead, deadBefore[std::min(successor, size)]);
+        }
+        return dead;
+    };
+    std::vector<size_t> worklist(predecessors[size]);
+    std::vector<bool> isQueued(size);
+    for (auto position: worklist) { isQueued[position] = true; }
+    while (!worklist.empty()) {
+        size_t position = worklist.back();
+        worklist.pop_back();
+        isQueued[position] = false;
+        auto dead = deadAfter(position);
+        const auto &access = accesses[position];
+        if (dead) {
+            dead->insert(access.writes.begin(), access.writes.end());
+            for (auto reg: access.reads) { dead->erase(reg); }
+        }
+        // Nothing was propagated here yet if the dead set is still all
+        // registers
+        if (dead == deadBefore[position] && deadBefore[position]) { continue; }
+        deadBefore[position] = std::move(dead);
+        for (auto predecessor: predecessors[position]) {
+            if (!isQueued[predecessor]) {
+                isQueued[predecessor] = true;
+                worklist.push_back(predecessor);
+            }
+        }
+    }
+
+    std::vector<InstructionPtr> instructions(size);
+    for (size_t position = 0; position < size; ++position) {
+        auto instruction = program.getInstruction(position);
+        instructions[position] = instruction;
+        // A division is kept as it may fail the execution
+        bool isRegisterOnly =
+                instruction->action ==
+                        InstructionAction::StoreConstInRegister ||
+                (instruction->action ==
+                         InstructionAction::StoreExprInRegister &&
+                 static_cast<const StoreExprInRegister &>(*instruction)
+                                 .operation != BinaryOperation::Division);
+        auto dead = deadAfter(position);
+        if (isRegisterOnly && dead &&
+            dead->contains(accesses[position].writes[0])) {
+            instructions[position] = nullptr;
+            ++stats.removedDeadStores;
+        }
+    }
+    return rebuild(instructions, program.getLabels());
+}
+
+/**
+ * The loop `load #a old; <register instructions>; cas #a old new ok;
+ * failed = one - ok; if failed goto load` from the load at the head to the
+ * jump at the back edge, where one is 1. Nothing jumps into the loop, and the
+ * instructions after the load don't change the address, and the ones before
+ * the cas don't change the loaded value.
+ */
+std::shared_ptr<CompareAndSwapLoop>
+matchCompareAndSwapLoop(const Program &program,
+                        const ConstantPropagation &constants, size_t head,
+                        size_t backEdge) {
+    if (backEdge < head + 3) { return nullptr; }
+    for (auto [label, position]: program.getLabels()) {
+        if (position > head && position <= backEdge) { return nullptr; }
+    }
+    auto load = program.getInstruction(head);
+    auto cas = program.getInstruction(backEdge - 2);
+    auto condition = program.getInstruction(backEdge - 1);
+    if (load->action != InstructionAction::Load ||
+        cas->action != InstructionAction::CompareAndSwap ||
+        condition->action != InstructionAction::StoreExprInRegister) {
+        return nullptr;
+    }
+    const auto &loadCmd = static_cast<const Load &>(*load);
+    const auto &casCmd = static_cast<const CompareAndSwap &>(*cas);
+    const auto &conditionCmd =
+            static_cast<const StoreExprInRegister &>(*condition);
+    size_t address = loadCmd.addressRegister;
+    size_t loaded = loadCmd.resultRegister;
+    const auto &jump =
+            static_cast<const Goto &>(*program.getInstruction(backEdge));
+    if (loaded == address || casCmd.addressRegister != address ||
+        casCmd.expectedValueRegister != loaded || !casCmd.resultRegister ||
+        *casCmd.resultRegister == address ||
+        jump.conditionRegister != conditionCmd.storeRegister ||
+        conditionCmd.storeRegister == address) {
+        return nullptr;
+    }
+    // The condition must be nonzero exactly when the cas failed
+    size_t result = *casCmd.resultRegister;
+    size_t other = (conditionCmd.rightRegister == result)
+                           ? conditionCmd.leftRegister
+                           : conditionCmd.rightRegister;
+    if (conditionCmd.operation != BinaryOperation::Subtraction ||
+        (conditionCmd.leftRegister != result &&
+         conditionCmd.rightRegister != result) ||
+        other == result || constants.getValue(backEdge - 1, other) != 1) {
+        return nullptr;
+    }
+    std::vector<InstructionPtr> body = {load};
+    for (size_t position = head + 1; position < backEdge - 2; ++position) {
+        auto instruction = program.getInstruction(position);
+        if (instruction->action != InstructionAction::StoreConstInRegister &&
+            instruction->action != InstructionAction::StoreExprInRegister) {
+            return nullptr;
+        }
+        auto written = getWrittenRegisters(*instruction)[0];
+        if (written == address || written == loaded) { return nullptr; }
+        body.push_back(instruction);
+    }
+    body.push_back(cas);
+    body.push_back(condition);
+    return std::make_shared<CompareAndSwapLoop>(std::move(body),
+                                                jump.conditionRegister);
+}
+
+Program fuseCompareAndSwapLoops(const Program &program,
+                                Optimizer::Stats &stats) {
+    ConstantPropagation constants(program);
+    std::vector<InstructionPtr> instructions(program.size());
+    for (size_t position = 0; position < program.size(); ++position) {
+        instructions[position] = program.getInstruction(position);
+    }
+    for (size_t position = 0; position < program.size(); ++position) {
+        auto instruction = program.getInstruction(position);
+        if (instruction->action != InstructionAction::Goto) { continue; }
+        auto head = findTarget(program,
+                               static_cast<const Goto &>(*instruction).label);
+        if (!head || *head >= position || !instructions[*head]) { continue; }
+        auto loop = matchCompareAndSwapLoop(program, constants, *head,
+                                            position);
+        if (!loop) { continue; }
+        instructions[*head] = std::move(loop);
+        for (size_t i = *head + 1; i <= position; ++i) {
+            instructions[i] = nullptr;
+        }
+        ++stats.fusedLoops;
+    }
+    return rebuild(instructions, program.getLabels());
+}
+
+size_t countChanges(const Optimizer::Stats &stats) {
+    return stats.foldedExpressions + stats.removedJumps +
+           stats.threadedJumps + stats.removedUnreachable +
+           stats.removedDeadStores + stats.fusedLoops;
+}
+
+} // namespace
+
+Program Optimizer::optimize(const Program &program, Stats *stats) {
+    Stats localStats;
+    Program result = program;
+    // Every pass may enable the others
+    constexpr size_t MAX_ROUNDS = 8;
+    for (size_t round = 0; round < MAX_ROUNDS; ++round) {
+        size_t changes = countChanges(localStats);
+        result = removeDeadStores(simplify(result, localStats), localStats);
+        result = fuseCompareAndSwapLoops(result, localStats);
+        if (countChanges(localStats) == changes) { break; }
+    }
+    if (stats) {
+        stats->foldedExpressions += localStats.foldedExpressions;
+        stats->removedJumps += localStats.removedJumps;
+        stats->threadedJumps += localStats.threadedJumps;
+        stats->removedUnreachable += localStats.removedUnreachable;
+        stats->removedDeadStores += localStats.removedDeadStores;
+        stats->fusedLoops += localStats.fusedLoops;
+    }
+    return result;
+}
+
+std::vector<Program> Optimizer::optimize(const std::vector<Program> &programs,
+                                         Stats *stats) {
+    std::vector<Program> result;
+    result.reserve(programs.size());
+    for (const auto &program: programs) {
+        result.push_back(optimize(program, stats));
+    }
+    return result;
+}
+
+} // namespace wmm::program
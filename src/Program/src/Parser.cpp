@@ -2,61 +2,100 @@
 // Created by veronika on 20.10.23.
 //
 
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+
+#include "BinaryFormat.h"
+#include "MappedFile.h"
 #include "Parser.h"
 
 namespace wmm::program {
 
-static std::vector<std::string> parseTokens(std::istream &stream,
-                                            ssize_t expectedMax = SIZE_MAX) {
-    std::string token;
-    std::vector<std::string> answer;
-    while (answer.size() < expectedMax && stream >> token) {
-        answer.push_back(token);
+static constexpr size_t MAX_TOKENS = 6;
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * Splits the line into at most MAX_TOKENS views into it
+ */
+static std::span<const std::string_view>
+parseTokens(std::string_view line,
+            std::array<std::string_view, MAX_TOKENS> &tokens) {
+    size_t size = 0;
+    size_t position = 0;
+    while (true) {
+        while (position < line.size() && isSpace(line[position])) {
+            ++position;
+        }
+        if (position == line.size()) { break; }
+        if (size == MAX_TOKENS) throw std::runtime_error("Too many tokens");
+        size_t begin = position;
+        while (position < line.size() && !isSpace(line[position])) {
+            ++position;
+        }
+        tokens[size++] = line.substr(begin, position - begin);
     }
-    if (stream >> token) throw std::runtime_error("Too many tokens");
-    return answer;
+    return {tokens.data(), size};
 }
 
-static size_t parseRegister(const std::string &string) {
-    size_t res = -1;
-    if (std::stringstream(string) >> res) { return res; }
+// The whole token must be the number, so "12abc", "-1" as a register or a
+// constant out of the int32_t range are rejected rather than cut short
+template<typename T>
+static std::optional<T> parseNumber(std::string_view string) {
+    T result{};
+    auto [end, error] =
+            std::from_chars(string.data(), string.data() + string.size(),
+                            result);
+    if (string.empty() || error != std::errc() ||
+        end != string.data() + string.size()) {
+        return {};
+    }
+    return result;
+}
+
+static size_t parseRegister(std::string_view string) {
+    if (auto res = parseNumber<size_t>(string)) { return *res; }
     throw std::runtime_error("Couldn't parse register");
 }
 
-static size_t parseRegisterWithMemAddress(const std::string &string) {
-    size_t res = -1;
-    if (string.empty() || string.front() != '#' ||
-        !(std::stringstream(string.substr(1, string.size() - 1)) >> res)) {
+static size_t parseRegisterWithMemAddress(std::string_view string) {
+    if (string.empty() || string.front() != '#') {
         throw std::runtime_error("Couldn't parse register");
     }
-    return res;
+    return parseRegister(string.substr(1));
 }
 
-static int32_t parseConstant(const std::string &string) {
-    int32_t res = INT32_MIN;
-    if (std::stringstream(string) >> res) { return res; }
+static int32_t parseConstant(std::string_view string) {
+    if (!string.empty() && string.front() == '+') {
+        string.remove_prefix(1);
+    }
+    if (auto res = parseNumber<int32_t>(string)) { return *res; }
     throw std::runtime_error("Couldn't parse constant value");
 }
 
-static MemoryAccessMode parseMemoryAccessMode(const std::string &string) {
-    if (STRING_TO_MODE.count(string) == 0) {
+static MemoryAccessMode parseMemoryAccessMode(std::string_view string) {
+    auto it = STRING_TO_MODE.find(string);
+    if (it == STRING_TO_MODE.end()) {
         throw std::runtime_error("Couldn't parse memory access mode");
     }
-    return STRING_TO_MODE.at(string);
+    return it->second;
 }
 
-static Label parseLabel(const std::string &string) {
-    Label label = 0;
-    if (std::stringstream(string) >> label) { return label; }
+static Label parseLabel(std::string_view string) {
+    if (auto res = parseNumber<Label>(string)) { return *res; }
     throw std::runtime_error("Couldn't parse label");
 }
 
-static std::optional<Label> tryParseLabel(const std::string &string) {
+static std::optional<Label> tryParseLabel(std::string_view string) {
     if (string.size() < 2 || string.back() != ':') { return {}; }
     return parseLabel(string.substr(0, string.size() - 1));
 }
 
-static BinaryOperation parseBinaryOperation(const std::string &string) {
+static BinaryOperation parseBinaryOperation(std::string_view string) {
     if (string.size() != 1 || CHAR_TO_BIN_OPERATION.count(string[0]) == 0) {
         throw std::runtime_error("Couldn't parse binary operation");
     }
@@ -64,7 +103,7 @@ static BinaryOperation parseBinaryOperation(const std::string &string) {
 }
 
 InstructionPtr
-Parser::parseStoreInRegister(const std::vector<std::string> &tokens) {
+Parser::parseStoreInRegister(std::span<const std::string_view> tokens) {
     if ((tokens.size() != 3 && tokens.size() != 5) || tokens[1] != "=") {
         throw std::runtime_error("Failed to parse");
     }
@@ -90,21 +129,22 @@ Parser::parseStoreInRegister(const std::vector<std::string> &tokens) {
 }
 
 std::tuple<std::optional<Label>, InstructionPtr>
-Parser::parseLine(const std::string &line) {
+Parser::parseLine(std::string_view line) {
     if (line.empty() || line.front() == '/') return {};
-    std::stringstream ss(line);
-    std::vector<std::string> tokens = parseTokens(ss, 6);
+    std::array<std::string_view, MAX_TOKENS> buffer;
+    auto tokens = parseTokens(line, buffer);
     if (tokens.empty()) return {};
     auto label = tryParseLabel(tokens[0]);
     InstructionPtr instruction;
 
     if (label) {
         if (tokens.size() == 1) return {label, nullptr};
-        tokens = std::vector<std::string>(tokens.begin() + 1, tokens.end());
+        tokens = tokens.subspan(1);
     }
 
-    Command parsedCommand = (STRING_TO_COMMAND.count(tokens[0]) > 0)
-                                    ? STRING_TO_COMMAND.at(tokens[0])
+    auto command = STRING_TO_COMMAND.find(tokens[0]);
+    Command parsedCommand = (command != STRING_TO_COMMAND.end())
+                                    ? command->second
                                     : Command::Other;
     switch (parsedCommand) {
         case Command::Other:
@@ -142,15 +182,20 @@ Parser::parseLine(const std::string &line) {
             break;
         }
         case Command::CompareAndSwap: {
-            if (tokens.size() != 5) {
+            if (tokens.size() != 5 && tokens.size() != 6) {
                 throw std::runtime_error("Couldn't parse cas");
             }
             MemoryAccessMode mode = parseMemoryAccessMode(tokens[1]);
             size_t addressRegister = parseRegisterWithMemAddress(tokens[2]);
             size_t expectedValRegister = parseRegister(tokens[3]);
             size_t newValRegister = parseRegister(tokens[4]);
+            std::optional<size_t> resultRegister;
+            if (tokens.size() == 6) {
+                resultRegister = parseRegister(tokens[5]);
+            }
             instruction = std::make_shared<CompareAndSwap>(
-                    mode, addressRegister, expectedValRegister, newValRegister);
+                    mode, addressRegister, expectedValRegister, newValRegister,
+                    resultRegister);
             break;
         }
         case Command::FetchAndIncrement: {
@@ -176,14 +221,22 @@ Parser::parseLine(const std::string &line) {
     return {label, instruction};
 }
 
-std::vector<Program> Parser::parseFromStream(std::istream &stream) {
-    std::string line;
+std::vector<Program> Parser::parseFromBuffer(std::string_view input) {
     size_t linesRead = 0;
     std::vector<InstructionPtr> program;
     std::unordered_map<Label, size_t> labelMapping;
     std::vector<Program> threadPrograms;
-    while (std::getline(stream, line)) {
+    size_t position = 0;
+    while (position < input.size()) {
+        const char *lineEnd = static_cast<const char *>(
+                std::memchr(input.data() + position, '\n',
+                            input.size() - position));
+        size_t length = lineEnd ? lineEnd - (input.data() + position)
+                                : input.size() - position;
+        std::string_view line = input.substr(position, length);
+        position += length + 1;
         ++linesRead;
+        if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
         if (line == THREAD_SEPARATOR) {
             if (!program.empty()) {
                 threadPrograms.emplace_back(std::move(program),
@@ -203,18 +256,50 @@ std::vector<Program> Parser::parseFromStream(std::istream &stream) {
                 }
                 labelMapping[label.value()] = program.size();
             }
-            if (instruction) { program.push_back(instruction); }
+            if (instruction) { program.push_back(std::move(instruction)); }
         } catch (const std::exception &e) {
             throw ParsingError(linesRead, e.what());
         }
     }
     threadPrograms.emplace_back(std::move(program), std::move(labelMapping));
-    return std::move(threadPrograms);
+    return threadPrograms;
+}
+
+std::vector<Program> Parser::parseFromStream(std::istream &stream) {
+    std::string input(std::istreambuf_iterator<char>(stream), {});
+    return parseFromBuffer(input);
 }
 
 std::vector<Program> Parser::parseFromString(const std::string &input) {
-    std::stringstream stream(input);
-    return parseFromStream(stream);
+    return parseFromBuffer(input);
+}
+
+std::vector<Program> Parser::parseFromFile(const std::string &path) {
+    MappedFile file(path);
+    if (BinaryFormat::isBinary(file.view())) {
+        return BinaryFormat::read(file.view());
+    }
+    return parseFromBuffer(file.view());
+}
+
+void Parser::writeToStream(const std::vector<Program> &programs,
+                           std::ostream &stream) {
+    for (const auto &program: programs) {
+        std::multimap<size_t, Label> labels;
+        for (auto [label, position]: program.getLabels()) {
+            labels.emplace(position, label);
+        }
+        stream << THREAD_SEPARATOR << '\n';
+        for (size_t position = 0; position <= program.size(); ++position) {
+            auto [first, last] = labels.equal_range(position);
+            for (auto it = first; it != last; ++it) {
+                stream << it->second << ":\n";
+            }
+            if (position < program.size()) {
+                stream << program.getInstruction(position)->str() << '\n';
+            }
+        }
+    }
 }
 
 } // namespace wmm::program
\ No newline at end of file
@@ -2,19 +2,144 @@
 // Created by veronika on 20.10.23.
 //
 
+#include <unordered_set>
+
 #include "Program.h"
 
 namespace wmm::program {
 
+Program::Program(std::vector<std::shared_ptr<Instruction>> &&program,
+                 std::unordered_map<Label, size_t> &&labelMapping) {
+    auto spinLoops = findSpinLoops(program, labelMapping);
+    m_code = std::make_shared<const Code>(Code{
+            std::move(program), std::move(labelMapping), std::move(spinLoops)});
+}
+
 std::shared_ptr<Instruction> Program::getInstruction(size_t instruction) const {
-    if (instruction >= m_program.size()) return nullptr;
-    return m_program[instruction];
+    if (instruction >= m_code->instructions.size()) return nullptr;
+    return m_code->instructions[instruction];
 }
 
 size_t Program::getLabelMapping(size_t label) const {
-    return m_labelMapping.at(label);
+    return m_code->labelMapping.at(label);
+}
+
+const std::unordered_map<Label, size_t> &Program::getLabels() const {
+    return m_code->labelMapping;
+}
+
+size_t Program::size() const { return m_code->instructions.size(); }
+
+std::optional<size_t> Program::getSpinLoopHead(size_t instruction) const {
+    auto it = m_code->spinLoops.find(instruction);
+    if (it == m_code->spinLoops.end()) return {};
+    return it->second;
+}
+
+bool Program::operator==(const Program &other) const {
+    if (m_code == other.m_code) { return true; }
+    if (size() != other.size() || getLabels() != other.getLabels()) {
+        return false;
+    }
+    for (size_t i = 0; i < size(); ++i) {
+        const auto &instruction = m_code->instructions[i];
+        const auto &otherInstruction = other.m_code->instructions[i];
+        if (instruction->action != otherInstruction->action ||
+            instruction->str() != otherInstruction->str()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<size_t> findSymmetricThreads(const std::vector<Program> &programs) {
+    std::vector<size_t> symmetricThreads(programs.size());
+    for (size_t threadId = 0; threadId < programs.size(); ++threadId) {
+        size_t first = 0;
+        while (!(programs[first] == programs[threadId])) { ++first; }
+        symmetricThreads[threadId] = first;
+    }
+    return symmetricThreads;
 }
 
-size_t Program::size() const { return m_program.size(); }
+struct RegisterAccess {
+    std::vector<size_t> reads;
+    std::optional<size_t> write;
+};
+
+// Registers accessed by an instruction that may be a part of a spin loop
+static std::optional<RegisterAccess>
+getRegisterAccess(const std::shared_ptr<Instruction> &instruction) {
+    switch (instruction->action) {
+        case InstructionAction::Load: {
+            auto cmd = std::dynamic_pointer_cast<Load>(instruction);
+            return RegisterAccess{{cmd->addressRegister}, cmd->resultRegister};
+        }
+        case InstructionAction::StoreConstInRegister: {
+            auto cmd = std::dynamic_pointer_cast<StoreConstInRegister>(
+                    instruction);
+            return RegisterAccess{{}, cmd->storeRegister};
+        }
+        case InstructionAction::StoreExprInRegister: {
+            auto cmd = std::dynamic_pointer_cast<StoreExprInRegister>(
+                    instruction);
+            return RegisterAccess{{cmd->leftRegister, cmd->rightRegister},
+                                  cmd->storeRegister};
+        }
+        case InstructionAction::Goto: {
+            auto cmd = std::dynamic_pointer_cast<Goto>(instruction);
+            return RegisterAccess{{cmd->conditionRegister}, {}};
+        }
+        default:
+            return {};
+    }
+}
+
+static bool isSpinLoop(const std::vector<std::shared_ptr<Instruction>> &program,
+                       size_t head, size_t backEdge) {
+    if (program[head]->action != InstructionAction::Load) return false;
+    std::vector<RegisterAccess> accesses;
+    std::unordered_set<size_t> loopWrites;
+    for (size_t i = head; i <= backEdge; ++i) {
+        auto action = program[i]->action;
+        bool isInner = i != head && i != backEdge;
+        if (isInner && (action == InstructionAction::Load ||
+                        action == InstructionAction::Goto)) {
+            return false;
+        }
+        auto access = getRegisterAccess(program[i]);
+        if (!access) return false;
+        if (access->write) loopWrites.insert(access->write.value());
+        accesses.push_back(std::move(access.value()));
+    }
+    // A register written by the loop must be written before it is read in
+    // the same iteration, otherwise its value is carried between iterations
+    std::unordered_set<size_t> written;
+    for (const auto &access: accesses) {
+        for (auto reg: access.reads) {
+            if (loopWrites.contains(reg) && !written.contains(reg)) {
+                return false;
+            }
+        }
+        if (access.write) written.insert(access.write.value());
+    }
+    return true;
+}
+
+std::unordered_map<size_t, size_t> Program::findSpinLoops(
+        const std::vector<std::shared_ptr<Instruction>> &program,
+        const std::unordered_map<Label, size_t> &labelMapping) {
+    std::unordered_map<size_t, size_t> spinLoops;
+    for (size_t i = 0; i < program.size(); ++i) {
+        if (program[i]->action != InstructionAction::Goto) continue;
+        auto cmd = std::dynamic_pointer_cast<Goto>(program[i]);
+        auto label = labelMapping.find(cmd->label);
+        if (label == labelMapping.end() || label->second >= i) continue;
+        if (isSpinLoop(program, label->second, i)) {
+            spinLoops.emplace(i, label->second);
+        }
+    }
+    return spinLoops;
+}
 
 } // namespace wmm
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace wmm::storage {
+
+/**
+ * Sequence of nondeterministic choices made during one execution. The
+ * choices of the previous execution are replayed, the new ones are recorded
+ * with the first option taken. Calling next() after an execution moves to the
+ * next unexplored sequence in depth-first order, so every possible sequence
+ * of choices is eventually produced exactly once.
+ */
+class ChoiceSequence {
+    struct Choice {
+        size_t chosen;
+        // 0 if unknown, for the choices given to replay()
+        size_t nOfOptions;
+        // Options from this one on belong to a sequence split off
+        size_t end;
+    };
+
+    std::vector<Choice> m_choices;
+    size_t m_position = 0;
+    // Number of leading choices that are replayed but never changed
+    size_t m_nOfFixed = 0;
+    // Set by replay(): choices past the replayed ones aren't recorded
+    bool m_isReplayOnly = false;
+    size_t m_nOfOpenOptions = 0;
+
+public:
+    /**
+     * @return index of the option to take, in [0, nOfOptions)
+     */
+    size_t choose(size_t nOfOptions);
+
+    /**
+     * Prepare the next sequence of choices
+     *
+     * @return false if all sequences were explored
+     */
+    bool next();
+
+    /**
+     * Hand the unexplored options of the first choice that has any over to a
+     * new sequence, which explores exactly the sequences this one would have
+     * explored starting with these options. Call between executions, after
+     * next().
+     *
+     * @return std::nullopt if there are no unexplored options left
+     */
+    std::optional<ChoiceSequence> split();
+
+    /**
+     * Replay the given options and stop there: the choices after them take
+     * the first option and are not recorded, the number of options of the
+     * first of them is kept (see getNOfOpenOptions()). This runs an execution
+     * up to a given choice.
+     */
+    void replay(const std::vector<uint32_t> &options);
+
+    /**
+     * @return number of options of the first choice after the replayed ones,
+     * 0 if there was none yet
+     */
+    [[nodiscard]] size_t getNOfOpenOptions() const { return m_nOfOpenOptions; }
+
+    void restart() { m_position = 0; }
+
+    [[nodiscard]] size_t size() const { return m_choices.size(); }
+
+    /**
+     * @return number of choices made in the current execution
+     */
+    [[nodiscard]] size_t getPosition() const { return m_position; }
+
+    /**
+     * @return options taken by the current execution so far, which replay()
+     * takes to repeat it
+     */
+    [[nodiscard]] std::vector<uint32_t> getTakenOptions() const;
+};
+
+using ChoiceSequencePtr = std::shared_ptr<ChoiceSequence>;
+
+} // namespace wmm::storage
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wmm::storage {
+
+/**
+ * Canonical bit-packed encoding of a state of the memory and the threads:
+ * for the same programs and model, equal states have equal encodings.
+ * Locations, program positions and other indices take the bits their range
+ * needs, values and lengths take a 6-bit length and their significant bits.
+ * The encoding is prefix-free, so the bytes alone identify the state.
+ */
+class PackedState {
+    std::vector<uint8_t> m_bytes;
+
+public:
+    PackedState() = default;
+
+    explicit PackedState(std::vector<uint8_t> bytes)
+        : m_bytes(std::move(bytes)) {}
+
+    [[nodiscard]] const std::vector<uint8_t> &getBytes() const {
+        return m_bytes;
+    }
+
+    [[nodiscard]] bool empty() const { return m_bytes.empty(); }
+
+    [[nodiscard]] size_t hash() const;
+
+    auto operator<=>(const PackedState &other) const = default;
+};
+
+class StateWriter {
+    std::vector<uint8_t> m_bytes;
+    size_t m_nOfBits = 0;
+
+public:
+    void writeBits(uint64_t value, size_t width);
+
+    void writeFlag(bool flag) { writeBits(flag, 1); }
+
+    /**
+     * Index from [0, bound)
+     */
+    void writeIndex(size_t index, size_t bound);
+
+    void writeSize(size_t size);
+
+    void writeValue(int32_t value);
+
+    PackedState finish();
+};
+
+class StateReader {
+    const std::vector<uint8_t> &m_bytes;
+    size_t m_position = 0;
+
+public:
+    explicit StateReader(const PackedState &state)
+        : m_bytes(state.getBytes()) {}
+
+    uint64_t readBits(size_t width);
+
+    bool readFlag() { return readBits(1) != 0; }
+
+    size_t readIndex(size_t bound);
+
+    size_t readSize();
+
+    int32_t readValue();
+};
+
+} // namespace wmm::storage
@@ -9,6 +9,8 @@
 #include <optional>
 #include <random>
 
+#include "ChoiceSequence.h"
+#include "Probes.h"
 #include "Storage.h"
 #include "StorageManager.h"
 
@@ -18,10 +20,27 @@ class AddressBuffer {
     std::deque<int32_t> m_buffer;
 
 public:
-    void push(int32_t value);
-    [[nodiscard]] std::optional<int32_t> last() const;
-    std::optional<int32_t> pop();
-    [[nodiscard]] bool empty() const;
+    void push(int32_t value) { m_buffer.push_back(value); }
+
+    [[nodiscard]] std::optional<int32_t> last() const {
+        if (m_buffer.empty()) { return {}; }
+        return m_buffer.back();
+    }
+
+    std::optional<int32_t> pop() {
+        if (m_buffer.empty()) { return {}; }
+        int32_t value = m_buffer.front();
+        m_buffer.pop_front();
+        return value;
+    }
+
+    void clear() { m_buffer.clear(); }
+    [[nodiscard]] bool empty() const { return m_buffer.empty(); }
+    [[nodiscard]] size_t size() const { return m_buffer.size(); }
+    [[nodiscard]] size_t hash() const;
+
+    void encode(StateWriter &writer) const;
+    void decode(StateReader &reader);
 
     [[nodiscard]] std::string str() const;
 };
@@ -30,12 +49,33 @@ class ThreadBuffer {
     std::vector<AddressBuffer> m_buffer;
 
 public:
-    void push(size_t address, int32_t value);
-    std::optional<int32_t> pop(size_t address);
-    std::optional<int32_t> find(size_t address);
-    [[nodiscard]] const AddressBuffer &getBuffer(size_t address) const;
+    void push(size_t address, int32_t value) {
+        m_buffer.at(address).push(value);
+    }
+
+    std::optional<int32_t> pop(size_t address) {
+        return m_buffer.at(address).pop();
+    }
+
+    void clear();
+
+    [[nodiscard]] std::optional<int32_t> find(size_t address) const {
+        return m_buffer.at(address).last();
+    }
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+
+    [[nodiscard]] const AddressBuffer &getBuffer(size_t address) const {
+        return m_buffer.at(address);
+    }
+
     [[nodiscard]] std::string str(size_t address) const;
     [[nodiscard]] std::string str() const;
+    [[nodiscard]] size_t hash() const;
+
+    void encode(StateWriter &writer) const;
+    void decode(StateReader &reader);
 
     explicit ThreadBuffer(size_t size) : m_buffer(size) {}
 };
@@ -43,42 +83,79 @@ public:
 class InternalUpdateManager;
 class SequentialInternalUpdateManager;
 class RandomInternalUpdateManager;
+class EnumerateInternalUpdateManager;
 
 using InternalUpdateManagerPtr = std::unique_ptr<InternalUpdateManager>;
 
-class PartialStoreOrderStorageManager : public StorageManagerInterface {
+/**
+ * The memory accesses and the internal updates are defined in the header, so
+ * they are inlined into the executors instantiated for this type
+ */
+class PartialStoreOrderStorageManager final : public StorageManagerInterface {
     Storage m_storage;
     std::vector<ThreadBuffer> m_threadBuffers;
     InternalUpdateManagerPtr m_internalUpdateManager;
+    // See TSO::TotalStoreOrderStorageManager
+    RandomInternalUpdateManager *m_randomUpdateManager = nullptr;
+    EnumerateInternalUpdateManager *m_enumerateUpdateManager = nullptr;
 
     void flushBuffer(size_t threadId, size_t address);
     bool propagate(size_t threadId, size_t address);
+    void logPropagate(size_t threadId, size_t address, int32_t value);
+
+    template<class UpdateManager>
+    bool internalUpdate(UpdateManager &updateManager);
 
 public:
     PartialStoreOrderStorageManager(
             size_t storageSize, size_t nOfThreads,
             InternalUpdateManagerPtr &&internalUpdateManager,
-            LoggerPtr &&logger = std::make_unique<FakeStorageLogger>())
-        : StorageManagerInterface(std::move(logger)), m_storage(storageSize),
-          m_threadBuffers(nOfThreads, ThreadBuffer(storageSize)),
-          m_internalUpdateManager(std::move(internalUpdateManager)) {}
+            LoggerPtr &&logger = std::make_unique<FakeStorageLogger>());
 
     int32_t load(size_t threadId, size_t address,
-                 MemoryAccessMode accessMode) override;
+                 MemoryAccessMode accessMode) override {
+        auto valueFromBuffer = m_threadBuffers.at(threadId).find(address);
+        int32_t value = (valueFromBuffer) ? valueFromBuffer.value()
+                                          : m_storage.load(address);
+        m_storageLogger->load(threadId, address, accessMode, value);
+        return value;
+    }
+
     void store(size_t threadId, size_t address, int32_t value,
-               MemoryAccessMode accessMode) override;
-    void compareAndSwap(size_t threadId, size_t address, int32_t expectedValue,
-                        int32_t newValue, MemoryAccessMode accessMode) override;
+               MemoryAccessMode accessMode) override {
+        m_storageLogger->store(threadId, address, value, accessMode);
+        auto &buffer = m_threadBuffers.at(threadId);
+        buffer.push(address, value);
+        m_statistics.recordBufferDepth(buffer.getBuffer(address).size());
+    }
+
+    int32_t compareAndSwap(size_t threadId, size_t address,
+                           int32_t expectedValue, int32_t newValue,
+                           MemoryAccessMode accessMode) override;
     void fetchAndIncrement(size_t threadId, size_t address, int32_t increment,
                            MemoryAccessMode accessMode) override;
     void fence(size_t threadId, MemoryAccessMode accessMode) override;
 
     void writeStorage(std::ostream &outputStream) const override;
+    [[nodiscard]] std::vector<int32_t> getSharedStorage() const override;
+
+    [[nodiscard]] bool canLoadOtherValue(size_t threadId, size_t address,
+                                         int32_t value) const override;
+    [[nodiscard]] size_t hashState() const override;
+    [[nodiscard]] bool canEncodeState() const override { return true; }
+    void encodeState(StateWriter &writer) const override;
+    void decodeState(StateReader &reader) override;
+    void encodeThreadState(size_t threadId,
+                           StateWriter &writer) const override;
+    void permuteThreads(const std::vector<size_t> &order) override;
+    void reset(unsigned long seed) override;
     bool internalUpdate() override;
+    [[nodiscard]] size_t countPendingInternalUpdates() const override;
 
     friend class SequentialInternalUpdateManager;
     friend class RandomInternalUpdateManager;
     friend class InteractiveInternalUpdateManager;
+    friend class EnumerateInternalUpdateManager;
 };
 
 class InternalUpdateManager {
@@ -88,13 +165,15 @@ class InternalUpdateManager {
     virtual std::optional<std::pair<size_t, size_t>>
     getThreadIdAndAddress() = 0;
 
+    virtual void reseed(unsigned long seed) {}
+
     friend class PartialStoreOrderStorageManager;
 
 public:
     virtual ~InternalUpdateManager() = default;
 };
 
-class SequentialInternalUpdateManager : public InternalUpdateManager {
+class SequentialInternalUpdateManager final : public InternalUpdateManager {
     size_t m_nextThreadId = 0;
     size_t m_maxThreadId = 0;
     size_t m_nextAddress = 0;
@@ -107,20 +186,43 @@ public:
     SequentialInternalUpdateManager() = default;
 };
 
-class RandomInternalUpdateManager : public InternalUpdateManager {
+class RandomInternalUpdateManager final : public InternalUpdateManager {
     std::vector<std::pair<size_t, size_t>> m_threadIdAndAddressPairs;
     size_t m_nextThreadIdAndAddressIndex;
     std::mt19937 m_randomGenerator;
 
-    void reset(const PartialStoreOrderStorageManager &storageManager) override;
-    std::optional<std::pair<size_t, size_t>> getThreadIdAndAddress() override;
+    void reset(const PartialStoreOrderStorageManager &storageManager) override {
+        size_t nOfThreads = storageManager.m_threadBuffers.size();
+        size_t storageSize = storageManager.m_storage.size();
+        m_threadIdAndAddressPairs.clear();
+        m_threadIdAndAddressPairs.reserve(nOfThreads * storageSize);
+        for (size_t threadId = 0; threadId < nOfThreads; ++threadId) {
+            for (size_t address = 0; address < storageSize; ++address) {
+                m_threadIdAndAddressPairs.emplace_back(threadId, address);
+            }
+        }
+        std::shuffle(m_threadIdAndAddressPairs.begin(),
+                     m_threadIdAndAddressPairs.end(), m_randomGenerator);
+        m_nextThreadIdAndAddressIndex = 0;
+    }
+
+    std::optional<std::pair<size_t, size_t>> getThreadIdAndAddress() override {
+        if (m_nextThreadIdAndAddressIndex < m_threadIdAndAddressPairs.size()) {
+            return m_threadIdAndAddressPairs[m_nextThreadIdAndAddressIndex++];
+        }
+        return {};
+    }
+
+    void reseed(unsigned long seed) override { m_randomGenerator.seed(seed); }
+
+    friend class PartialStoreOrderStorageManager;
 
 public:
     explicit RandomInternalUpdateManager(unsigned long seed)
         : m_randomGenerator(seed), m_nextThreadIdAndAddressIndex(0) {}
 };
 
-class InteractiveInternalUpdateManager : public InternalUpdateManager {
+class InteractiveInternalUpdateManager final : public InternalUpdateManager {
     std::vector<std::pair<size_t, size_t>> m_threadIdAndAddressPairs;
     std::vector<std::reference_wrapper<const AddressBuffer>> m_buffers;
 
@@ -131,4 +233,81 @@ public:
     InteractiveInternalUpdateManager() = default;
 };
 
+class EnumerateInternalUpdateManager final : public InternalUpdateManager {
+    storage::ChoiceSequencePtr m_choices;
+    std::vector<std::pair<size_t, size_t>> m_threadIdAndAddressPairs;
+
+    void reset(const PartialStoreOrderStorageManager &storageManager) override {
+        m_threadIdAndAddressPairs.clear();
+        for (size_t threadId = 0;
+             threadId < storageManager.m_threadBuffers.size(); ++threadId) {
+            const auto &buffer = storageManager.m_threadBuffers[threadId];
+            for (size_t address = 0; address < storageManager.m_storage.size();
+                 ++address) {
+                if (!buffer.getBuffer(address).empty()) {
+                    m_threadIdAndAddressPairs.emplace_back(threadId, address);
+                }
+            }
+        }
+    }
+
+    std::optional<std::pair<size_t, size_t>> getThreadIdAndAddress() override {
+        if (m_threadIdAndAddressPairs.empty()) { return {}; }
+        auto pair = m_threadIdAndAddressPairs[m_choices->choose(
+                m_threadIdAndAddressPairs.size())];
+        m_threadIdAndAddressPairs.clear();
+        return pair;
+    }
+
+    friend class PartialStoreOrderStorageManager;
+
+public:
+    explicit EnumerateInternalUpdateManager(storage::ChoiceSequencePtr choices)
+        : m_choices(std::move(choices)) {}
+};
+
+inline PartialStoreOrderStorageManager::PartialStoreOrderStorageManager(
+        size_t storageSize, size_t nOfThreads,
+        InternalUpdateManagerPtr &&internalUpdateManager, LoggerPtr &&logger)
+    : StorageManagerInterface(std::move(logger)), m_storage(storageSize),
+      m_threadBuffers(nOfThreads, ThreadBuffer(storageSize)),
+      m_internalUpdateManager(std::move(internalUpdateManager)),
+      m_randomUpdateManager(dynamic_cast<RandomInternalUpdateManager *>(
+              m_internalUpdateManager.get())),
+      m_enumerateUpdateManager(dynamic_cast<EnumerateInternalUpdateManager *>(
+              m_internalUpdateManager.get())) {}
+
+inline bool PartialStoreOrderStorageManager::propagate(size_t threadId,
+                                                       size_t address) {
+    auto newValue = m_threadBuffers.at(threadId).pop(address);
+    if (!newValue) { return false; }
+    m_storage.store(address, newValue.value());
+    WMM_PROBE(propagate, threadId, address, newValue.value());
+    if (m_storageLogger->isEnabled()) {
+        logPropagate(threadId, address, newValue.value());
+    }
+    return true;
+}
+
+template<class UpdateManager>
+bool PartialStoreOrderStorageManager::internalUpdate(
+        UpdateManager &updateManager) {
+    updateManager.reset(*this);
+    while (auto threadIdAndAddress = updateManager.getThreadIdAndAddress()) {
+        auto [threadId, address] = threadIdAndAddress.value();
+        if (propagate(threadId, address)) { return true; }
+    }
+    return false;
+}
+
+inline bool PartialStoreOrderStorageManager::internalUpdate() {
+    if (m_randomUpdateManager) {
+        return internalUpdate(*m_randomUpdateManager);
+    }
+    if (m_enumerateUpdateManager) {
+        return internalUpdate(*m_enumerateUpdateManager);
+    }
+    return internalUpdate(*m_internalUpdateManager);
+}
+
 } // namespace wmm::storage::PSO
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * Static tracepoints on the hot paths. Built with the WMM_PROBES CMake option
+ * they are USDT probes of the "wmm" provider (see <sys/sdt.h>): a single nop
+ * in the code plus a note in the library, so they cost nothing until perf or
+ * bpftrace attaches to them, e.g.
+ *
+ *   perf probe -x libstorage_lib.so sdt_wmm:propagate
+ *   bpftrace -e 'usdt:./libexecution_lib.so:wmm:load { @[arg1] = count(); }'
+ *
+ * Otherwise they compile to nothing and the arguments are not evaluated.
+ * The arguments must be integers or pointers. Probes in code defined in
+ * headers, e.g. the TSO and PSO propagation, land in every library that
+ * inlines it, mostly libexecution_lib.so.
+ */
+#if defined(WMM_ENABLE_PROBES)
+#include <sys/sdt.h>
+#define WMM_PROBE(name, ...) STAP_PROBEV(wmm, name, __VA_ARGS__)
+#else
+#define WMM_PROBE(name, ...) ((void) 0)
+#endif
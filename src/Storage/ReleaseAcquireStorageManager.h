@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include "ChoiceSequence.h"
 #include "Storage.h"
 #include "StorageManager.h"
 
+#include <algorithm>
 #include <map>
 #include <cstdint>
 #include <deque>
@@ -39,9 +41,23 @@ public:
         m_timestamps[location] = timestamp;
     }
 
+    void clear() { std::fill(m_timestamps.begin(), m_timestamps.end(), 0); }
+
     [[nodiscard]] std::string str() const;
 
     [[nodiscard]] size_t size() const { return m_timestamps.size(); }
+
+    /**
+     * Write the rank of every timestamp among the given timestamps of its
+     * location, a timestamp below all of them has rank 0
+     */
+    void encode(StateWriter &writer,
+                const std::vector<std::vector<double>> &timestamps) const;
+    /**
+     * Read the ranks written by encode() as the timestamps
+     */
+    void decode(StateReader &reader,
+                const std::vector<size_t> &nOfTimestamps);
 };
 
 struct Message {
@@ -79,6 +95,7 @@ using MessageRef = std::reference_wrapper<Message>;
 class SortedMessageHistory {
 private:
     std::map<double, Message> m_buffer;
+    size_t m_location;
     size_t m_viewSize;
 
 public:
@@ -88,13 +105,23 @@ public:
     [[nodiscard]] auto end() const;
     [[nodiscard]] bool empty() const;
     [[nodiscard]] size_t size() const;
+    [[nodiscard]] const Message &last() const;
+    /**
+     * @return true if a message with a timestamp not less than the given one
+     * holds another value
+     */
+    [[nodiscard]] bool hasOtherValue(double timestamp, int32_t value) const;
     [[nodiscard]] std::string str() const;
 
     [[nodiscard]] std::vector<MessageRef>
     filterGreaterOrEqualTimestamp(double timestamp);
 
+    // Leave only the initial message
+    void clear();
+
     SortedMessageHistory(size_t location, size_t viewSize)
-        : m_buffer({{0, Message(location, viewSize)}}), m_viewSize(viewSize) {}
+        : m_buffer({{0, Message(location, viewSize)}}), m_location(location),
+          m_viewSize(viewSize) {}
 
     SortedMessageHistory() = delete;
 };
@@ -102,12 +129,13 @@ public:
 class InternalUpdateManager;
 class RandomInternalUpdateManager;
 class InteractiveInternalUpdateManager;
+class EnumerateInternalUpdateManager;
 
 using InternalUpdateManagerPtr = std::unique_ptr<InternalUpdateManager>;
 
 enum class Model { RA, SRA };
 
-class ReleaseAcquireStorageManager : public StorageManagerInterface {
+class ReleaseAcquireStorageManager final : public StorageManagerInterface {
 private:
     size_t m_storageSize;
     size_t m_viewSize;
@@ -120,7 +148,11 @@ private:
     void write(size_t threadId, size_t location, int32_t value,
                bool useMinTimestamp, bool withRelease);
     int32_t read(size_t threadId, size_t location, bool withAcquire,
-                 bool isReadBeforeAtomicUpdate);
+                 bool isReadBeforeAtomicUpdate,
+                 std::optional<int32_t> excludedValue = {});
+    // A successful CAS is an atomic update, a failed one is a plain read
+    int32_t readBeforeCompareAndSwap(size_t threadId, size_t location,
+                                     bool withAcquire, int32_t expectedValue);
 
     [[nodiscard]] std::vector<MessageRef>
     availableMessages(size_t threadId, size_t location);
@@ -129,6 +161,11 @@ private:
                       bool withAcquire);
     void cleanUpHistory(size_t location);
     [[nodiscard]] double minTimestamp(size_t location) const;
+    /**
+     * Timestamps of the messages per location that some thread can still
+     * read, i.e. not below the views of all threads
+     */
+    [[nodiscard]] std::vector<std::vector<double>> liveTimestamps() const;
 
 public:
     explicit ReleaseAcquireStorageManager(
@@ -150,11 +187,15 @@ public:
     int32_t load(size_t threadId, size_t address,
                  MemoryAccessMode accessMode) override;
 
+    int32_t loadOtherValue(size_t threadId, size_t address, int32_t value,
+                           MemoryAccessMode accessMode) override;
+
     void store(size_t threadId, size_t address, int32_t value,
                MemoryAccessMode accessMode) override;
 
-    void compareAndSwap(size_t threadId, size_t address, int32_t expectedValue,
-                        int32_t newValue, MemoryAccessMode accessMode) override;
+    int32_t compareAndSwap(size_t threadId, size_t address,
+                           int32_t expectedValue, int32_t newValue,
+                           MemoryAccessMode accessMode) override;
 
     void fetchAndIncrement(size_t threadId, size_t address, int32_t increment,
                            MemoryAccessMode accessMode) override;
@@ -163,15 +204,43 @@ public:
 
     void writeStorage(std::ostream &outputStream) const override;
 
+    [[nodiscard]] std::vector<int32_t> getSharedStorage() const override;
+
+    [[nodiscard]] bool canLoadOtherValue(size_t threadId, size_t address,
+                                         int32_t value) const override;
+    /**
+     * Hash of the canonical encoding, so states that differ only in the
+     * absolute timestamps hash the same
+     */
+    [[nodiscard]] size_t hashState() const override;
+    [[nodiscard]] bool canEncodeState() const override { return true; }
+    /**
+     * The timestamps of a location are renumbered by their rank among the
+     * messages that are still readable, in messages and views alike, and
+     * the other messages are dropped. Only the order of the timestamps
+     * matters to the model, so states that differ in the absolute values
+     * (e.g. 1.5 and 1.25 chosen between 1 and 2) get the same encoding.
+     * Decoding uses the ranks as the timestamps.
+     */
+    void encodeState(StateWriter &writer) const override;
+    void decodeState(StateReader &reader) override;
+    void encodeThreadState(size_t threadId,
+                           StateWriter &writer) const override;
+    void permuteThreads(const std::vector<size_t> &order) override;
+    void reset(unsigned long seed) override;
+
     bool internalUpdate() override { return false; }
 
     friend class RandomInternalUpdateManager;
     friend class InteractiveInternalUpdateManager;
+    friend class EnumerateInternalUpdateManager;
 };
 
 class InternalUpdateManager {
     friend class ReleaseAcquireStorageManager;
 
+    virtual void reseed(unsigned long seed) {}
+
     [[nodiscard]] virtual Message
     chooseMessage(const std::vector<MessageRef> &messages,
                   bool markReadBeforeAtomicUpdate) const = 0;
@@ -184,6 +253,12 @@ public:
 
 class RandomInternalUpdateManager : public InternalUpdateManager {
     mutable std::mt19937 m_randomGenerator;
+    // Weight of the i-th available message is (1 - bias)^i, so a positive
+    // bias prefers older messages
+    double m_oldMessageBias;
+
+    [[nodiscard]] size_t chooseIndex(size_t nOfMessages) const;
+    void reseed(unsigned long seed) override { m_randomGenerator.seed(seed); }
 
     [[nodiscard]] Message
     chooseMessage(const std::vector<MessageRef> &messages,
@@ -192,8 +267,13 @@ class RandomInternalUpdateManager : public InternalUpdateManager {
     chooseNewTimestamp(const std::vector<MessageRef> &messages) const override;
 
 public:
-    explicit RandomInternalUpdateManager(unsigned long seed)
-        : m_randomGenerator(seed) {}
+    explicit RandomInternalUpdateManager(unsigned long seed,
+                                         double oldMessageBias = 0)
+        : m_randomGenerator(seed), m_oldMessageBias(oldMessageBias) {
+        if (oldMessageBias < 0 || oldMessageBias >= 1) {
+            throw std::invalid_argument("Old message bias must be in [0, 1)");
+        }
+    }
 };
 
 class InteractiveInternalUpdateManager : public InternalUpdateManager {
@@ -207,4 +287,18 @@ class InteractiveInternalUpdateManager : public InternalUpdateManager {
 public:
 };
 
+class EnumerateInternalUpdateManager : public InternalUpdateManager {
+    storage::ChoiceSequencePtr m_choices;
+
+    [[nodiscard]] Message
+    chooseMessage(const std::vector<MessageRef> &messages,
+                  bool isReadBeforeAtomicUpdate) const override;
+    [[nodiscard]] double
+    chooseNewTimestamp(const std::vector<MessageRef> &messages) const override;
+
+public:
+    explicit EnumerateInternalUpdateManager(storage::ChoiceSequencePtr choices)
+        : m_choices(std::move(choices)) {}
+};
+
 } // namespace wmm::storage::RA
@@ -9,7 +9,8 @@
 
 namespace wmm::storage::SC {
 
-class SequentialConsistencyStorageManager : public StorageManagerInterface {
+class SequentialConsistencyStorageManager final
+    : public StorageManagerInterface {
     Storage m_storage;
 
 public:
@@ -19,16 +20,39 @@ public:
         : StorageManagerInterface(std::move(logger)), m_storage(storageSize) {}
 
     int32_t load(size_t threadId, size_t address,
-                 MemoryAccessMode accessMode) override;
+                 MemoryAccessMode accessMode) override {
+        int32_t result = m_storage.load(address);
+        m_storageLogger->load(threadId, address, accessMode, result);
+        return result;
+    }
+
     void store(size_t threadId, size_t address, int32_t value,
-               MemoryAccessMode accessMode) override;
-    void compareAndSwap(size_t threadId, size_t address, int32_t expectedValue,
-                        int32_t newValue, MemoryAccessMode accessMode) override;
+               MemoryAccessMode accessMode) override {
+        m_storageLogger->store(threadId, address, value, accessMode);
+        m_storage.store(address, value);
+    }
+
+    int32_t compareAndSwap(size_t threadId, size_t address,
+                           int32_t expectedValue, int32_t newValue,
+                           MemoryAccessMode accessMode) override;
     void fetchAndIncrement(size_t threadId, size_t address, int32_t increment,
                            MemoryAccessMode accessMode) override;
     void fence(size_t threadId, MemoryAccessMode accessMode) override;
 
     void writeStorage(std::ostream &outputStream) const override;
+    [[nodiscard]] std::vector<int32_t> getSharedStorage() const override;
+
+    [[nodiscard]] bool canLoadOtherValue(size_t threadId, size_t address,
+                                         int32_t value) const override;
+    [[nodiscard]] size_t hashState() const override;
+    [[nodiscard]] bool canEncodeState() const override { return true; }
+    void encodeState(StateWriter &writer) const override;
+    void decodeState(StateReader &reader) override;
+    // Nothing belongs to a single thread
+    void encodeThreadState(size_t threadId,
+                           StateWriter &writer) const override {}
+    void permuteThreads(const std::vector<size_t> &order) override {}
+    void reset(unsigned long seed) override;
 };
 
 } // namespace wmm::storage
@@ -8,19 +8,29 @@
 #include <ostream>
 #include <vector>
 
+#include "PackedState.h"
+
 namespace wmm::storage {
 
 class Storage {
     std::vector<int32_t> m_storage;
 public:
-    [[nodiscard]] size_t size() const noexcept;
-    [[nodiscard]] int32_t load(size_t address) const;
-    void store(size_t address, int32_t value);
+    [[nodiscard]] size_t size() const noexcept { return m_storage.size(); }
+    [[nodiscard]] int32_t load(size_t address) const {
+        return m_storage.at(address);
+    }
+    void store(size_t address, int32_t value) { m_storage.at(address) = value; }
+    // Set all values to zero
+    void clear();
 
     explicit Storage(size_t size) : m_storage(size) {}
 
     [[nodiscard]] std::vector<int32_t> getStorage() const;
     [[nodiscard]] std::string str() const;
+    [[nodiscard]] size_t hash() const;
+
+    void encode(StateWriter &writer) const;
+    void decode(StateReader &reader);
 };
 
 } // namespace wmm
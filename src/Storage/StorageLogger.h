@@ -7,6 +7,8 @@
 #include <memory>
 #include <optional>
 #include <ostream>
+#include <string>
+#include <vector>
 
 #include "StorageMemoryAccessMode.h"
 
@@ -26,26 +28,66 @@ static inline bool operator<=(LogLevel lhs, LogLevel rhs) {
 }
 
 class StorageLogger {
+    const bool m_isEnabled;
+
+    void writeLoad(size_t threadId, size_t address,
+                   MemoryAccessMode accessMode, int32_t result);
+    void writeStore(size_t threadId, size_t address, int32_t value,
+                    MemoryAccessMode accessMode);
+    void writeCompareAndSwap(size_t threadId, size_t address,
+                             int32_t expectedValue,
+                             std::optional<int32_t> realValue,
+                             int32_t newValue, MemoryAccessMode accessMode);
+    void writeFetchAndIncrement(size_t threadId, size_t address,
+                                int32_t increment, MemoryAccessMode accessMode,
+                                bool failure);
+    void writeFence(size_t threadId, MemoryAccessMode accessMode);
+
 public:
+    explicit StorageLogger(bool isEnabled = true) : m_isEnabled(isEnabled) {}
+
+    /**
+     * The memory action helpers below skip formatting the message when the
+     * logger doesn't consume info messages. The check is inline, so a
+     * disabled logger costs a branch on the memory accesses.
+     */
+    [[nodiscard]] bool isEnabled() const { return m_isEnabled; }
+
     virtual void info(const std::string &log) = 0;
     virtual void warning(const std::string &log) = 0;
     virtual void error(const std::string &log) = 0;
     virtual void storage(const StorageManagerInterface &storage) = 0;
 
     void load(size_t threadId, size_t address, MemoryAccessMode accessMode,
-              int32_t result);
+              int32_t result) {
+        if (m_isEnabled) { writeLoad(threadId, address, accessMode, result); }
+    }
 
     void store(size_t threadId, size_t address, int32_t value,
-               MemoryAccessMode accessMode);
+               MemoryAccessMode accessMode) {
+        if (m_isEnabled) { writeStore(threadId, address, value, accessMode); }
+    }
 
     void compareAndSwap(size_t threadId, size_t address, int32_t expectedValue,
                         std::optional<int32_t> realValue, int32_t newValue,
-                        MemoryAccessMode accessMode);
+                        MemoryAccessMode accessMode) {
+        if (m_isEnabled) {
+            writeCompareAndSwap(threadId, address, expectedValue, realValue,
+                                newValue, accessMode);
+        }
+    }
 
     void fetchAndIncrement(size_t threadId, size_t address, int32_t increment,
-                           MemoryAccessMode accessMode, bool failure = false);
+                           MemoryAccessMode accessMode, bool failure = false) {
+        if (m_isEnabled) {
+            writeFetchAndIncrement(threadId, address, increment, accessMode,
+                                   failure);
+        }
+    }
 
-    void fence(size_t threadId, MemoryAccessMode accessMode);
+    void fence(size_t threadId, MemoryAccessMode accessMode) {
+        if (m_isEnabled) { writeFence(threadId, accessMode); }
+    }
 
     virtual ~StorageLogger() = default;
 };
@@ -59,7 +101,8 @@ class StorageLoggerImpl : public StorageLogger {
 public:
     explicit StorageLoggerImpl(std::ostream &outputStream,
                                LogLevel logLevel = LogLevel::INFO)
-        : m_outputStream(outputStream), m_logLevel(logLevel) {}
+        : StorageLogger(logLevel >= LogLevel::INFO),
+          m_outputStream(outputStream), m_logLevel(logLevel) {}
 
     void info(const std::string &log) override;
     void warning(const std::string &log) override;
@@ -69,7 +112,7 @@ public:
 
 class FakeStorageLogger : public StorageLogger {
 public:
-    FakeStorageLogger() = default;
+    FakeStorageLogger() : StorageLogger(false) {}
 
     void info(const std::string &log) override {}
     void warning(const std::string &log) override {}
@@ -77,4 +120,21 @@ public:
     void storage(const StorageManagerInterface &storage) override {}
 };
 
+/**
+ * Collects the logged memory actions in memory
+ */
+class TraceStorageLogger : public StorageLogger {
+    std::vector<std::string> m_trace;
+
+public:
+    TraceStorageLogger() = default;
+
+    void info(const std::string &log) override { m_trace.push_back(log); }
+    void warning(const std::string &log) override {}
+    void error(const std::string &log) override {}
+    void storage(const StorageManagerInterface &storage) override {}
+
+    std::vector<std::string> takeTrace() { return std::move(m_trace); }
+};
+
 } // namespace wmm::storage
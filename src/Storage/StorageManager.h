@@ -5,17 +5,20 @@
 #pragma once
 
 #include <memory>
+#include <stdexcept>
 
 #include "Instructions.h"
 #include "Storage.h"
 #include "StorageLogger.h"
 #include "StorageMemoryAccessMode.h"
+#include "StorageStatistics.h"
 
 namespace wmm::storage {
 
 class StorageManagerInterface {
 protected:
     LoggerPtr m_storageLogger;
+    StorageStatistics m_statistics;
 
     explicit StorageManagerInterface(LoggerPtr storageLogger = nullptr)
         : m_storageLogger(std::move(storageLogger)) {}
@@ -27,9 +30,13 @@ public:
     virtual void store(size_t threadId, size_t address, int32_t value,
                        MemoryAccessMode accessMode) = 0;
 
-    virtual void compareAndSwap(size_t threadId, size_t address,
-                                int32_t expectedValue, int32_t newValue,
-                                MemoryAccessMode accessMode) = 0;
+    /**
+     * @return the value read, the new value is written if it equals the
+     * expected one
+     */
+    virtual int32_t compareAndSwap(size_t threadId, size_t address,
+                                   int32_t expectedValue, int32_t newValue,
+                                   MemoryAccessMode accessMode) = 0;
 
     virtual void fetchAndIncrement(size_t threadId, size_t address,
                                    int32_t increment,
@@ -44,7 +51,97 @@ public:
      */
     virtual bool internalUpdate() { return false; };
 
+    /**
+     * @return number of internal updates (e.g. buffered stores) that are
+     * waiting to be performed
+     */
+    [[nodiscard]] virtual size_t countPendingInternalUpdates() const {
+        return 0;
+    }
+
+    /**
+     * @return false if a load of the thread from the address can only return
+     * the given value until some other thread or an internal update changes
+     * the memory
+     */
+    [[nodiscard]] virtual bool canLoadOtherValue(size_t threadId,
+                                                 size_t address,
+                                                 int32_t value) const {
+        return true;
+    }
+
+    /**
+     * Load that skips the results equal to the given value, the thread must
+     * be able to load another value. Loads are deterministic unless the model
+     * overrides it.
+     */
+    virtual int32_t loadOtherValue(size_t threadId, size_t address,
+                                   int32_t value, MemoryAccessMode accessMode) {
+        return load(threadId, address, accessMode);
+    }
+
     virtual void writeStorage(std::ostream &outputStream) const = 0;
+
+    /**
+     * Values of the shared locations as they would be seen by a thread that
+     * synchronized with every write
+     */
+    [[nodiscard]] virtual std::vector<int32_t> getSharedStorage() const = 0;
+
+    /**
+     * Hash of everything that affects the future behaviour of the memory:
+     * values, buffers, message histories and views
+     */
+    [[nodiscard]] virtual size_t hashState() const = 0;
+
+    /**
+     * @return true if the model implements encodeState() and decodeState()
+     */
+    [[nodiscard]] virtual bool canEncodeState() const { return false; }
+
+    /**
+     * Write the canonical encoding of everything hashState() covers, see
+     * PackedState
+     */
+    virtual void encodeState(StateWriter &writer) const {
+        throw std::logic_error("The model doesn't support state encoding");
+    }
+
+    /**
+     * Restore the state written by encodeState()
+     */
+    virtual void decodeState(StateReader &reader) {
+        throw std::logic_error("The model doesn't support state encoding");
+    }
+
+    /**
+     * Write the part of the state that belongs to the thread, e.g. its
+     * buffer or view. Swapping two threads with equal programs and equal
+     * parts leaves the state the same.
+     */
+    virtual void encodeThreadState(size_t threadId, StateWriter &writer) const {
+        throw std::logic_error("The model doesn't support state encoding");
+    }
+
+    /**
+     * Renumber the threads: thread i takes over the part of the state of
+     * thread order[i]
+     */
+    virtual void permuteThreads(const std::vector<size_t> &order) {
+        throw std::logic_error("The model doesn't support state encoding");
+    }
+
+    /**
+     * Return to the initial state reusing the allocated memory, randomized
+     * internal updates are re-seeded
+     */
+    virtual void reset(unsigned long seed) = 0;
+
+    [[nodiscard]] const StorageStatistics &getStatistics() const {
+        return m_statistics;
+    }
+
+    virtual ~StorageManagerInterface() = default;
 };
 
 using StorageManagerPtr = std::shared_ptr<StorageManagerInterface>;
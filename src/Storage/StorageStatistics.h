@@ -0,0 +1,39 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace wmm::storage {
+
+/**
+ * Profiling counters of a storage manager. They accumulate over all
+ * executions, reset() doesn't clear them.
+ */
+struct StorageStatistics {
+    // Deepest store buffer: per thread under TSO, per thread and location
+    // under PSO
+    size_t maxBufferDepth = 0;
+    // Longest RA message history per location
+    std::vector<size_t> maxHistoryLengths;
+    // RA messages dropped because no thread can read them anymore
+    size_t historyPops = 0;
+    // RA views joined by reads and SC fences
+    size_t viewJoins = 0;
+
+    void recordBufferDepth(size_t depth) {
+        maxBufferDepth = std::max(maxBufferDepth, depth);
+    }
+
+    void recordHistoryLength(size_t location, size_t length) {
+        if (location >= maxHistoryLengths.size()) {
+            maxHistoryLengths.resize(location + 1);
+        }
+        maxHistoryLengths[location] =
+                std::max(maxHistoryLengths[location], length);
+    }
+
+    void merge(const StorageStatistics &other);
+};
+
+} // namespace wmm::storage
@@ -9,6 +9,8 @@
 #include <optional>
 #include <random>
 
+#include "ChoiceSequence.h"
+#include "Probes.h"
 #include "Storage.h"
 #include "StorageManager.h"
 
@@ -25,58 +27,122 @@ class Buffer {
     std::deque<StoreInstruction> m_buffer;
 
 public:
-    void push(StoreInstruction instruction);
-    std::optional<StoreInstruction> pop();
-    std::optional<int32_t> find(size_t address);
-    [[nodiscard]] bool empty() const;
+    void push(StoreInstruction instruction) {
+        m_buffer.push_back(instruction);
+    }
+
+    std::optional<StoreInstruction> pop() {
+        if (m_buffer.empty()) { return {}; }
+        auto returnValue = m_buffer.front();
+        m_buffer.pop_front();
+        return returnValue;
+    }
+
+    void clear() { m_buffer.clear(); }
+
+    [[nodiscard]] std::optional<int32_t> find(size_t address) const {
+        auto elm = std::find_if(m_buffer.rbegin(), m_buffer.rend(),
+                                [address](auto instruction) {
+                                    return instruction.address == address;
+                                });
+        if (elm == m_buffer.rend()) { return {}; }
+        return elm->value;
+    }
+
+    [[nodiscard]] bool empty() const { return m_buffer.empty(); }
+    [[nodiscard]] size_t size() const { return m_buffer.size(); }
     [[nodiscard]] std::string str() const;
+    [[nodiscard]] size_t hash() const;
+
+    void encode(StateWriter &writer, size_t storageSize) const;
+    void decode(StateReader &reader, size_t storageSize);
 };
 
 class InternalUpdateManager;
 class SequentialInternalUpdateManager;
 class RandomInternalUpdateManager;
 class InteractiveInternalUpdateManager;
+class EnumerateInternalUpdateManager;
 
 using InternalUpdateManagerPtr = std::unique_ptr<InternalUpdateManager>;
 
-class TotalStoreOrderStorageManager : public StorageManagerInterface {
+/**
+ * The memory accesses and the internal updates are defined in the header, so
+ * they are inlined into the executors instantiated for this type (see
+ * execution::BasicExecutor)
+ */
+class TotalStoreOrderStorageManager final : public StorageManagerInterface {
     Storage m_storage;
     std::vector<Buffer> m_threadBuffers;
     InternalUpdateManagerPtr m_internalUpdateManager;
+    // The update manager with its concrete type if it is one of the kinds
+    // used by bulk runs, so that internalUpdate() doesn't make virtual calls
+    RandomInternalUpdateManager *m_randomUpdateManager = nullptr;
+    EnumerateInternalUpdateManager *m_enumerateUpdateManager = nullptr;
 
     void flushBuffer(size_t threadId);
     bool propagate(size_t threadId);
+    void logPropagate(size_t threadId, const StoreInstruction &instruction);
+
+    template<class UpdateManager>
+    bool internalUpdate(UpdateManager &updateManager);
 
 public:
     TotalStoreOrderStorageManager(
             size_t storageSize, size_t nOfThreads,
             InternalUpdateManagerPtr &&internalUpdateManager,
-            LoggerPtr &&logger = std::make_unique<FakeStorageLogger>())
-        : StorageManagerInterface(std::move(logger)), m_storage(storageSize),
-          m_threadBuffers(nOfThreads),
-          m_internalUpdateManager(std::move(internalUpdateManager)) {}
+            LoggerPtr &&logger = std::make_unique<FakeStorageLogger>());
 
     int32_t load(size_t threadId, size_t address,
-                 MemoryAccessMode accessMode) override;
+                 MemoryAccessMode accessMode) override {
+        auto valueFromBuffer = m_threadBuffers.at(threadId).find(address);
+        int32_t value = (valueFromBuffer) ? valueFromBuffer.value()
+                                          : m_storage.load(address);
+        m_storageLogger->load(threadId, address, accessMode, value);
+        return value;
+    }
+
     void store(size_t threadId, size_t address, int32_t value,
-               MemoryAccessMode accessMode) override;
-    void compareAndSwap(size_t threadId, size_t address, int32_t expectedValue,
-                        int32_t newValue, MemoryAccessMode accessMode) override;
+               MemoryAccessMode accessMode) override {
+        m_storageLogger->store(threadId, address, value, accessMode);
+        auto &buffer = m_threadBuffers.at(threadId);
+        buffer.push({address, value});
+        m_statistics.recordBufferDepth(buffer.size());
+    }
+
+    int32_t compareAndSwap(size_t threadId, size_t address,
+                           int32_t expectedValue, int32_t newValue,
+                           MemoryAccessMode accessMode) override;
     void fetchAndIncrement(size_t threadId, size_t address, int32_t increment,
                            MemoryAccessMode accessMode) override;
     void fence(size_t threadId, MemoryAccessMode accessMode) override;
 
     void writeStorage(std::ostream &outputStream) const override;
+    [[nodiscard]] std::vector<int32_t> getSharedStorage() const override;
+
+    [[nodiscard]] bool canLoadOtherValue(size_t threadId, size_t address,
+                                         int32_t value) const override;
+    [[nodiscard]] size_t hashState() const override;
+    [[nodiscard]] bool canEncodeState() const override { return true; }
+    void encodeState(StateWriter &writer) const override;
+    void decodeState(StateReader &reader) override;
+    void encodeThreadState(size_t threadId,
+                           StateWriter &writer) const override;
+    void permuteThreads(const std::vector<size_t> &order) override;
+    void reset(unsigned long seed) override;
     bool internalUpdate() override;
+    [[nodiscard]] size_t countPendingInternalUpdates() const override;
 
     friend class SequentialInternalUpdateManager;
     friend class RandomInternalUpdateManager;
     friend class InteractiveInternalUpdateManager;
+    friend class EnumerateInternalUpdateManager;
 };
 
 class InternalUpdateManager {
     virtual void reset(const TotalStoreOrderStorageManager &storageManager) = 0;
     virtual std::optional<size_t> getThreadId() = 0;
+    virtual void reseed(unsigned long seed) {}
 
     friend class TotalStoreOrderStorageManager;
 
@@ -84,7 +150,7 @@ public:
     virtual ~InternalUpdateManager() = default;
 };
 
-class SequentialInternalUpdateManager : public InternalUpdateManager {
+class SequentialInternalUpdateManager final : public InternalUpdateManager {
     size_t m_nextThreadId = 0;
     size_t m_maxThreadId = 0;
 
@@ -95,20 +161,36 @@ public:
     SequentialInternalUpdateManager() = default;
 };
 
-class RandomInternalUpdateManager : public InternalUpdateManager {
+class RandomInternalUpdateManager final : public InternalUpdateManager {
     std::vector<size_t> m_threadIds;
     size_t m_nextThreadIdIndex;
     std::mt19937 m_randomGenerator;
 
-    void reset(const TotalStoreOrderStorageManager &storageManager) override;
-    std::optional<size_t> getThreadId() override;
+    void reset(const TotalStoreOrderStorageManager &storageManager) override {
+        m_threadIds.resize(storageManager.m_threadBuffers.size());
+        for (size_t i = 0; i < m_threadIds.size(); ++i) { m_threadIds[i] = i; }
+        std::shuffle(m_threadIds.begin(), m_threadIds.end(),
+                     m_randomGenerator);
+        m_nextThreadIdIndex = 0;
+    }
+
+    std::optional<size_t> getThreadId() override {
+        if (m_nextThreadIdIndex < m_threadIds.size()) {
+            return m_threadIds[m_nextThreadIdIndex++];
+        }
+        return {};
+    }
+
+    void reseed(unsigned long seed) override { m_randomGenerator.seed(seed); }
+
+    friend class TotalStoreOrderStorageManager;
 
 public:
     explicit RandomInternalUpdateManager(unsigned long seed)
         : m_randomGenerator(seed), m_nextThreadIdIndex(0) {}
 };
 
-class InteractiveInternalUpdateManager : public InternalUpdateManager {
+class InteractiveInternalUpdateManager final : public InternalUpdateManager {
     std::vector<size_t> m_threadIds;
     std::vector<std::reference_wrapper<const Buffer>> m_buffers;
 
@@ -118,5 +200,71 @@ class InteractiveInternalUpdateManager : public InternalUpdateManager {
 public:
 };
 
+class EnumerateInternalUpdateManager final : public InternalUpdateManager {
+    storage::ChoiceSequencePtr m_choices;
+    std::vector<size_t> m_threadIds;
+
+    void reset(const TotalStoreOrderStorageManager &storageManager) override {
+        m_threadIds.clear();
+        for (size_t i = 0; i < storageManager.m_threadBuffers.size(); ++i) {
+            if (!storageManager.m_threadBuffers[i].empty()) {
+                m_threadIds.push_back(i);
+            }
+        }
+    }
+
+    std::optional<size_t> getThreadId() override {
+        if (m_threadIds.empty()) { return {}; }
+        size_t threadId = m_threadIds[m_choices->choose(m_threadIds.size())];
+        m_threadIds.clear();
+        return threadId;
+    }
+
+    friend class TotalStoreOrderStorageManager;
+
+public:
+    explicit EnumerateInternalUpdateManager(storage::ChoiceSequencePtr choices)
+        : m_choices(std::move(choices)) {}
+};
+
+inline TotalStoreOrderStorageManager::TotalStoreOrderStorageManager(
+        size_t storageSize, size_t nOfThreads,
+        InternalUpdateManagerPtr &&internalUpdateManager, LoggerPtr &&logger)
+    : StorageManagerInterface(std::move(logger)), m_storage(storageSize),
+      m_threadBuffers(nOfThreads),
+      m_internalUpdateManager(std::move(internalUpdateManager)),
+      m_randomUpdateManager(dynamic_cast<RandomInternalUpdateManager *>(
+              m_internalUpdateManager.get())),
+      m_enumerateUpdateManager(dynamic_cast<EnumerateInternalUpdateManager *>(
+              m_internalUpdateManager.get())) {}
+
+inline bool TotalStoreOrderStorageManager::propagate(size_t threadId) {
+    auto instruction = m_threadBuffers.at(threadId).pop();
+    if (!instruction) { return false; }
+    m_storage.store(instruction->address, instruction->value);
+    WMM_PROBE(propagate, threadId, instruction->address, instruction->value);
+    if (m_storageLogger->isEnabled()) { logPropagate(threadId, *instruction); }
+    return true;
+}
+
+template<class UpdateManager>
+bool TotalStoreOrderStorageManager::internalUpdate(
+        UpdateManager &updateManager) {
+    updateManager.reset(*this);
+    while (auto threadId = updateManager.getThreadId()) {
+        if (propagate(threadId.value())) { return true; }
+    }
+    return false;
+}
+
+inline bool TotalStoreOrderStorageManager::internalUpdate() {
+    if (m_randomUpdateManager) {
+        return internalUpdate(*m_randomUpdateManager);
+    }
+    if (m_enumerateUpdateManager) {
+        return internalUpdate(*m_enumerateUpdateManager);
+    }
+    return internalUpdate(*m_internalUpdateManager);
+}
 
 } // namespace wmm::storage::TSO
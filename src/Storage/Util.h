@@ -15,9 +15,10 @@ std::string join(const std::vector<T> &data,
                  std::function<std::string(T)> toString,
                  const std::string &separator = " ") {
     std::stringstream stream;
-    bool isFirstIteration;
+    bool isFirstIteration = true;
     for (const auto &elm: data) {
         if (!isFirstIteration) { stream << separator; }
+        isFirstIteration = false;
         stream << toString(elm);
     }
     return stream.str();
@@ -27,11 +28,37 @@ template<class T>
 std::string join(const std::vector<T> &data,
                  const std::string &separator = " ") {
     std::stringstream stream;
-    bool isFirstIteration;
+    bool isFirstIteration = true;
     for (const auto &elm: data) {
         if (!isFirstIteration) { stream << separator; }
+        isFirstIteration = false;
         stream << elm;
     }
     return stream.str();
 }
+
+/**
+ * Mixes the hash of the value into the seed (boost::hash_combine)
+ */
+template<class T>
+void hashCombine(size_t &seed, const T &value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+template<class T>
+void hashCombine(size_t &seed, const std::vector<T> &values) {
+    hashCombine(seed, values.size());
+    for (const auto &value: values) { hashCombine(seed, value); }
+}
+
+/**
+ * Reorder the values so that the i-th one is the old order[i]-th one
+ */
+template<class T>
+void permute(std::vector<T> &values, const std::vector<size_t> &order) {
+    std::vector<T> permuted;
+    permuted.reserve(order.size());
+    for (auto i: order) { permuted.push_back(std::move(values[i])); }
+    values = std::move(permuted);
+}
 } // namespace
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include <stdexcept>
+
+#include "ChoiceSequence.h"
+
+namespace wmm::storage {
+
+size_t ChoiceSequence::choose(size_t nOfOptions) {
+    if (nOfOptions <= 1) { return 0; }
+    if (m_position < m_choices.size()) {
+        const auto &choice = m_choices[m_position++];
+        if ((choice.nOfOptions != 0 && choice.nOfOptions != nOfOptions) ||
+            choice.chosen >= nOfOptions) {
+            throw std::runtime_error("Replayed execution diverged");
+        }
+        return choice.chosen;
+    }
+    if (m_isReplayOnly) {
+        if (m_nOfOpenOptions == 0) { m_nOfOpenOptions = nOfOptions; }
+        return 0;
+    }
+    m_choices.push_back({0, nOfOptions, nOfOptions});
+    ++m_position;
+    return 0;
+}
+
+bool ChoiceSequence::next() {
+    m_choices.resize(m_position);
+    m_position = 0;
+    while (m_choices.size() > m_nOfFixed) {
+        auto &last = m_choices.back();
+        if (last.chosen + 1 < last.end) {
+            ++last.chosen;
+            return true;
+        }
+        m_choices.pop_back();
+    }
+    return false;
+}
+
+std::vector<uint32_t> ChoiceSequence::getTakenOptions() const {
+    std::vector<uint32_t> options;
+    options.reserve(m_position);
+    for (size_t i = 0; i < m_position; ++i) {
+        options.push_back(m_choices[i].chosen);
+    }
+    return options;
+}
+
+void ChoiceSequence::replay(const std::vector<uint32_t> &options) {
+    m_choices.clear();
+    for (auto option: options) { m_choices.push_back({option, 0, option + 1}); }
+    m_position = 0;
+    m_nOfFixed = m_choices.size();
+    m_isReplayOnly = true;
+    m_nOfOpenOptions = 0;
+}
+
+std::optional<ChoiceSequence> ChoiceSequence::split() {
+    for (size_t i = m_nOfFixed; i < m_choices.size(); ++i) {
+        auto &choice = m_choices[i];
+        if (choice.chosen + 1 >= choice.end) { continue; }
+        ChoiceSequence other;
+        other.m_choices.assign(m_choices.begin(), m_choices.begin() + i + 1);
+        other.m_choices.back().chosen = choice.chosen + 1;
+        other.m_nOfFixed = i;
+        choice.end = choice.chosen + 1;
+        return other;
+    }
+    return std::nullopt;
+}
+
+} // namespace wmm::storage
@@ -0,0 +1,91 @@
+#include <bit>
+#include <stdexcept>
+
+#include "PackedState.h"
+
+namespace wmm::storage {
+
+namespace {
+constexpr size_t LENGTH_WIDTH = 6;
+
+size_t indexWidth(size_t bound) {
+    return bound <= 1 ? 0 : std::bit_width(bound - 1);
+}
+} // namespace
+
+size_t PackedState::hash() const {
+    uint64_t hash = 0xcbf29ce484222325ULL ^ m_bytes.size();
+    for (auto byte: m_bytes) {
+        hash ^= byte;
+        hash *= 0x100000001b3ULL;
+    }
+    hash ^= hash >> 31;
+    hash *= 0x94d049bb133111ebULL;
+    return hash ^ (hash >> 29);
+}
+
+void StateWriter::writeBits(uint64_t value, size_t width) {
+    for (size_t bit = 0; bit < width; ++bit, ++m_nOfBits) {
+        if (m_nOfBits % 8 == 0) { m_bytes.push_back(0); }
+        if ((value >> bit) & 1) {
+            m_bytes.back() |= static_cast<uint8_t>(1 << (m_nOfBits % 8));
+        }
+    }
+}
+
+void StateWriter::writeIndex(size_t index, size_t bound) {
+    if (index >= bound) { throw std::out_of_range("Index out of range"); }
+    writeBits(index, indexWidth(bound));
+}
+
+void StateWriter::writeSize(size_t size) {
+    // The highest set bit is implied by the length
+    size_t length = std::bit_width(size);
+    writeBits(length, LENGTH_WIDTH);
+    if (length > 1) { writeBits(size, length - 1); }
+}
+
+void StateWriter::writeValue(int32_t value) {
+    auto unsignedValue = static_cast<uint32_t>(value);
+    // Zigzag, so small negative values are short too
+    writeSize((unsignedValue << 1) ^ (value < 0 ? UINT32_MAX : 0));
+}
+
+PackedState StateWriter::finish() {
+    PackedState state(std::move(m_bytes));
+    m_bytes.clear();
+    m_nOfBits = 0;
+    return state;
+}
+
+uint64_t StateReader::readBits(size_t width) {
+    if (m_position + width > m_bytes.size() * 8) {
+        throw std::out_of_range("Packed state is too short");
+    }
+    uint64_t value = 0;
+    for (size_t bit = 0; bit < width; ++bit, ++m_position) {
+        if ((m_bytes[m_position / 8] >> (m_position % 8)) & 1) {
+            value |= uint64_t{1} << bit;
+        }
+    }
+    return value;
+}
+
+size_t StateReader::readIndex(size_t bound) {
+    size_t index = readBits(indexWidth(bound));
+    if (index >= bound) { throw std::out_of_range("Index out of range"); }
+    return index;
+}
+
+size_t StateReader::readSize() {
+    size_t length = readBits(LENGTH_WIDTH);
+    if (length <= 1) { return length; }
+    return readBits(length - 1) | (size_t{1} << (length - 1));
+}
+
+int32_t StateReader::readValue() {
+    auto zigzag = static_cast<uint32_t>(readSize());
+    return static_cast<int32_t>((zigzag >> 1) ^ (0 - (zigzag & 1)));
+}
+
+} // namespace wmm::storage
@@ -7,26 +7,11 @@
 #include <ostream>
 
 #include "PartialStoreOrderStorageManager.h"
+#include "Util.h"
 
 namespace wmm::storage::PSO {
 
-int32_t PartialStoreOrderStorageManager::load(size_t threadId, size_t address,
-                                              MemoryAccessMode accessMode) {
-    auto valueFromBuffer = m_threadBuffers.at(threadId).find(address);
-    int32_t value = (valueFromBuffer) ? valueFromBuffer.value()
-                                      : m_storage.load(address);
-    m_storageLogger->load(threadId, address, accessMode, value);
-    return value;
-}
-
-void PartialStoreOrderStorageManager::store(size_t threadId, size_t address,
-                                            int32_t value,
-                                            MemoryAccessMode accessMode) {
-    m_storageLogger->store(threadId, address, value, accessMode);
-    m_threadBuffers.at(threadId).push(address, value);
-}
-
-void PartialStoreOrderStorageManager::compareAndSwap(
+int32_t PartialStoreOrderStorageManager::compareAndSwap(
         size_t threadId, size_t address, int32_t expectedValue,
         int32_t newValue, MemoryAccessMode accessMode) {
     flushBuffer(threadId, address);
@@ -34,6 +19,7 @@ void PartialStoreOrderStorageManager::compareAndSwap(
     m_storageLogger->compareAndSwap(threadId, address, expectedValue, value,
                                     newValue, accessMode);
     if (value == expectedValue) { m_storage.store(address, newValue); }
+    return value;
 }
 
 void PartialStoreOrderStorageManager::flushBuffer(size_t threadId,
@@ -68,37 +54,81 @@ void PartialStoreOrderStorageManager::writeStorage(
     }
 }
 
-bool PartialStoreOrderStorageManager::propagate(size_t threadId,
-                                                size_t address) {
-    auto newValue = m_threadBuffers.at(threadId).pop(address);
-    if (newValue) {
-        m_storage.store(address, newValue.value());
-        m_storageLogger->info(std::format("ACTION: b{}#{}: propagate ({})",
-                                          threadId, address, newValue.value()));
-        return true;
-    }
-    return false;
+std::vector<int32_t> PartialStoreOrderStorageManager::getSharedStorage() const {
+    return m_storage.getStorage();
+}
+
+bool PartialStoreOrderStorageManager::canLoadOtherValue(
+        size_t threadId, size_t address, int32_t value) const {
+    auto valueFromBuffer = m_threadBuffers.at(threadId).find(address);
+    return valueFromBuffer.value_or(m_storage.load(address)) != value;
 }
 
-bool PartialStoreOrderStorageManager::internalUpdate() {
-    m_internalUpdateManager->reset(*this);
-    while (auto threadIdAndAddress =
-                   m_internalUpdateManager->getThreadIdAndAddress()) {
-        auto [threadId, address] = threadIdAndAddress.value();
-        if (propagate(threadId, address)) { return true; }
+size_t PartialStoreOrderStorageManager::hashState() const {
+    size_t seed = m_storage.hash();
+    for (const auto &buffer: m_threadBuffers) {
+        util::hashCombine(seed, buffer.hash());
     }
-    return false;
+    return seed;
 }
 
-void ThreadBuffer::push(size_t address, int32_t value) {
-    m_buffer.at(address).push(value);
+void PartialStoreOrderStorageManager::encodeState(StateWriter &writer) const {
+    m_storage.encode(writer);
+    for (const auto &buffer: m_threadBuffers) { buffer.encode(writer); }
 }
-std::optional<int32_t> ThreadBuffer::pop(size_t address) {
-    return m_buffer.at(address).pop();
+
+void PartialStoreOrderStorageManager::decodeState(StateReader &reader) {
+    m_storage.decode(reader);
+    for (auto &buffer: m_threadBuffers) { buffer.decode(reader); }
+}
+
+void PartialStoreOrderStorageManager::encodeThreadState(
+        size_t threadId, StateWriter &writer) const {
+    m_threadBuffers[threadId].encode(writer);
+}
+
+void PartialStoreOrderStorageManager::permuteThreads(
+        const std::vector<size_t> &order) {
+    util::permute(m_threadBuffers, order);
+}
+
+void PartialStoreOrderStorageManager::reset(unsigned long seed) {
+    m_storage.clear();
+    for (auto &buffer: m_threadBuffers) { buffer.clear(); }
+    m_internalUpdateManager->reseed(seed);
+}
+
+void PartialStoreOrderStorageManager::logPropagate(size_t threadId,
+                                                   size_t address,
+                                                   int32_t value) {
+    m_storageLogger->info(std::format("ACTION: b{}#{}: propagate ({})",
+                                      threadId, address, value));
+}
+
+size_t PartialStoreOrderStorageManager::countPendingInternalUpdates() const {
+    size_t count = 0;
+    for (const auto &buffer: m_threadBuffers) { count += buffer.size(); }
+    return count;
 }
 
-std::optional<int32_t> ThreadBuffer::find(size_t address) {
-    return m_buffer.at(address).last();
+void ThreadBuffer::clear() {
+    for (auto &buffer: m_buffer) { buffer.clear(); }
+}
+
+size_t ThreadBuffer::hash() const {
+    size_t seed = 0;
+    for (const auto &buffer: m_buffer) {
+        util::hashCombine(seed, buffer.hash());
+    }
+    return seed;
+}
+
+void ThreadBuffer::encode(StateWriter &writer) const {
+    for (const auto &buffer: m_buffer) { buffer.encode(writer); }
+}
+
+void ThreadBuffer::decode(StateReader &reader) {
+    for (auto &buffer: m_buffer) { buffer.decode(reader); }
 }
 
 std::string ThreadBuffer::str(size_t address) const {
@@ -115,8 +145,15 @@ std::string ThreadBuffer::str() const {
     return result;
 }
 
-const AddressBuffer &ThreadBuffer::getBuffer(size_t address) const {
-    return m_buffer.at(address);
+bool ThreadBuffer::empty() const {
+    return std::all_of(m_buffer.begin(), m_buffer.end(),
+                       [](const auto &buffer) { return buffer.empty(); });
+}
+
+size_t ThreadBuffer::size() const {
+    size_t size = 0;
+    for (const auto &buffer: m_buffer) { size += buffer.size(); }
+    return size;
 }
 
 void SequentialInternalUpdateManager::reset(
@@ -137,43 +174,20 @@ SequentialInternalUpdateManager::getThreadIdAndAddress() {
     return {{m_nextThreadId, m_nextAddress++}};
 }
 
-void RandomInternalUpdateManager::reset(
-        const PartialStoreOrderStorageManager &storageManager) {
-    m_threadIdAndAddressPairs.reserve(storageManager.m_threadBuffers.size() *
-                                      storageManager.m_storage.size());
-    for (size_t threadId = 0; threadId < storageManager.m_threadBuffers.size();
-         ++threadId) {
-        for (size_t address = 0; address < storageManager.m_storage.size();
-             ++address) {
-            m_threadIdAndAddressPairs.emplace_back(threadId, address);
-        }
-    }
-    std::shuffle(m_threadIdAndAddressPairs.begin(),
-                 m_threadIdAndAddressPairs.end(), m_randomGenerator);
-    m_nextThreadIdAndAddressIndex = 0;
-}
-
-std::optional<std::pair<size_t, size_t>>
-RandomInternalUpdateManager::getThreadIdAndAddress() {
-    if (m_nextThreadIdAndAddressIndex < m_threadIdAndAddressPairs.size()) {
-        return m_threadIdAndAddressPairs[m_nextThreadIdAndAddressIndex++];
-    }
-    return {};
+size_t AddressBuffer::hash() const {
+    size_t seed = m_buffer.size();
+    for (auto value: m_buffer) { util::hashCombine(seed, value); }
+    return seed;
 }
 
-void AddressBuffer::push(int32_t value) { m_buffer.push_back(value); }
-std::optional<int32_t> AddressBuffer::pop() {
-    if (m_buffer.empty()) { return {}; }
-    int32_t value = m_buffer.front();
-    m_buffer.pop_front();
-    return value;
+void AddressBuffer::encode(StateWriter &writer) const {
+    writer.writeSize(m_buffer.size());
+    for (auto value: m_buffer) { writer.writeValue(value); }
 }
 
-bool AddressBuffer::empty() const { return m_buffer.empty(); }
-
-std::optional<int32_t> AddressBuffer::last() const {
-    if (m_buffer.empty()) { return {}; }
-    return m_buffer.back();
+void AddressBuffer::decode(StateReader &reader) {
+    m_buffer.resize(reader.readSize());
+    for (auto &value: m_buffer) { value = reader.readValue(); }
 }
 
 std::string AddressBuffer::str() const {
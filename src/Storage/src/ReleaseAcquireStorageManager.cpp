@@ -2,9 +2,11 @@
 // Created by veronika on 06.12.23.
 //
 
+#include "Probes.h"
 #include "ReleaseAcquireStorageManager.h"
 #include "Util.h"
 
+#include <algorithm>
 #include <cassert>
 #include <format>
 #include <iostream>
@@ -73,6 +75,26 @@ View &View::operator|=(const View &view) {
 
 std::string View::str() const { return util::join(m_timestamps); }
 
+void View::encode(StateWriter &writer,
+                  const std::vector<std::vector<double>> &timestamps) const {
+    for (size_t location = 0; location < m_timestamps.size(); ++location) {
+        const auto &locationTimestamps = timestamps[location];
+        auto rank = std::lower_bound(locationTimestamps.begin(),
+                                     locationTimestamps.end(),
+                                     m_timestamps[location]) -
+                    locationTimestamps.begin();
+        writer.writeIndex(rank, locationTimestamps.size());
+    }
+}
+
+void View::decode(StateReader &reader,
+                  const std::vector<size_t> &nOfTimestamps) {
+    for (size_t location = 0; location < m_timestamps.size(); ++location) {
+        m_timestamps[location] =
+                static_cast<double>(reader.readIndex(nOfTimestamps[location]));
+    }
+}
+
 View &View::operator&=(const View &view) {
     for (size_t i = 0; i < m_timestamps.size(); ++i) {
         if (m_timestamps[i] > view.m_timestamps[i]) {
@@ -91,7 +113,6 @@ std::string Message::str() const {
                        releaseViewStr);
 }
 
-
 void SortedMessageHistory::push(const Message &message) {
     m_buffer.insert({message.timestamp, message});
 }
@@ -111,6 +132,23 @@ std::string SortedMessageHistory::str() const {
 
 size_t SortedMessageHistory::size() const { return m_buffer.size(); }
 
+const Message &SortedMessageHistory::last() const {
+    return m_buffer.rbegin()->second;
+}
+
+bool SortedMessageHistory::hasOtherValue(double timestamp,
+                                         int32_t value) const {
+    return std::any_of(m_buffer.lower_bound(timestamp), m_buffer.end(),
+                       [value](const auto &elm) {
+                           return elm.second.value != value;
+                       });
+}
+
+void SortedMessageHistory::clear() {
+    m_buffer.clear();
+    m_buffer.emplace(0, Message(m_location, m_viewSize));
+}
+
 void SortedMessageHistory::pop() { m_buffer.erase(m_buffer.begin()); }
 auto SortedMessageHistory::begin() const { return m_buffer.begin(); }
 auto SortedMessageHistory::end() const { return m_buffer.end(); }
@@ -134,16 +172,28 @@ ReleaseAcquireStorageManager::availableMessages(size_t threadId,
 void ReleaseAcquireStorageManager::applyMessage(size_t threadId,
                                                 const Message &message,
                                                 bool withAcquire) {
-    m_threadViews[threadId] |= (withAcquire && message.releaseView)
-                                       ? message.releaseView.value()
-                                       : message.baseView;
+    auto &view = m_threadViews[threadId];
+    view |= (withAcquire && message.releaseView) ? message.releaseView.value()
+                                                 : message.baseView;
+    ++m_statistics.viewJoins;
+    // Coherence: the thread can't read older messages of the location later,
+    // and an atomic update writes right after the message it has read
+    if (view[message.location] < message.timestamp) {
+        view.setTimestamp(message.location, message.timestamp);
+    }
     cleanUpHistory(message.location);
 }
 
 void ReleaseAcquireStorageManager::cleanUpHistory(size_t location) {
     double minTime = minTimestamp(location);
     auto &buffer = m_messages[location];
-    while (buffer.begin()->first < minTime) { buffer.pop(); }
+    [[maybe_unused]] size_t oldSize = buffer.size();
+    while (buffer.begin()->first < minTime) {
+        buffer.pop();
+        ++m_statistics.historyPops;
+    }
+    WMM_PROBE(ra_clean_up_history, location, oldSize - buffer.size(),
+              buffer.size());
 }
 
 double ReleaseAcquireStorageManager::minTimestamp(size_t location) const {
@@ -154,6 +204,20 @@ double ReleaseAcquireStorageManager::minTimestamp(size_t location) const {
     return minTimestamp;
 }
 
+std::vector<std::vector<double>>
+ReleaseAcquireStorageManager::liveTimestamps() const {
+    std::vector<std::vector<double>> timestamps(m_viewSize);
+    for (size_t location = 0; location < m_viewSize; ++location) {
+        double minTime = minTimestamp(location);
+        for (const auto &[timestamp, message]: m_messages[location]) {
+            if (timestamp >= minTime) {
+                timestamps[location].push_back(timestamp);
+            }
+        }
+    }
+    return timestamps;
+}
+
 void ReleaseAcquireStorageManager::write(size_t threadId, size_t location,
                                          int32_t value, bool useMinTimestamp,
                                          bool withRelease) {
@@ -179,6 +243,9 @@ void ReleaseAcquireStorageManager::write(size_t threadId, size_t location,
     auto baseView = m_baseViewPerThread[threadId];
     Message message{location, value, newTimestamp, baseView, releaseView};
     m_messages[location].push(message);
+    WMM_PROBE(ra_write, threadId, location, value, withRelease,
+              m_messages[location].size());
+    m_statistics.recordHistoryLength(location, m_messages[location].size());
 }
 
 int32_t ReleaseAcquireStorageManager::load(size_t threadId, size_t address,
@@ -188,6 +255,14 @@ int32_t ReleaseAcquireStorageManager::load(size_t threadId, size_t address,
     return value;
 }
 
+int32_t ReleaseAcquireStorageManager::loadOtherValue(
+        size_t threadId, size_t address, int32_t value,
+        MemoryAccessMode accessMode) {
+    auto result = read(threadId, address, isAcquire(accessMode), false, value);
+    m_storageLogger->load(threadId, address, accessMode, result);
+    return result;
+}
+
 void ReleaseAcquireStorageManager::store(size_t threadId, size_t address,
                                          int32_t value,
                                          MemoryAccessMode accessMode) {
@@ -195,25 +270,64 @@ void ReleaseAcquireStorageManager::store(size_t threadId, size_t address,
     write(threadId, address, value, false, isRelease(accessMode));
 }
 
-void ReleaseAcquireStorageManager::compareAndSwap(size_t threadId,
-                                                  size_t address,
-                                                  int32_t expectedValue,
-                                                  int32_t newValue,
-                                                  MemoryAccessMode accessMode) {
-    int32_t value = read(threadId, address, isAcquire(accessMode), true);
+int32_t ReleaseAcquireStorageManager::compareAndSwap(
+        size_t threadId, size_t address, int32_t expectedValue,
+        int32_t newValue, MemoryAccessMode accessMode) {
+    int32_t value = readBeforeCompareAndSwap(
+            threadId, address, isAcquire(accessMode), expectedValue);
     if (value == expectedValue) {
         write(threadId, address, newValue, true, isRelease(accessMode));
     }
     m_storageLogger->compareAndSwap(threadId, address, expectedValue, value,
                                     newValue, accessMode);
+    return value;
 }
 
-int32_t ReleaseAcquireStorageManager::read(size_t threadId, size_t location,
-                                           bool withAcquire,
-                                           bool isReadBeforeAtomicUpdate) {
+int32_t ReleaseAcquireStorageManager::read(
+        size_t threadId, size_t location, bool withAcquire,
+        bool isReadBeforeAtomicUpdate, std::optional<int32_t> excludedValue) {
     auto messages = availableMessages(threadId, location);
+    if (m_model == Model::SRA && isReadBeforeAtomicUpdate) {
+        // SRA writes go to the end, so an atomic update must read the last
+        // message to stay atomic
+        messages.erase(messages.begin(), messages.end() - 1);
+    }
+    if (excludedValue) {
+        std::erase_if(messages, [&excludedValue](const MessageRef &message) {
+            return message.get().value == excludedValue.value();
+        });
+    }
     auto message = m_internalUpdateManager->chooseMessage(
             messages, isReadBeforeAtomicUpdate);
+    // The number of available messages is the branching of the read
+    WMM_PROBE(ra_read, threadId, location, message.value, withAcquire,
+              messages.size());
+    applyMessage(threadId, message, withAcquire);
+    return message.value;
+}
+
+int32_t ReleaseAcquireStorageManager::readBeforeCompareAndSwap(
+        size_t threadId, size_t location, bool withAcquire,
+        int32_t expectedValue) {
+    auto messages = availableMessages(threadId, location);
+    const Message *last = &messages.back().get();
+    // Messages with the expected value are read by a successful CAS, they
+    // must not be read by another atomic update and under SRA must be last
+    std::erase_if(messages, [&](const MessageRef &message) {
+        return message.get().value == expectedValue &&
+               (message.get().isUsedByAtomicUpdate ||
+                (m_model == Model::SRA && &message.get() != last));
+    });
+    auto message = m_internalUpdateManager->chooseMessage(messages, false);
+    WMM_PROBE(ra_read, threadId, location, message.value, withAcquire,
+              messages.size());
+    if (message.value == expectedValue) {
+        for (auto &candidate: messages) {
+            if (candidate.get().timestamp == message.timestamp) {
+                candidate.get().isUsedByAtomicUpdate = true;
+            }
+        }
+    }
     applyMessage(threadId, message, withAcquire);
     return message.value;
 }
@@ -239,11 +353,110 @@ void ReleaseAcquireStorageManager::writeStorage(
         outputStream << std::format("#{}: {}\n", threadId++, threadView.str());
     }
 }
+std::vector<int32_t> ReleaseAcquireStorageManager::getSharedStorage() const {
+    std::vector<int32_t> storage;
+    storage.reserve(m_storageSize);
+    for (size_t location = 0; location < m_storageSize; ++location) {
+        storage.push_back(m_messages[location].last().value);
+    }
+    return storage;
+}
+
+bool ReleaseAcquireStorageManager::canLoadOtherValue(size_t threadId,
+                                                     size_t address,
+                                                     int32_t value) const {
+    double minTimestamp = m_threadViews.at(threadId)[address];
+    return m_messages.at(address).hasOtherValue(minTimestamp, value);
+}
+
+void ReleaseAcquireStorageManager::reset(unsigned long seed) {
+    for (auto &history: m_messages) { history.clear(); }
+    for (auto &view: m_threadViews) { view.clear(); }
+    for (auto &view: m_baseViewPerThread) { view.clear(); }
+    m_internalUpdateManager->reseed(seed);
+}
+
+size_t ReleaseAcquireStorageManager::hashState() const {
+    StateWriter writer;
+    encodeState(writer);
+    return writer.finish().hash();
+}
+
+void ReleaseAcquireStorageManager::encodeState(StateWriter &writer) const {
+    // Every thread view points at a message that is still in the history,
+    // so the oldest live message of a location has rank 0 and older
+    // timestamps in message views are clamped to it. The counts go first
+    // because a view needs the counts of all locations
+    auto timestamps = liveTimestamps();
+    for (const auto &locationTimestamps: timestamps) {
+        writer.writeSize(locationTimestamps.size());
+    }
+    for (size_t location = 0; location < m_viewSize; ++location) {
+        double minTime = timestamps[location].front();
+        for (const auto &[timestamp, message]: m_messages[location]) {
+            if (timestamp < minTime) { continue; }
+            writer.writeValue(message.value);
+            writer.writeFlag(message.isUsedByAtomicUpdate);
+            message.baseView.encode(writer, timestamps);
+            writer.writeFlag(message.releaseView.has_value());
+            if (message.releaseView) {
+                message.releaseView->encode(writer, timestamps);
+            }
+        }
+    }
+    for (size_t threadId = 0; threadId < m_threadViews.size(); ++threadId) {
+        m_threadViews[threadId].encode(writer, timestamps);
+        m_baseViewPerThread[threadId].encode(writer, timestamps);
+    }
+}
+
+void ReleaseAcquireStorageManager::decodeState(StateReader &reader) {
+    std::vector<size_t> nOfTimestamps(m_viewSize);
+    for (auto &count: nOfTimestamps) { count = reader.readSize(); }
+    for (size_t location = 0; location < m_viewSize; ++location) {
+        auto &history = m_messages[location];
+        history.clear();
+        history.pop();
+        for (size_t rank = 0; rank < nOfTimestamps[location]; ++rank) {
+            int32_t value = reader.readValue();
+            bool isUsedByAtomicUpdate = reader.readFlag();
+            View baseView(m_viewSize);
+            baseView.decode(reader, nOfTimestamps);
+            std::optional<View> releaseView;
+            if (reader.readFlag()) {
+                releaseView.emplace(m_viewSize);
+                releaseView->decode(reader, nOfTimestamps);
+            }
+            history.push({location, value, static_cast<double>(rank),
+                          std::move(baseView), std::move(releaseView),
+                          isUsedByAtomicUpdate});
+        }
+    }
+    for (size_t threadId = 0; threadId < m_threadViews.size(); ++threadId) {
+        m_threadViews[threadId].decode(reader, nOfTimestamps);
+        m_baseViewPerThread[threadId].decode(reader, nOfTimestamps);
+    }
+}
+
+void ReleaseAcquireStorageManager::encodeThreadState(
+        size_t threadId, StateWriter &writer) const {
+    auto timestamps = liveTimestamps();
+    m_threadViews[threadId].encode(writer, timestamps);
+    m_baseViewPerThread[threadId].encode(writer, timestamps);
+}
+
+void ReleaseAcquireStorageManager::permuteThreads(
+        const std::vector<size_t> &order) {
+    util::permute(m_threadViews, order);
+    util::permute(m_baseViewPerThread, order);
+}
+
 void ReleaseAcquireStorageManager::fence(size_t threadId,
                                          MemoryAccessMode accessMode) {
     m_storageLogger->fence(threadId, accessMode);
     if (accessMode == MemoryAccessMode::SequentialConsistency) {
         for (auto &view: m_threadViews) { view |= m_threadViews[threadId]; }
+        m_statistics.viewJoins += m_threadViews.size();
         for (size_t location = 0; location < m_viewSize; ++location) {
             cleanUpHistory(location);
         }
@@ -255,6 +468,22 @@ void ReleaseAcquireStorageManager::fence(size_t threadId,
     }
 }
 
+size_t RandomInternalUpdateManager::chooseIndex(size_t nOfMessages) const {
+    if (m_oldMessageBias == 0) {
+        std::uniform_int_distribution<size_t> distribution(0, nOfMessages - 1);
+        return distribution(m_randomGenerator);
+    }
+    std::vector<double> weights(nOfMessages);
+    double weight = 1;
+    for (auto &elm: weights) {
+        elm = weight;
+        weight *= 1 - m_oldMessageBias;
+    }
+    std::discrete_distribution<size_t> distribution(weights.begin(),
+                                                    weights.end());
+    return distribution(m_randomGenerator);
+}
+
 Message RandomInternalUpdateManager::chooseMessage(
         const std::vector<MessageRef> &messages,
         bool isReadBeforeAtomicUpdate) const {
@@ -262,17 +491,13 @@ Message RandomInternalUpdateManager::chooseMessage(
     if (isReadBeforeAtomicUpdate) {
         size_t messagesNotUsedInAtomicUpdates =
                 countMessagesNotUsedInAtomicUpdates(messages);
-        std::uniform_int_distribution<size_t> distribution(
-                1, messagesNotUsedInAtomicUpdates);
-        size_t pos = distribution(m_randomGenerator);
+        size_t pos = chooseIndex(messagesNotUsedInAtomicUpdates) + 1;
         auto baseMessagePos =
                 findPosOfNthMessageNotUsedInAtomicUpdates(pos, messages);
         messages[baseMessagePos].get().isUsedByAtomicUpdate = true;
         return messages[baseMessagePos].get();
     } else {
-        std::uniform_int_distribution<size_t> distribution(0,
-                                                           messages.size() - 1);
-        return messages[distribution(m_randomGenerator)].get();
+        return messages[chooseIndex(messages.size())].get();
     }
 }
 double RandomInternalUpdateManager::chooseNewTimestamp(
@@ -342,4 +567,37 @@ double InteractiveInternalUpdateManager::chooseNewTimestamp(
     }
     return t;
 }
+
+Message EnumerateInternalUpdateManager::chooseMessage(
+        const std::vector<MessageRef> &messages,
+        bool isReadBeforeAtomicUpdate) const {
+    assert(!messages.empty());
+    if (isReadBeforeAtomicUpdate) {
+        size_t pos = m_choices->choose(
+                             countMessagesNotUsedInAtomicUpdates(messages)) +
+                     1;
+        auto baseMessagePos =
+                findPosOfNthMessageNotUsedInAtomicUpdates(pos, messages);
+        messages[baseMessagePos].get().isUsedByAtomicUpdate = true;
+        return messages[baseMessagePos].get();
+    } else {
+        return messages[m_choices->choose(messages.size())].get();
+    }
+}
+
+double EnumerateInternalUpdateManager::chooseNewTimestamp(
+        const std::vector<MessageRef> &messages) const {
+    assert(!messages.empty());
+    size_t pos =
+            m_choices->choose(countMessagesNotUsedInAtomicUpdates(messages)) +
+            1;
+    auto baseMessagePos =
+            findPosOfNthMessageNotUsedInAtomicUpdates(pos, messages);
+    if (baseMessagePos == messages.size() - 1) {
+        return messages.back().get().timestamp + 1;
+    } else {
+        return middleTimestamp(messages[baseMessagePos].get().timestamp,
+                               messages[baseMessagePos + 1].get().timestamp);
+    }
+}
 } // namespace wmm::storage::RA
\ No newline at end of file
@@ -6,25 +6,11 @@
 #include <sstream>
 
 #include "SequentialConsistencyStorageManager.h"
+#include "Util.h"
 
 namespace wmm::storage::SC {
 
-int32_t SequentialConsistencyStorageManager::load(size_t threadId,
-                                                  size_t address,
-                                                  MemoryAccessMode accessMode) {
-    int32_t result = m_storage.load(address);
-    m_storageLogger->load(threadId, address, accessMode, result);
-    return result;
-}
-
-void SequentialConsistencyStorageManager::store(size_t threadId, size_t address,
-                                                int32_t value,
-                                                MemoryAccessMode accessMode) {
-    m_storageLogger->store(threadId, address, value, accessMode);
-    m_storage.store(address, value);
-}
-
-void SequentialConsistencyStorageManager::compareAndSwap(
+int32_t SequentialConsistencyStorageManager::compareAndSwap(
         size_t threadId, size_t address, int32_t expectedValue,
         int32_t newValue, MemoryAccessMode accessMode) {
     auto value = m_storage.load(address);
@@ -33,6 +19,7 @@ void SequentialConsistencyStorageManager::compareAndSwap(
     if (value == expectedValue) {
         m_storage.store(address, newValue);
     }
+    return value;
 }
 
 void SequentialConsistencyStorageManager::fetchAndIncrement(
@@ -54,5 +41,32 @@ void SequentialConsistencyStorageManager::writeStorage(
     outputStream << "Shared storage: " << m_storage.str() << '\n';
 }
 
+std::vector<int32_t>
+SequentialConsistencyStorageManager::getSharedStorage() const {
+    return m_storage.getStorage();
+}
+
+bool SequentialConsistencyStorageManager::canLoadOtherValue(
+        size_t threadId, size_t address, int32_t value) const {
+    return m_storage.load(address) != value;
+}
+
+size_t SequentialConsistencyStorageManager::hashState() const {
+    return m_storage.hash();
+}
+
+void SequentialConsistencyStorageManager::encodeState(
+        StateWriter &writer) const {
+    m_storage.encode(writer);
+}
+
+void SequentialConsistencyStorageManager::decodeState(StateReader &reader) {
+    m_storage.decode(reader);
+}
+
+void SequentialConsistencyStorageManager::reset(unsigned long seed) {
+    m_storage.clear();
+}
+
 
 } // namespace wmm::storage
\ No newline at end of file
@@ -2,24 +2,31 @@
 // Created by veronika on 20.10.23.
 //
 
+#include <algorithm>
+
 #include "Storage.h"
+#include "Util.h"
 
 namespace wmm::storage {
 
-int32_t Storage::load(size_t address) const {
-    return m_storage.at(address);
+void Storage::clear() { std::fill(m_storage.begin(), m_storage.end(), 0); }
+
+std::vector<int32_t> Storage::getStorage() const  {
+    return m_storage;
 }
 
-size_t Storage::size() const noexcept {
-    return m_storage.size();
+size_t Storage::hash() const {
+    size_t seed = 0;
+    util::hashCombine(seed, m_storage);
+    return seed;
 }
 
-void Storage::store(size_t address, int32_t value) {
-    m_storage.at(address) = value;
+void Storage::encode(StateWriter &writer) const {
+    for (auto value: m_storage) { writer.writeValue(value); }
 }
 
-std::vector<int32_t> Storage::getStorage() const  {
-    return m_storage;
+void Storage::decode(StateReader &reader) {
+    for (auto &value: m_storage) { value = reader.readValue(); }
 }
 
 std::string Storage::str() const {
@@ -31,23 +31,23 @@ void StorageLoggerImpl::info(const std::string &log) {
     }
 }
 
-void StorageLogger::load(size_t threadId, size_t address,
-                         MemoryAccessMode accessMode, int32_t result) {
+void StorageLogger::writeLoad(size_t threadId, size_t address,
+                              MemoryAccessMode accessMode, int32_t result) {
     info(std::format("ACTION: t{}#{}: {} load ({})", threadId, address,
                      toString(accessMode), result));
 };
 
-void StorageLogger::store(size_t threadId, size_t address, int32_t value,
-                          MemoryAccessMode accessMode) {
+void StorageLogger::writeStore(size_t threadId, size_t address,
+                               int32_t value, MemoryAccessMode accessMode) {
     info(std::format("ACTION: t{}#{}: {} store {}", threadId, address,
                      toString(accessMode), value));
 }
 
-void StorageLogger::compareAndSwap(size_t threadId, size_t address,
-                                   int32_t expectedValue,
-                                   std::optional<int32_t> realValue,
-                                   int32_t newValue,
-                                   MemoryAccessMode accessMode) {
+void StorageLogger::writeCompareAndSwap(size_t threadId, size_t address,
+                                        int32_t expectedValue,
+                                        std::optional<int32_t> realValue,
+                                        int32_t newValue,
+                                        MemoryAccessMode accessMode) {
     std::string action = (realValue) ? "ACTION" : "FAILED";
     std::string value = (realValue) ? std::to_string(realValue.value()) : "?";
     info(std::format("{}: t{}#{}: {} if ({})=={} store {}", action, threadId,
@@ -55,16 +55,16 @@ void StorageLogger::compareAndSwap(size_t threadId, size_t address,
                      newValue));
 }
 
-void StorageLogger::fetchAndIncrement(size_t threadId, size_t address,
-                                      int32_t increment,
-                                      MemoryAccessMode accessMode,
-                                      bool failure) {
+void StorageLogger::writeFetchAndIncrement(size_t threadId, size_t address,
+                                           int32_t increment,
+                                           MemoryAccessMode accessMode,
+                                           bool failure) {
     std::string action = (failure) ? "ACTION" : "FAILED";
     info(std::format("{}: t{}#{}: {} +{}", action, threadId, address,
                      toString(accessMode), increment));
 }
 
-void StorageLogger::fence(size_t threadId, MemoryAccessMode accessMode) {
+void StorageLogger::writeFence(size_t threadId, MemoryAccessMode accessMode) {
     info(std::format("ACTION: t{}: {} fence", threadId, toString(accessMode)));
 }
 
@@ -0,0 +1,15 @@
+#include "StorageStatistics.h"
+
+namespace wmm::storage {
+
+void StorageStatistics::merge(const StorageStatistics &other) {
+    recordBufferDepth(other.maxBufferDepth);
+    for (size_t location = 0; location < other.maxHistoryLengths.size();
+         ++location) {
+        recordHistoryLength(location, other.maxHistoryLengths[location]);
+    }
+    historyPops += other.historyPops;
+    viewJoins += other.viewJoins;
+}
+
+} // namespace wmm::storage
@@ -8,26 +8,11 @@
 #include <sstream>
 
 #include "TotalStoreOrderStorageManager.h"
+#include "Util.h"
 
 namespace wmm::storage::TSO {
 
-int32_t TotalStoreOrderStorageManager::load(size_t threadId, size_t address,
-                                            MemoryAccessMode accessMode) {
-    auto valueFromBuffer = m_threadBuffers.at(threadId).find(address);
-    int32_t value = (valueFromBuffer) ? valueFromBuffer.value()
-                                      : m_storage.load(address);
-    m_storageLogger->load(threadId, address, accessMode, value);
-    return value;
-}
-
-void TotalStoreOrderStorageManager::store(size_t threadId, size_t address,
-                                          int32_t value,
-                                          MemoryAccessMode accessMode) {
-    m_storageLogger->store(threadId, address, value, accessMode);
-    m_threadBuffers.at(threadId).push({address, value});
-}
-
-void TotalStoreOrderStorageManager::compareAndSwap(
+int32_t TotalStoreOrderStorageManager::compareAndSwap(
         size_t threadId, size_t address, int32_t expectedValue,
         int32_t newValue, MemoryAccessMode accessMode) {
     flushBuffer(threadId);
@@ -35,6 +20,7 @@ void TotalStoreOrderStorageManager::compareAndSwap(
     m_storageLogger->compareAndSwap(threadId, address, expectedValue, value,
                                     newValue, accessMode);
     if (value == expectedValue) { m_storage.store(address, newValue); }
+    return value;
 }
 
 void TotalStoreOrderStorageManager::flushBuffer(size_t threadId) {
@@ -66,46 +52,91 @@ void TotalStoreOrderStorageManager::writeStorage(
     }
 }
 
-bool TotalStoreOrderStorageManager::propagate(size_t threadId) {
-    auto instruction = m_threadBuffers.at(threadId).pop();
-    if (instruction) {
-        m_storage.store(instruction->address, instruction->value);
-        m_storageLogger->info(std::format("ACTION: b{}: propagate ({})",
-                                          threadId, instruction->str()));
-        return true;
+std::vector<int32_t> TotalStoreOrderStorageManager::getSharedStorage() const {
+    return m_storage.getStorage();
+}
+
+bool TotalStoreOrderStorageManager::canLoadOtherValue(
+        size_t threadId, size_t address, int32_t value) const {
+    auto valueFromBuffer = m_threadBuffers.at(threadId).find(address);
+    return valueFromBuffer.value_or(m_storage.load(address)) != value;
+}
+
+size_t TotalStoreOrderStorageManager::hashState() const {
+    size_t seed = m_storage.hash();
+    for (const auto &buffer: m_threadBuffers) {
+        util::hashCombine(seed, buffer.hash());
+    }
+    return seed;
+}
+
+void TotalStoreOrderStorageManager::encodeState(StateWriter &writer) const {
+    m_storage.encode(writer);
+    for (const auto &buffer: m_threadBuffers) {
+        buffer.encode(writer, m_storage.size());
     }
-    return false;
 }
 
-bool TotalStoreOrderStorageManager::internalUpdate() {
-    m_internalUpdateManager->reset(*this);
-    while (auto threadId = m_internalUpdateManager->getThreadId()) {
-        if (propagate(threadId.value())) { return true; }
+void TotalStoreOrderStorageManager::decodeState(StateReader &reader) {
+    m_storage.decode(reader);
+    for (auto &buffer: m_threadBuffers) {
+        buffer.decode(reader, m_storage.size());
     }
-    return false;
 }
 
-std::optional<StoreInstruction> Buffer::pop() {
-    if (m_buffer.empty()) { return {}; }
-    auto returnValue = m_buffer.front();
-    m_buffer.pop_front();
-    return returnValue;
+void TotalStoreOrderStorageManager::encodeThreadState(
+        size_t threadId, StateWriter &writer) const {
+    m_threadBuffers[threadId].encode(writer, m_storage.size());
 }
 
-std::optional<int32_t> Buffer::find(size_t address) {
-    auto elm = std::find_if(m_buffer.rbegin(), m_buffer.rend(),
-                            [address](auto instruction) {
-                                return instruction.address == address;
-                            });
-    if (elm == m_buffer.rend()) { return {}; }
-    return elm->value;
+void TotalStoreOrderStorageManager::permuteThreads(
+        const std::vector<size_t> &order) {
+    util::permute(m_threadBuffers, order);
 }
 
-void Buffer::push(StoreInstruction instruction) {
-    m_buffer.push_back(instruction);
+void TotalStoreOrderStorageManager::reset(unsigned long seed) {
+    m_storage.clear();
+    for (auto &buffer: m_threadBuffers) { buffer.clear(); }
+    m_internalUpdateManager->reseed(seed);
 }
 
-bool Buffer::empty() const { return m_buffer.empty(); }
+void TotalStoreOrderStorageManager::logPropagate(
+        size_t threadId, const StoreInstruction &instruction) {
+    m_storageLogger->info(std::format("ACTION: b{}: propagate ({})", threadId,
+                                      instruction.str()));
+}
+
+size_t TotalStoreOrderStorageManager::countPendingInternalUpdates() const {
+    size_t count = 0;
+    for (const auto &buffer: m_threadBuffers) { count += buffer.size(); }
+    return count;
+}
+
+void Buffer::encode(StateWriter &writer, size_t storageSize) const {
+    writer.writeSize(m_buffer.size());
+    for (const auto &instruction: m_buffer) {
+        writer.writeIndex(instruction.address, storageSize);
+        writer.writeValue(instruction.value);
+    }
+}
+
+void Buffer::decode(StateReader &reader, size_t storageSize) {
+    m_buffer.clear();
+    size_t size = reader.readSize();
+    for (size_t i = 0; i < size; ++i) {
+        size_t address = reader.readIndex(storageSize);
+        m_buffer.push_back({address, reader.readValue()});
+    }
+}
+
+size_t Buffer::hash() const {
+    size_t seed = m_buffer.size();
+    for (const auto &instruction: m_buffer) {
+        util::hashCombine(seed, instruction.address);
+        util::hashCombine(seed, instruction.value);
+    }
+    return seed;
+}
 
 std::string Buffer::str() const {
     std::string result;
@@ -129,21 +160,6 @@ std::optional<size_t> SequentialInternalUpdateManager::getThreadId() {
     return {};
 }
 
-void RandomInternalUpdateManager::reset(
-        const TotalStoreOrderStorageManager &storageManager) {
-    m_threadIds.resize(storageManager.m_threadBuffers.size());
-    for (int i = 0; i < m_threadIds.size(); ++i) { m_threadIds[i] = i; }
-    std::shuffle(m_threadIds.begin(), m_threadIds.end(), m_randomGenerator);
-    m_nextThreadIdIndex = 0;
-}
-
-std::optional<size_t> RandomInternalUpdateManager::getThreadId() {
-    if (m_nextThreadIdIndex < m_threadIds.size()) {
-        return m_threadIds[m_nextThreadIdIndex++];
-    }
-    return {};
-}
-
 std::optional<size_t> InteractiveInternalUpdateManager::getThreadId() {
     if (m_threadIds.empty()) {
         std::cout << "All buffers are empty.\n";
@@ -0,0 +1,129 @@
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BatchRunner.h"
+#include "CommandLine.h"
+#include "Parser.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using wmm::util::startsWith;
+
+static std::vector<MemoryModel> parseMemoryModels(const std::string &models) {
+    std::vector<MemoryModel> result;
+    std::stringstream stream(models);
+    std::string model;
+    while (std::getline(stream, model, ',')) {
+        result.push_back(parseMemoryModel(model));
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    PhaseTimer timer;
+    timer.start("parse");
+    // Outlives the writer in the config
+    std::ofstream recordsStream;
+    BatchRunner::Config config;
+    bool printOutcomes = false;
+    std::optional<std::string> statsFormat;
+    std::optional<std::string> recordsPath;
+    RecordFormat recordFormat = RecordFormat::JsonLines;
+    std::vector<LitmusTest> tests;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+        if (startsWith(arg, "--models=")) {
+            config.models = parseMemoryModels(value);
+        } else if (startsWith(arg, "--runs=")) {
+            config.runsPerModel = std::stoul(value);
+        } else if (startsWith(arg, "--jobs=")) {
+            config.nOfWorkers = std::stoul(value);
+        } else if (startsWith(arg, "--seed=")) {
+            config.seed = std::stoul(value);
+        } else if (startsWith(arg, "--max-steps=")) {
+            config.maxSteps = std::stoul(value);
+        } else if (startsWith(arg, "--livelock-steps=")) {
+            config.livelockSteps = std::stoul(value);
+        } else if (startsWith(arg, "--scheduler=")) {
+            config.mode = parseExecutionMode(value);
+        } else if (startsWith(arg, "--flush-probability=")) {
+            config.scheduling.flushProbability = std::stod(value);
+        } else if (startsWith(arg, "--old-message-bias=")) {
+            config.scheduling.oldMessageBias = std::stod(value);
+        } else if (startsWith(arg, "--pct-depth=")) {
+            config.scheduling.pctDepth = std::stoul(value);
+        } else if (startsWith(arg, "--pct-steps=")) {
+            config.scheduling.pctExpectedSteps = std::stoul(value);
+        } else if (startsWith(arg, "--lockstep=")) {
+            config.lockstepLanes = std::stoul(value);
+        } else if (startsWith(arg, "--records=")) {
+            recordsPath = value;
+        } else if (startsWith(arg, "--record-format=")) {
+            try {
+                recordFormat = parseRecordFormat(value);
+            } catch (const std::exception &e) {
+                std::cerr << e.what() << '\n';
+                return 1;
+            }
+        } else if (arg == "--record-outcomes") {
+            config.recordOutcomes = true;
+        } else if (arg == "--outcomes") {
+            printOutcomes = true;
+        } else if (arg == "--stats") {
+            statsFormat = "text";
+        } else if (startsWith(arg, "--stats=")) {
+            statsFormat = value;
+        } else if (startsWith(arg, "--")) {
+            std::cerr << "Unknown option: " << arg << '\n';
+            return 1;
+        } else {
+            try {
+                tests.push_back({arg, Parser::parseFromFile(arg)});
+            } catch (const std::exception &e) {
+                std::cerr << arg << ": " << e.what() << '\n';
+            }
+        }
+    }
+
+    if (statsFormat && statsFormat != "text" && statsFormat != "json") {
+        std::cerr << "Unknown statistics format: " << *statsFormat << '\n';
+        return 1;
+    }
+    if (config.mode != ExecutionMode::Random &&
+        config.mode != ExecutionMode::Pct) {
+        std::cerr << "Only rand and pct schedulers are supported\n";
+        return 1;
+    }
+
+    if (recordsPath) {
+        recordsStream.open(*recordsPath);
+        if (!recordsStream) {
+            std::cerr << "Can't open " << *recordsPath << '\n';
+            return 1;
+        }
+        config.records =
+                std::make_shared<RecordWriter>(recordsStream, recordFormat);
+    }
+
+    timer.start("execute");
+    BatchResult result = BatchRunner(config).run(tests);
+    timer.start("output");
+    result.writeMatrix(std::cout);
+    if (printOutcomes) { result.writeOutcomes(std::cout); }
+    timer.stop();
+
+    if (statsFormat) {
+        auto report = result.getStatisticsReport();
+        report.phaseSeconds = timer.getSeconds();
+        if (statsFormat == "json") {
+            report.writeJson(std::cout);
+        } else {
+            report.write(std::cout);
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BinaryFormat.h"
+#include "CommandLine.h"
+#include "Parser.h"
+
+using namespace wmm::program;
+using wmm::util::startsWith;
+
+int main(int argc, char *argv[]) {
+    std::string outputDirectory;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (startsWith(arg, "--output=")) {
+            outputDirectory = arg.substr(arg.find('=') + 1);
+        } else if (startsWith(arg, "--")) {
+            std::cerr << "Unknown option: " << arg << '\n';
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    int exitCode = 0;
+    for (const auto &input: inputs) {
+        try {
+            auto programs = Parser::parseFromFile(input);
+            std::filesystem::path path(input);
+            path.replace_extension(BinaryFormat::EXTENSION);
+            if (!outputDirectory.empty()) {
+                std::filesystem::create_directories(outputDirectory);
+                path = std::filesystem::path(outputDirectory) /
+                       path.filename();
+            }
+            std::ofstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                throw std::runtime_error("Couldn't open file " +
+                                         path.string());
+            }
+            BinaryFormat::write(programs, file);
+        } catch (const std::exception &e) {
+            std::cerr << input << ": " << e.what() << '\n';
+            exitCode = 1;
+        }
+    }
+    return exitCode;
+}
@@ -0,0 +1,74 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "CommandLine.h"
+#include "DifferentialChecker.h"
+#include "Generator.h"
+#include "Parser.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using wmm::util::startsWith;
+
+int main(int argc, char *argv[]) {
+    DifferentialChecker::Config config;
+    config.sampling.runsPerModel = 200;
+    config.exploration.maxPreemptions = 4;
+    config.exploration.maxDelays = 4;
+    config.exploration.maxExecutionsPerRound = 100000;
+    Generator::Config generatorConfig;
+    size_t nOfGenerated = 0;
+    unsigned long seed = 0;
+    std::vector<LitmusTest> tests;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+        if (startsWith(arg, "--runs=")) {
+            config.sampling.runsPerModel = std::stoul(value);
+        } else if (startsWith(arg, "--jobs=")) {
+            config.nOfWorkers = std::stoul(value);
+        } else if (startsWith(arg, "--seed=")) {
+            seed = std::stoul(value);
+        } else if (startsWith(arg, "--max-preemptions=")) {
+            config.exploration.maxPreemptions = std::stoul(value);
+        } else if (startsWith(arg, "--max-delays=")) {
+            config.exploration.maxDelays = std::stoul(value);
+        } else if (startsWith(arg, "--max-executions=")) {
+            config.exploration.maxExecutionsPerRound = std::stoul(value);
+        } else if (startsWith(arg, "--generate=")) {
+            nOfGenerated = std::stoul(value);
+        } else if (startsWith(arg, "--threads=")) {
+            generatorConfig.nOfThreads = std::stoul(value);
+        } else if (startsWith(arg, "--length=")) {
+            generatorConfig.programLength = std::stoul(value);
+        } else if (startsWith(arg, "--loops=")) {
+            generatorConfig.loopDensity = std::stod(value);
+        } else if (startsWith(arg, "--")) {
+            std::cerr << "Unknown option: " << arg << '\n';
+            return 1;
+        } else {
+            try {
+                tests.push_back({arg, Parser::parseFromFile(arg)});
+            } catch (const std::exception &e) {
+                std::cerr << arg << ": " << e.what() << '\n';
+            }
+        }
+    }
+    config.sampling.seed = seed;
+
+    try {
+        Generator generator(generatorConfig, seed);
+        for (size_t i = 0; i < nOfGenerated; ++i) {
+            tests.push_back({"generated #" + std::to_string(i),
+                             generator.generate()});
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    auto result = DifferentialChecker(config).check(tests);
+    result.write(std::cout);
+    return result.violations.empty() ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "CommandLine.h"
+#include "Generator.h"
+#include "Parser.h"
+
+using namespace wmm::program;
+using wmm::util::startsWith;
+
+// e.g. "RLX:4,SEQ_CST:1", the modes that are not listed get weight 0
+static std::array<double, 5> parseModeWeights(const std::string &weights) {
+    std::array<double, 5> result = {};
+    std::stringstream stream(weights);
+    std::string weight;
+    while (std::getline(stream, weight, ',')) {
+        auto separator = weight.find(':');
+        auto mode = STRING_TO_MODE.at(weight.substr(0, separator));
+        result[static_cast<size_t>(mode)] =
+                (separator == std::string::npos)
+                        ? 1
+                        : std::stod(weight.substr(separator + 1));
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    Generator::Config config;
+    unsigned long seed = 0;
+    size_t count = 1;
+    std::string outputDirectory;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+        try {
+            if (startsWith(arg, "--threads=")) {
+                config.nOfThreads = std::stoul(value);
+            } else if (startsWith(arg, "--length=")) {
+                config.programLength = std::stoul(value);
+            } else if (startsWith(arg, "--addresses=")) {
+                config.nOfAddresses = std::stoul(value);
+            } else if (startsWith(arg, "--registers=")) {
+                config.nOfRegisters = std::stoul(value);
+            } else if (startsWith(arg, "--modes=")) {
+                config.modeWeights = parseModeWeights(value);
+            } else if (startsWith(arg, "--loops=")) {
+                config.loopDensity = std::stod(value);
+            } else if (startsWith(arg, "--seed=")) {
+                seed = std::stoul(value);
+            } else if (startsWith(arg, "--count=")) {
+                count = std::stoul(value);
+            } else if (startsWith(arg, "--output=")) {
+                outputDirectory = value;
+            } else {
+                std::cerr << "Unknown option: " << arg << '\n';
+                return 1;
+            }
+        } catch (const std::exception &) {
+            std::cerr << "Invalid value: " << arg << '\n';
+            return 1;
+        }
+    }
+    if (outputDirectory.empty() && count != 1) {
+        std::cerr << "Several programs need an --output directory\n";
+        return 1;
+    }
+
+    try {
+        Generator generator(config, seed);
+        if (outputDirectory.empty()) {
+            Parser::writeToStream(generator.generate(), std::cout);
+            return 0;
+        }
+        std::filesystem::create_directories(outputDirectory);
+        for (size_t i = 0; i < count; ++i) {
+            auto path = std::filesystem::path(outputDirectory) /
+                        ("gen_" + std::to_string(i) + ".wmm");
+            std::ofstream file(path);
+            Parser::writeToStream(generator.generate(), file);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
@@ -2,160 +2,179 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <random>
 #include <string>
 #include <vector>
 
+#include "BoundedExplorer.h"
+#include "BreadthFirstExplorer.h"
+#include "CommandLine.h"
 #include "Executor.h"
+#include "ExecutorFactory.h"
 #include "Parser.h"
-#include "PartialStoreOrderStorageManager.h"
 #include "Program.h"
-#include "SequentialConsistencyStorageManager.h"
-#include "TotalStoreOrderStorageManager.h"
-#include "ReleaseAcquireStorageManager.h"
+#include "RecordWriter.h"
+#include "Watchdog.h"
 
 using namespace wmm::execution;
 using namespace wmm::program;
 using namespace wmm::storage;
+using wmm::util::startsWith;
 
-#define INIT_INTERNAL_UPDATE_MANAGER(var_name, namespace_name)                 \
-    {                                                                          \
-        using namespace namespace_name;                                        \
-        switch (mode) {                                                        \
-            case ExecutionMode::Random: {                                      \
-                std::random_device seedGen;                                    \
-                (var_name) = std::make_unique<RandomInternalUpdateManager>(    \
-                        seedGen());                                            \
-                break;                                                         \
-            }                                                                  \
-            case ExecutionMode::Interactive:                                   \
-                (var_name) =                                                   \
-                        std::make_unique<InteractiveInternalUpdateManager>();  \
-                break;                                                         \
-            case ExecutionMode::Enumerate:                                     \
-                throw std::runtime_error(                                      \
-                        "Enumerate execution is not supported");               \
-                break;                                                         \
-        }                                                                      \
-    }
-
-std::ifstream openFile(const std::string &filename) {
-    std::ifstream filestream(filename, std::ifstream::in);
-    if (!filestream.is_open()) {
-        throw std::runtime_error(std::format("Couldn't open file ", filename));
-    }
-    return filestream;
-}
-
-enum class MemoryModel { TSO, PSO, SC, RA, SRA };
-
-MemoryModel parseMemoryModel(const std::string &model) {
-    if (model == "tso") {
-        return MemoryModel::TSO;
-    } else if (model == "pso") {
-        return MemoryModel::PSO;
-    } else if (model == "sc") {
-        return MemoryModel::SC;
-    } else if (model == "ra") {
-        return MemoryModel::RA;
-    } else if (model == "sra") {
-        return MemoryModel::SRA;
+static void writeStatistics(const std::optional<std::string> &format,
+                            const std::string &label,
+                            const ExecutionStatistics &statistics,
+                            PhaseTimer &timer) {
+    timer.stop();
+    if (!format) { return; }
+    StatisticsReport report{{{label, statistics}}, timer.getSeconds()};
+    if (format == "json") {
+        report.writeJson(std::cout);
     } else {
-        throw std::runtime_error("Unknown memory model: " + model);
+        report.write(std::cout);
     }
 }
 
-enum class ExecutionMode { Random, Interactive, Enumerate };
-
-ExecutionMode parseExecutionMode(const std::string &mode) {
-    if (mode == "rand") {
-        return ExecutionMode::Random;
-    } else if (mode == "interact") {
-        return ExecutionMode::Interactive;
-    } else if (mode == "enum") {
-        return ExecutionMode::Enumerate;
-    } else {
-        throw std::runtime_error("Unknown execution mode: " + mode);
+int main(int argc, char *argv[]) {
+    // Optional arguments after the positional ones
+    std::optional<std::string> statsFormat;
+    std::optional<std::string> frontierDirectory;
+    std::optional<std::string> recordsPath;
+    std::optional<std::string> recordFormat;
+    Watchdog::Config watchdogConfig;
+    bool hasWatchdogOptions = false;
+    for (int i = 5; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (startsWith(arg, "--frontier=")) {
+            frontierDirectory = arg.substr(arg.find('=') + 1);
+        } else if (startsWith(arg, "--records=")) {
+            recordsPath = arg.substr(arg.find('=') + 1);
+        } else if (startsWith(arg, "--record-format=")) {
+            recordFormat = arg.substr(arg.find('=') + 1);
+        } else if (startsWith(arg, "--max-steps=")) {
+            watchdogConfig.maxSteps = std::stoul(arg.substr(arg.find('=') + 1));
+            hasWatchdogOptions = true;
+        } else if (startsWith(arg, "--livelock-steps=")) {
+            watchdogConfig.livelockSteps =
+                    std::stoul(arg.substr(arg.find('=') + 1));
+            hasWatchdogOptions = true;
+        } else if (arg == "--stats" || arg == "--stats=text") {
+            statsFormat = "text";
+        } else if (arg == "--stats=json") {
+            statsFormat = "json";
+        } else {
+            std::cerr << "Unknown option: " << arg << '\n';
+            return 1;
+        }
     }
-}
 
-
-int main(int argc, char *argv[]) {
-    std::ifstream filestream = openFile(argv[1]);
-    std::vector<Program> programs = Parser::parseFromStream(filestream);
+    PhaseTimer timer;
+    timer.start("parse");
+    std::vector<Program> programs = Parser::parseFromFile(argv[1]);
     MemoryModel model = parseMemoryModel(argv[2]);
     ExecutionMode mode = parseExecutionMode(argv[3]);
     LogLevel log = static_cast<LogLevel>(std::stoi(argv[4]));
     LoggerPtr logger(new StorageLoggerImpl(std::cout, log));
 
-    StorageManagerPtr storageManager;
-    switch (model) {
-        case MemoryModel::TSO: {
-            TSO::InternalUpdateManagerPtr internalUpdateManager;
-            INIT_INTERNAL_UPDATE_MANAGER(internalUpdateManager, TSO)
-            storageManager =
-                    std::make_unique<TSO::TotalStoreOrderStorageManager>(
-                            10, programs.size(),
-                            std::move(internalUpdateManager),
-                            std::move(logger));
-            break;
+    // Only the bounded enumeration produces executions to record
+    if ((recordsPath || recordFormat) &&
+        (mode != ExecutionMode::Enumerate || frontierDirectory)) {
+        std::cerr << "--records and --record-format need the enum mode "
+                     "without --frontier\n";
+        return 1;
+    }
+    // Only the random runs are watched
+    if (hasWatchdogOptions && mode != ExecutionMode::Random &&
+        mode != ExecutionMode::Pct) {
+        std::cerr << "--max-steps and --livelock-steps need the rand or pct "
+                     "mode\n";
+        return 1;
+    }
+
+    if (mode == ExecutionMode::Enumerate && frontierDirectory) {
+        timer.start("execute");
+        BreadthFirstExplorer::Config config;
+        config.directory = *frontierDirectory;
+        auto result = BreadthFirstExplorer(config).explore(programs, model);
+        timer.start("output");
+        std::cout << std::format(
+                "{} states on {} levels, exploration is {}exhaustive, {} "
+                "truncated, {} deadlocked and {} failed executions\n",
+                result.states, result.levels.size(),
+                result.isExhaustive ? "" : "not ", result.truncatedExecutions,
+                result.deadlockedExecutions, result.failedExecutions);
+        for (const auto &outcome: result.outcomes) {
+            std::cout << outcome.str() << '\n';
         }
-        case MemoryModel::PSO: {
-            PSO::InternalUpdateManagerPtr internalUpdateManager;
-            INIT_INTERNAL_UPDATE_MANAGER(internalUpdateManager, PSO)
-            storageManager =
-                    std::make_unique<PSO::PartialStoreOrderStorageManager>(
-                            10, programs.size(),
-                            std::move(internalUpdateManager),
-                            std::move(logger));
-            break;
+        writeStatistics(statsFormat, toString(model), result.statistics,
+                        timer);
+        return 0;
+    }
+
+    if (mode == ExecutionMode::Enumerate) {
+        // Outlives the writer in the config
+        std::ofstream recordsStream;
+        BoundedExplorer::Config config;
+        config.nOfWorkers = 0;
+        if (recordsPath) {
+            recordsStream.open(*recordsPath);
+            if (!recordsStream) {
+                std::cerr << "Can't open " << *recordsPath << '\n';
+                return 1;
+            }
+            config.records = std::make_shared<RecordWriter>(
+                    recordsStream,
+                    parseRecordFormat(recordFormat.value_or("jsonl")));
+            config.recordName = argv[1];
         }
-        case MemoryModel::SC:
-            storageManager =
-                    std::make_unique<SC::SequentialConsistencyStorageManager>(
-                            10, std::move(logger));
-            break;
-        case MemoryModel::RA: {
-            RA::InternalUpdateManagerPtr internalUpdateManager;
-            INIT_INTERNAL_UPDATE_MANAGER(internalUpdateManager, RA)
-            storageManager = std::make_unique<RA::ReleaseAcquireStorageManager>(
-                    10, programs.size(), RA::Model::RA,
-                    std::move(internalUpdateManager), std::move(logger));
-            break;
+        timer.start("execute");
+        auto result = BoundedExplorer(config).explore(programs, model);
+        timer.start("output");
+        for (const auto &round: result.rounds) {
+            std::cout << std::format(
+                    "Bound (preemptions: {}, delays: {}): {} executions, {} "
+                    "new outcomes\n",
+                    round.bound.preemptions, round.bound.delays,
+                    round.executions, round.newOutcomes);
         }
-        case MemoryModel::SRA: {
-            RA::InternalUpdateManagerPtr internalUpdateManager;
-            INIT_INTERNAL_UPDATE_MANAGER(internalUpdateManager, RA)
-            storageManager =
-                    std::make_unique<RA::ReleaseAcquireStorageManager>(
-                            10, programs.size(), RA::Model::SRA,
-                            std::move(internalUpdateManager),
-                            std::move(logger));
-            break;
+        std::cout << std::format("Exploration is {}exhaustive, {} truncated, "
+                                 "{} deadlocked and {} failed executions\n",
+                                 result.isExhaustive ? "" : "not ",
+                                 result.truncatedExecutions,
+                                 result.deadlockedExecutions,
+                                 result.failedExecutions);
+        for (const auto &outcome: result.outcomes) {
+            std::cout << outcome.str() << '\n';
         }
+        writeStatistics(statsFormat, toString(model), result.statistics,
+                        timer);
+        return 0;
     }
 
-    ExecutorPtr executor;
-    switch (mode) {
-        case ExecutionMode::Random: {
-            std::random_device seedGen;
-            executor = std::make_unique<RandomExecutor>(
-                    programs, storageManager, 10, seedGen());
-            break;
-        }
-        case ExecutionMode::Interactive:
-            executor = std::make_unique<InteractiveExecutor>(
-                    programs, storageManager, 10);
-            break;
-        case ExecutionMode::Enumerate:
-            throw std::runtime_error("Enumerate execution is not implemented");
-    }
+    timer.start("setup");
+    std::random_device seedGen;
+    StorageManagerPtr storageManager = makeStorageManager(
+            model, mode, 10, programs.size(), seedGen(), std::move(logger));
+    ExecutorPtr executor =
+            makeExecutor(mode, programs, storageManager, 10, seedGen());
 
-    while (executor->execute()) {
-        if (log >= LogLevel::EXTRA_INFO) {
-            executor->writeState(std::cout);
-        }
+    auto onStep = [&]() {
+        if (log >= LogLevel::EXTRA_INFO) { executor->writeState(std::cout); }
+    };
+    timer.start("execute");
+    ExecutionReport report;
+    if (mode == ExecutionMode::Interactive) {
+        while (executor->execute()) { onStep(); }
+    } else {
+        report = Watchdog(watchdogConfig).run(*executor, onStep);
     }
-    if (log < LogLevel::EXTRA_INFO) {
-        executor->writeState(std::cout);
+    timer.start("output");
+    if (log < LogLevel::EXTRA_INFO) { executor->writeState(std::cout); }
+    if (report.status != ExecutionStatus::Completed) {
+        std::cout << std::format("Execution was abandoned after {} steps: {}\n",
+                                 report.steps, toString(report.status));
     }
+    writeStatistics(statsFormat, toString(model), executor->getStatistics(),
+                    timer);
 }
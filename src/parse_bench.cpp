@@ -0,0 +1,100 @@
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BinaryFormat.h"
+#include "CommandLine.h"
+#include "Generator.h"
+#include "Parser.h"
+
+using namespace wmm::program;
+using wmm::util::startsWith;
+
+template<typename Load>
+static void measure(const std::string &name, size_t repetitions,
+                    size_t fileSize, Load load) {
+    size_t nOfInstructions = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repetitions; ++i) {
+        for (const auto &program: load()) {
+            nOfInstructions += program.size();
+        }
+    }
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+    std::cout << std::format(
+            "{}: {:.3f} s, {:.1f} MB/s, {:.2f} M instructions/s\n", name,
+            seconds, repetitions * fileSize / seconds / 1e6,
+            nOfInstructions / seconds / 1e6);
+}
+
+int main(int argc, char *argv[]) {
+    Generator::Config config;
+    config.nOfThreads = 4;
+    config.programLength = 200000;
+    size_t repetitions = 5;
+    unsigned long seed = 0;
+    std::string path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string value = arg.substr(arg.find('=') + 1);
+        if (startsWith(arg, "--threads=")) {
+            config.nOfThreads = std::stoul(value);
+        } else if (startsWith(arg, "--length=")) {
+            config.programLength = std::stoul(value);
+        } else if (startsWith(arg, "--repetitions=")) {
+            repetitions = std::stoul(value);
+        } else if (startsWith(arg, "--seed=")) {
+            seed = std::stoul(value);
+        } else if (startsWith(arg, "--")) {
+            std::cerr << "Unknown option: " << arg << '\n';
+            return 1;
+        } else {
+            path = arg;
+        }
+    }
+
+    try {
+        bool isGenerated = path.empty();
+        if (isGenerated) {
+            path = (std::filesystem::temp_directory_path() /
+                    std::format("parse_bench_{}.wmm", seed))
+                           .string();
+            std::ofstream file(path);
+            Parser::writeToStream(Generator(config, seed).generate(), file);
+        }
+        size_t fileSize = std::filesystem::file_size(path);
+        std::cout << std::format("{}: {:.1f} MB\n", path, fileSize / 1e6);
+
+        measure("stream", repetitions, fileSize, [&]() {
+            std::ifstream file(path);
+            return Parser::parseFromStream(file);
+        });
+        measure("mapped", repetitions, fileSize,
+                [&]() { return Parser::parseFromFile(path); });
+
+        // Loading the compiled programs, the throughput is given relative
+        // to the size of the text
+        auto binaryPath =
+                std::filesystem::temp_directory_path() /
+                std::format("parse_bench_{}{}", seed, BinaryFormat::EXTENSION);
+        {
+            std::ofstream file(binaryPath, std::ios::binary);
+            BinaryFormat::write(Parser::parseFromFile(path), file);
+        }
+        measure("compiled", repetitions, fileSize, [&]() {
+            return Parser::parseFromFile(binaryPath.string());
+        });
+        std::filesystem::remove(binaryPath);
+
+        if (isGenerated) { std::filesystem::remove(path); }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,67 @@
+#include "BatchRunner.h"
+#include "Parser.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::test;
+
+namespace {
+bool bothLoadsReadZero(const Outcome &outcome) {
+    return outcome.threadLocalStorages[0][0] == 0 &&
+           outcome.threadLocalStorages[1][0] == 0;
+}
+} // namespace
+
+TEST_SUITE("Batch runner") {
+    TEST_CASE("Store buffering") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)}};
+        BatchRunner::Config config;
+        config.models = {MemoryModel::SC, MemoryModel::TSO};
+        config.runsPerModel = 500;
+        config.nOfWorkers = 2;
+        auto result = BatchRunner(config).run(tests);
+
+        REQUIRE_EQ(result.cells.size(), 1);
+        const auto &sc = result.cells[0][0];
+        const auto &tso = result.cells[0][1];
+        CHECK_EQ(sc.completedRuns, 500);
+        CHECK_EQ(tso.completedRuns, 500);
+        CHECK(std::none_of(sc.outcomes.begin(), sc.outcomes.end(),
+                           bothLoadsReadZero));
+        CHECK(std::any_of(tso.outcomes.begin(), tso.outcomes.end(),
+                          bothLoadsReadZero));
+        for (const auto &outcome: sc.outcomes) {
+            CHECK_EQ(tso.outcomes.count(outcome), 1);
+        }
+    }
+
+    TEST_CASE("Result doesn't depend on the number of workers") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)}};
+        BatchRunner::Config config;
+        config.runsPerModel = 200;
+        config.nOfWorkers = 1;
+        auto sequential = BatchRunner(config).run(tests);
+        config.nOfWorkers = 4;
+        auto parallel = BatchRunner(config).run(tests);
+        for (size_t model = 0; model < config.models.size(); ++model) {
+            CHECK_EQ(sequential.cells[0][model].outcomes,
+                     parallel.cells[0][model].outcomes);
+        }
+    }
+
+    TEST_CASE("Runs over the step limit are truncated") {
+        std::vector<LitmusTest> tests = {
+                {"loop", Parser::parseFromString("1 = 1\n1: if 1 goto 1\n")}};
+        BatchRunner::Config config;
+        config.models = {MemoryModel::SC};
+        config.runsPerModel = 3;
+        config.maxSteps = 100;
+        auto result = BatchRunner(config).run(tests);
+        CHECK_EQ(result.cells[0][0].truncatedRuns, 3);
+        CHECK(result.cells[0][0].outcomes.empty());
+    }
+}
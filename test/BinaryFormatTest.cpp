@@ -0,0 +1,105 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "BinaryFormat.h"
+#include "Generator.h"
+#include "Parser.h"
+#include "doctest.h"
+
+using namespace wmm::program;
+
+namespace {
+std::string toText(const std::vector<Program> &programs) {
+    std::stringstream stream;
+    Parser::writeToStream(programs, stream);
+    return stream.str();
+}
+
+std::string toBinary(const std::vector<Program> &programs) {
+    std::stringstream stream;
+    BinaryFormat::write(programs, stream);
+    return stream.str();
+}
+} // namespace
+
+TEST_SUITE("Binary format") {
+    TEST_CASE("Compiled programs are read back unchanged") {
+        std::vector<Program> programs;
+        SUBCASE("Every instruction") {
+            programs = Parser::parseFromString(R"(MAKETHREAD
+1 = -7
+2 = 1 * 3
+3 = 1 / 3
+1:
+load SEQ_CST #1 2
+store REL #1 2
+cas ACQ #1 2 3
+cas RLX #1 2 3 4
+fai REL_ACQ #1 2
+fence RLX
+if 2 goto 1
+MAKETHREAD
+5:
+4 = 4 - 0
+if 4 goto 5
+7:
+)");
+        }
+        SUBCASE("Generated") {
+            Generator::Config config;
+            config.nOfThreads = 4;
+            config.programLength = 300;
+            programs = Generator(config, 11).generate();
+        }
+        auto binary = toBinary(programs);
+        CHECK(BinaryFormat::isBinary(binary));
+        auto loaded = BinaryFormat::read(binary);
+        REQUIRE_EQ(loaded.size(), programs.size());
+        CHECK_EQ(toText(loaded), toText(programs));
+        for (size_t i = 0; i < programs.size(); ++i) {
+            CHECK_EQ(loaded[i].getLabels(), programs[i].getLabels());
+        }
+    }
+
+    TEST_CASE("Text programs are not compiled programs") {
+        CHECK_FALSE(BinaryFormat::isBinary("MAKETHREAD\n1 = 1\n"));
+        CHECK_THROWS_WITH(BinaryFormat::read("1 = 1\n"),
+                          "Not a compiled program");
+    }
+
+    TEST_CASE("Damaged compiled programs are rejected") {
+        auto binary = toBinary(Parser::parseFromString("1 = 1\nfence RLX\n"));
+        SUBCASE("Truncated") {
+            CHECK_THROWS_WITH(
+                    BinaryFormat::read(binary.substr(0, binary.size() - 1)),
+                    "Truncated compiled program");
+        }
+        SUBCASE("Other version") {
+            binary[4] = 99;
+            CHECK_THROWS_WITH(BinaryFormat::read(binary),
+                              "Unsupported compiled program version 99");
+        }
+    }
+
+    TEST_CASE("Version 1 files are read") {
+        auto programs = Parser::parseFromString("1 = 1\ncas RLX #1 0 1\n");
+        auto binary = toBinary(programs);
+        binary[4] = 1;
+        CHECK_EQ(toText(BinaryFormat::read(binary)), toText(programs));
+    }
+
+    TEST_CASE("Parser loads compiled files") {
+        auto programs = Parser::parseFromString("MAKETHREAD\n1 = 1\n"
+                                                "MAKETHREAD\nfence RLX\n");
+        auto path = std::filesystem::temp_directory_path() /
+                    "wmm_binary_format_test.wmmb";
+        {
+            std::ofstream file(path, std::ios::binary);
+            BinaryFormat::write(programs, file);
+        }
+        auto loaded = Parser::parseFromFile(path.string());
+        std::filesystem::remove(path);
+        CHECK_EQ(toText(loaded), toText(programs));
+    }
+}
@@ -0,0 +1,124 @@
+#include "BoundedExplorer.h"
+#include "ChoiceSequence.h"
+#include "Generator.h"
+#include "Parser.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using wmm::storage::ChoiceSequence;
+using namespace wmm::test;
+
+TEST_SUITE("Bounded explorer") {
+    TEST_CASE("Choice sequence enumerates all combinations") {
+        ChoiceSequence choices;
+        std::set<std::pair<size_t, size_t>> sequences;
+        do {
+            size_t first = choices.choose(2);
+            size_t second = choices.choose(3);
+            sequences.emplace(first, second);
+        } while (choices.next());
+        CHECK_EQ(sequences.size(), 6);
+    }
+
+    TEST_CASE("Split choice sequences enumerate every combination once") {
+        std::vector<ChoiceSequence> pending(1);
+        std::multiset<std::vector<size_t>> sequences;
+        while (!pending.empty()) {
+            auto choices = std::move(pending.back());
+            pending.pop_back();
+            bool hasNext = true;
+            while (hasNext) {
+                std::vector<size_t> sequence = {choices.choose(3)};
+                for (size_t i = 0; i <= sequence[0]; ++i) {
+                    sequence.push_back(choices.choose(2));
+                }
+                sequences.insert(sequence);
+                hasNext = choices.next();
+                if (hasNext && sequences.size() % 2 == 0) {
+                    if (auto other = choices.split()) {
+                        pending.push_back(std::move(*other));
+                    }
+                }
+            }
+        }
+        CHECK_EQ(sequences.size(), 2 + 4 + 8);
+        CHECK_EQ(std::set<std::vector<size_t>>(sequences.begin(),
+                                               sequences.end())
+                         .size(),
+                 sequences.size());
+    }
+
+    TEST_CASE("Sequential consistency is explored exhaustively") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        auto result = BoundedExplorer({}).explore(programs, MemoryModel::SC);
+        CHECK(result.isExhaustive);
+        CHECK_EQ(loadedValues(result.outcomes),
+                 std::set<std::pair<int32_t, int32_t>>{
+                         {0, 1}, {1, 0}, {1, 1}});
+    }
+
+    TEST_CASE("Zero bound behaves like sequential consistency") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        BoundedExplorer::Config config;
+        config.maxPreemptions = 0;
+        config.maxDelays = 0;
+        auto result = BoundedExplorer(config).explore(programs,
+                                                      MemoryModel::TSO);
+        CHECK_FALSE(result.isExhaustive);
+        CHECK_EQ(loadedValues(result.outcomes).count({0, 0}), 0);
+    }
+
+    TEST_CASE("Delays expose store buffering") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        BoundedExplorer::Config config;
+        config.maxPreemptions = 1;
+        config.maxDelays = 2;
+        for (auto model: {MemoryModel::TSO, MemoryModel::PSO}) {
+            auto result = BoundedExplorer(config).explore(programs, model);
+            CHECK_EQ(loadedValues(result.outcomes).count({0, 0}), 1);
+        }
+    }
+
+    TEST_CASE("Release-acquire reads are enumerated") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        auto result = BoundedExplorer({}).explore(programs, MemoryModel::RA);
+        CHECK(result.isExhaustive);
+        CHECK_EQ(loadedValues(result.outcomes).size(), 4);
+    }
+
+    TEST_CASE("The result doesn't depend on the number of workers") {
+        Generator::Config generatorConfig;
+        generatorConfig.programLength = 4;
+        Generator generator(generatorConfig, 11);
+        std::vector<std::vector<Program>> tests = {
+                Parser::parseFromString(STORE_BUFFERING)};
+        for (size_t i = 0; i < 4; ++i) {
+            tests.push_back(generator.generate());
+        }
+        for (const auto &programs: tests) {
+            for (auto model: {MemoryModel::SC, MemoryModel::TSO,
+                              MemoryModel::PSO, MemoryModel::RA}) {
+                BoundedExplorer::Config config;
+                config.maxExecutionsPerRound = 3000;
+                auto expected = BoundedExplorer(config).explore(programs,
+                                                                model);
+                config.nOfWorkers = 4;
+                auto actual = BoundedExplorer(config).explore(programs, model);
+                CHECK(actual.outcomes == expected.outcomes);
+                CHECK_EQ(actual.isExhaustive, expected.isExhaustive);
+                CHECK_EQ(actual.truncatedExecutions,
+                         expected.truncatedExecutions);
+                CHECK_EQ(actual.failedExecutions, expected.failedExecutions);
+                REQUIRE_EQ(actual.rounds.size(), expected.rounds.size());
+                for (size_t i = 0; i < actual.rounds.size(); ++i) {
+                    CHECK_EQ(actual.rounds[i].executions,
+                             expected.rounds[i].executions);
+                    CHECK_EQ(actual.rounds[i].newOutcomes,
+                             expected.rounds[i].newOutcomes);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#include <filesystem>
+
+#include "BoundedExplorer.h"
+#include "BreadthFirstExplorer.h"
+#include "Generator.h"
+#include "Parser.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::test;
+
+namespace {
+// Both threads flip a location forever
+const std::string FLIPPING = R"(MAKETHREAD
+1 = 1
+1: load RLX #1 2
+   2 = 1 - 2
+   store RLX #1 2
+   if 1 goto 1
+MAKETHREAD
+1 = 1
+1: load RLX #1 2
+   2 = 1 - 2
+   store RLX #1 2
+   if 1 goto 1
+)";
+
+// Three equal threads and an observer
+const std::string SYMMETRIC = R"(MAKETHREAD
+1 = 1
+2 = 2
+fai RLX #1 1
+load RLX #2 3
+store RLX #2 2
+MAKETHREAD
+1 = 1
+2 = 2
+fai RLX #1 1
+load RLX #2 3
+store RLX #2 2
+MAKETHREAD
+1 = 1
+2 = 2
+fai RLX #1 1
+load RLX #2 3
+store RLX #2 2
+MAKETHREAD
+1 = 1
+load RLX #1 3
+)";
+} // namespace
+
+TEST_SUITE("Breadth first explorer") {
+    TEST_CASE("Outcomes are the same as with the bounded explorer") {
+        Generator::Config generatorConfig;
+        generatorConfig.programLength = 4;
+        generatorConfig.loopDensity = 0;
+        Generator generator(generatorConfig, 17);
+        std::vector<std::vector<Program>> tests = {
+                Parser::parseFromString(STORE_BUFFERING)};
+        for (size_t i = 0; i < 4; ++i) {
+            tests.push_back(generator.generate());
+        }
+        for (const auto &programs: tests) {
+            for (auto model: {MemoryModel::SC, MemoryModel::TSO,
+                              MemoryModel::PSO, MemoryModel::RA}) {
+                BoundedExplorer::Config boundedConfig;
+                boundedConfig.maxPreemptions = 8;
+                boundedConfig.maxDelays = 8;
+                auto expected =
+                        BoundedExplorer(boundedConfig).explore(programs, model);
+                if (!expected.isExhaustive) { continue; }
+                auto actual = BreadthFirstExplorer({}).explore(programs, model);
+                CHECK(actual.isExhaustive);
+                CHECK(actual.outcomes == expected.outcomes);
+            }
+        }
+    }
+
+    TEST_CASE("Runs spilled to the disk don't change the result") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        auto expected = BreadthFirstExplorer({}).explore(programs,
+                                                         MemoryModel::PSO);
+        BreadthFirstExplorer::Config config;
+        config.memoryLimit = 1;
+        auto actual = BreadthFirstExplorer(config).explore(programs,
+                                                           MemoryModel::PSO);
+        CHECK(actual.outcomes == expected.outcomes);
+        CHECK_EQ(actual.states, expected.states);
+        REQUIRE_EQ(actual.levels.size(), expected.levels.size());
+        CHECK_GT(actual.levels.back().runs, 1);
+        CHECK_EQ(expected.levels.back().runs, 1);
+    }
+
+    TEST_CASE("Cyclic state spaces are explored completely") {
+        // Under TSO the store buffers could grow without bound
+        auto programs = Parser::parseFromString(FLIPPING);
+        auto result = BreadthFirstExplorer({}).explore(programs,
+                                                       MemoryModel::SC);
+        CHECK(result.isExhaustive);
+        CHECK(result.outcomes.empty());
+        CHECK_GT(result.states, 0);
+        size_t duplicates = 0;
+        for (const auto &level: result.levels) {
+            duplicates += level.duplicates;
+        }
+        CHECK_GT(duplicates, 0);
+    }
+
+    TEST_CASE("The scratch directory is removed") {
+        auto directory = std::filesystem::temp_directory_path() /
+                         "wmm_breadth_first_test";
+        std::filesystem::remove_all(directory);
+        BreadthFirstExplorer::Config config;
+        config.directory = directory;
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        auto result = BreadthFirstExplorer(config).explore(programs,
+                                                           MemoryModel::SC);
+        CHECK_EQ(result.outcomes.size(), 3);
+        CHECK(std::filesystem::is_empty(directory));
+        std::filesystem::remove_all(directory);
+    }
+
+    TEST_CASE("Symmetric threads are explored in one order") {
+        auto programs = Parser::parseFromString(SYMMETRIC);
+        CHECK(findSymmetricThreads(programs) ==
+              std::vector<size_t>{0, 0, 0, 3});
+        for (auto model: {MemoryModel::SC, MemoryModel::TSO,
+                          MemoryModel::PSO, MemoryModel::RA}) {
+            BreadthFirstExplorer::Config config;
+            config.reduceSymmetry = false;
+            auto expected = BreadthFirstExplorer(config).explore(programs,
+                                                                 model);
+            auto actual = BreadthFirstExplorer({}).explore(programs, model);
+            CHECK(actual.isExhaustive);
+            CHECK(actual.outcomes == expected.outcomes);
+            CHECK_LT(actual.states * 3, expected.states);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#include "DifferentialChecker.h"
+#include "Generator.h"
+#include "Parser.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::test;
+
+namespace {
+DifferentialChecker::Config smallConfig() {
+    DifferentialChecker::Config config;
+    config.sampling.runsPerModel = 50;
+    config.exploration.maxPreemptions = 3;
+    config.exploration.maxDelays = 3;
+    config.exploration.maxExecutionsPerRound = 5000;
+    config.nOfWorkers = 2;
+    return config;
+}
+} // namespace
+
+TEST_SUITE("Differential checker") {
+    TEST_CASE("Store buffering respects the model inclusions") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)}};
+        auto result = DifferentialChecker(smallConfig()).check(tests);
+        CHECK_EQ(result.checks, MODEL_INCLUSIONS.size());
+        CHECK(result.violations.empty());
+        CHECK_EQ(result.inconclusiveChecks, 0);
+    }
+
+    TEST_CASE("A wrong inclusion is reported") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)}};
+        auto config = smallConfig();
+        config.inclusions = {{MemoryModel::TSO, MemoryModel::SC}};
+        auto result = DifferentialChecker(config).check(tests);
+        REQUIRE_EQ(result.violations.size(), 1);
+        const auto &outcome = result.violations[0].outcome;
+        CHECK_EQ(outcome.threadLocalStorages[0][0], 0);
+        CHECK_EQ(outcome.threadLocalStorages[1][0], 0);
+    }
+
+    TEST_CASE("Generated programs respect the model inclusions") {
+        Generator::Config generatorConfig;
+        generatorConfig.programLength = 4;
+        generatorConfig.loopDensity = 0;
+        Generator generator(generatorConfig, 3);
+        std::vector<LitmusTest> tests;
+        for (size_t i = 0; i < 5; ++i) {
+            tests.push_back({std::to_string(i), generator.generate()});
+        }
+        auto result = DifferentialChecker(smallConfig()).check(tests);
+        CHECK(result.violations.empty());
+    }
+}
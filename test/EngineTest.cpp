@@ -0,0 +1,56 @@
+#include <set>
+
+#include "Engine.h"
+#include "Parser.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm;
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::test;
+
+TEST_SUITE("Engine") {
+    TEST_CASE("Runs are reproducible and reach weak outcomes") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        Engine::Config config;
+        config.model = MemoryModel::TSO;
+        Engine engine(config);
+        std::set<std::pair<int32_t, int32_t>> loadedValues;
+        for (unsigned long seed = 0; seed < 200; ++seed) {
+            auto result = engine.run(programs, seed);
+            CHECK_EQ(toString(result.status), "completed");
+            CHECK_EQ(result.finalState,
+                     engine.run(programs, seed).finalState);
+            loadedValues.emplace(result.finalState.threadLocalStorages[0][0],
+                                 result.finalState.threadLocalStorages[1][0]);
+        }
+        CHECK_EQ(loadedValues.count({0, 0}), 1);
+    }
+
+    TEST_CASE("Trace is recorded on request") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        Engine::Config config;
+        CHECK(Engine(config).run(programs, 0).trace.empty());
+        config.recordTrace = true;
+        auto result = Engine(config).run(programs, 0);
+        // Two stores and two loads
+        CHECK_EQ(result.trace.size(), 4);
+        CHECK_GT(result.stats.steps, 0);
+    }
+
+    TEST_CASE("Exploration uses the configured model") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        Engine::Config config;
+        config.model = MemoryModel::SC;
+        auto result = Engine(config).explore(programs);
+        CHECK(result.isExhaustive);
+        CHECK_EQ(result.outcomes.size(), 3);
+    }
+
+    TEST_CASE("Interactive executor is rejected") {
+        Engine::Config config;
+        config.mode = ExecutionMode::Interactive;
+        CHECK_THROWS_AS(Engine{config}, std::invalid_argument);
+    }
+}
@@ -0,0 +1,108 @@
+#include <algorithm>
+
+#include "BoundedExplorer.h"
+#include "Footprint.h"
+#include "Parser.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+
+namespace {
+// Location 3 is private to the first thread, location 4 is only read
+const std::string PRIVATE_LOCATIONS = R"(MAKETHREAD
+1 = 1
+2 = 2
+3 = 3
+4 = 4
+store RLX #3 1
+store RLX #1 1
+load RLX #3 5
+load RLX #4 6
+load RLX #2 0
+MAKETHREAD
+1 = 1
+2 = 2
+4 = 4
+store RLX #2 1
+load RLX #4 6
+load RLX #1 0
+)";
+} // namespace
+
+TEST_SUITE("Footprint") {
+    TEST_CASE("Constant addresses are found") {
+        auto programs = Parser::parseFromString(PRIVATE_LOCATIONS);
+        auto footprints = analyzeFootprints(programs);
+        REQUIRE_EQ(footprints.size(), 2);
+        CHECK(footprints[0].isComplete());
+        CHECK_EQ(footprints[0].getReads(), std::set<size_t>{2, 3, 4});
+        CHECK_EQ(footprints[0].getWrites(), std::set<size_t>{1, 3});
+        CHECK_EQ(footprints[0].getAddress(4), 3);
+        CHECK_FALSE(footprints[0].getAddress(0).has_value());
+        CHECK_EQ(getRequiredStorageSize(footprints), 5);
+    }
+
+    TEST_CASE("Loaded and joined addresses are unknown") {
+        std::string program;
+        SUBCASE("Loaded") { program = "load RLX #0 1\nstore RLX #1 0\n"; }
+        SUBCASE("Different on two paths") {
+            program = "load RLX #0 2\n1 = 1\nif 2 goto 1\n1 = 2\n1:\n"
+                      "store RLX #1 0\n";
+        }
+        auto programs = Parser::parseFromString(program);
+        auto footprints = analyzeFootprints(programs);
+        CHECK_FALSE(footprints[0].isComplete());
+        CHECK_FALSE(getRequiredStorageSize(footprints).has_value());
+        auto commuting = findCommutingAccesses(programs, footprints)[0];
+        CHECK(std::find(commuting.begin(), commuting.end(), true) ==
+              commuting.end());
+    }
+
+    TEST_CASE("Constant jumps and loops are followed") {
+        auto programs = Parser::parseFromString(R"(1 = 1
+2 = 3
+if 1 goto 1
+store RLX #1 1
+1:
+store RLX #2 1
+3 = 2
+2 = 2 - 1
+if 2 goto 1
+)");
+        auto footprints = analyzeFootprints(programs);
+        CHECK_FALSE(footprints[0].isComplete());
+        CHECK(footprints[0].getWrites().empty());
+        // The untaken store to location 1 is ignored
+        CHECK_FALSE(footprints[0].getAddress(3).has_value());
+    }
+
+    TEST_CASE("Accesses of locations other threads don't write commute") {
+        auto programs = Parser::parseFromString(PRIVATE_LOCATIONS);
+        auto commuting =
+                findCommutingAccesses(programs, analyzeFootprints(programs));
+        CHECK_EQ(commuting[0],
+                 std::vector<bool>{false, false, false, false, true, false,
+                                   true, true, false});
+        CHECK_EQ(commuting[1], std::vector<bool>{false, false, false, false,
+                                                 true, false});
+    }
+
+    TEST_CASE("Skipping commuting accesses keeps the outcomes") {
+        auto programs = Parser::parseFromString(PRIVATE_LOCATIONS);
+        for (auto model: ALL_MEMORY_MODELS) {
+            BoundedExplorer::Config config;
+            config.maxPreemptions = 3;
+            config.maxDelays = 3;
+            auto reduced = BoundedExplorer(config).explore(programs, model);
+            config.skipCommutingAccesses = false;
+            auto full = BoundedExplorer(config).explore(programs, model);
+            CAPTURE(toString(model));
+            CHECK(reduced.isExhaustive);
+            CHECK_EQ(reduced.outcomes, full.outcomes);
+            CHECK_EQ(reduced.outcomes.begin()->sharedStorage.size(), 10);
+            CHECK_LT(reduced.rounds.back().executions,
+                     full.rounds.back().executions);
+        }
+    }
+}
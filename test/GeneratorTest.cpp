@@ -0,0 +1,64 @@
+#include <sstream>
+
+#include "BatchRunner.h"
+#include "Generator.h"
+#include "Parser.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+
+namespace {
+std::string toText(const std::vector<Program> &programs) {
+    std::stringstream stream;
+    Parser::writeToStream(programs, stream);
+    return stream.str();
+}
+} // namespace
+
+TEST_SUITE("Generator") {
+    TEST_CASE("Generated programs survive the text round trip") {
+        Generator::Config config;
+        config.nOfThreads = 3;
+        config.programLength = 30;
+        config.loopDensity = 0.3;
+        Generator generator(config, 42);
+        for (size_t i = 0; i < 20; ++i) {
+            auto programs = generator.generate();
+            auto text = toText(programs);
+            auto parsed = Parser::parseFromString(text);
+            REQUIRE_EQ(parsed.size(), programs.size());
+            CHECK_EQ(toText(parsed), text);
+        }
+    }
+
+    TEST_CASE("The same seed generates the same programs") {
+        Generator::Config config;
+        CHECK_EQ(toText(Generator(config, 7).generate()),
+                 toText(Generator(config, 7).generate()));
+    }
+
+    TEST_CASE("Generated programs terminate") {
+        Generator::Config config;
+        config.loopDensity = 0.5;
+        Generator generator(config, 1);
+        std::vector<LitmusTest> tests;
+        for (size_t i = 0; i < 10; ++i) {
+            tests.push_back({std::to_string(i), generator.generate()});
+        }
+        BatchRunner::Config batchConfig;
+        batchConfig.runsPerModel = 20;
+        auto result = BatchRunner(batchConfig).run(tests);
+        for (const auto &row: result.cells) {
+            for (const auto &cell: row) {
+                CHECK_EQ(cell.completedRuns, 20);
+            }
+        }
+    }
+
+    TEST_CASE("Too few registers are rejected") {
+        Generator::Config config;
+        config.nOfAddresses = 8;
+        CHECK_THROWS_AS(Generator(config, 0), std::invalid_argument);
+    }
+}
@@ -0,0 +1,231 @@
+#include "BatchRunner.h"
+#include "BoundedExplorer.h"
+#include "Generator.h"
+#include "LockstepExecutor.h"
+#include "Optimizer.h"
+#include "Parser.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::test;
+
+namespace {
+// Increments of x by retry loops and a cas that reports its result
+const std::string CAS_LOOPS = R"(MAKETHREAD
+1 = 1
+3 = 1
+4 = 1
+1: load RLX #1 5
+6 = 5 + 4
+cas RLX #1 5 6 7
+8 = 3 - 7
+if 8 goto 1
+MAKETHREAD
+1 = 1
+3 = 1
+4 = 2
+store RLX #2 4
+1: load RLX #1 5
+6 = 5 + 4
+cas RLX #1 5 6 7
+8 = 3 - 7
+if 8 goto 1
+MAKETHREAD
+1 = 1
+3 = 10
+cas RLX #1 0 3 4
+)";
+
+std::vector<unsigned long> makeSeeds(size_t count) {
+    std::vector<unsigned long> seeds(count);
+    for (size_t i = 0; i < count; ++i) { seeds[i] = i * 7919 + 1; }
+    return seeds;
+}
+
+std::set<Outcome> completedOutcomes(
+        const std::vector<LockstepExecutor::Run> &runs) {
+    std::set<Outcome> outcomes;
+    for (const auto &run: runs) {
+        if (run.status == ExecutionStatus::Completed) {
+            outcomes.insert(run.outcome);
+        }
+    }
+    return outcomes;
+}
+
+std::set<Outcome> explore(const std::vector<Program> &programs,
+                          MemoryModel model) {
+    BoundedExplorer::Config config;
+    config.maxPreemptions = 4;
+    config.maxDelays = 4;
+    auto result = BoundedExplorer(config).explore(programs, model);
+    REQUIRE(result.isExhaustive);
+    return result.outcomes;
+}
+} // namespace
+
+TEST_SUITE("Lockstep executor") {
+    TEST_CASE("Store buffering reaches the same outcomes as the explorer") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        for (auto model: {MemoryModel::SC, MemoryModel::TSO}) {
+            CAPTURE(toString(model));
+            LockstepExecutor executor(programs, model, {});
+            auto runs = executor.run(makeSeeds(2000));
+            CHECK(completedOutcomes(runs) == explore(programs, model));
+        }
+    }
+
+    TEST_CASE("Lanes don't depend on each other") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        auto seeds = makeSeeds(100);
+        LockstepExecutor::Config config;
+        auto wide = LockstepExecutor(programs, MemoryModel::TSO, config)
+                            .run(seeds);
+        config.lanes = 7;
+        auto narrow = LockstepExecutor(programs, MemoryModel::TSO, config)
+                              .run(seeds);
+        REQUIRE_EQ(wide.size(), narrow.size());
+        for (size_t i = 0; i < wide.size(); ++i) {
+            CHECK_EQ(wide[i].steps, narrow[i].steps);
+            CHECK(wide[i].outcome == narrow[i].outcome);
+        }
+    }
+
+    TEST_CASE("Spin loops block and deadlock") {
+        SUBCASE("Released by the other thread") {
+            auto programs = Parser::parseFromString(MESSAGE_PASSING);
+            auto runs = LockstepExecutor(programs, MemoryModel::TSO, {})
+                                .run(makeSeeds(50));
+            for (const auto &run: runs) {
+                REQUIRE(run.status.has_value());
+                CHECK_EQ(toString(*run.status), "completed");
+                CHECK_EQ(run.outcome.threadLocalStorages[1][0], 0);
+            }
+        }
+        SUBCASE("Waiting forever") {
+            auto programs = Parser::parseFromString(
+                    "1 = 1\n1: load ACQ #1 0\n0 = 0 - 1\nif 0 goto 1\n");
+            auto runs = LockstepExecutor(programs, MemoryModel::SC, {})
+                                .run(makeSeeds(3));
+            for (const auto &run: runs) {
+                REQUIRE(run.status.has_value());
+                CHECK_EQ(toString(*run.status), "deadlocked");
+                CHECK_LT(run.steps, 10);
+            }
+        }
+    }
+
+    TEST_CASE("Truncated and failed executions") {
+        LockstepExecutor::Config config;
+        config.maxSteps = 100;
+        auto loop = Parser::parseFromString("1 = 1\n1: 2 = 2 + 1\n"
+                                            "if 1 goto 1\n");
+        auto truncated = LockstepExecutor(loop, MemoryModel::SC, config)
+                                 .run(makeSeeds(1));
+        REQUIRE(truncated[0].status.has_value());
+        CHECK_EQ(toString(*truncated[0].status), "step limit exceeded");
+        CHECK_EQ(truncated[0].steps, 101);
+
+        auto outOfRange = Parser::parseFromString("1 = 100\nstore RLX #1 1\n");
+        auto failed = LockstepExecutor(outOfRange, MemoryModel::TSO, config)
+                              .run(makeSeeds(1));
+        CHECK_FALSE(failed[0].status.has_value());
+    }
+
+    TEST_CASE("Divisions agree with the thread engine") {
+        std::vector<LitmusTest> tests = {
+                {"div", Parser::parseFromString("1 = -7\n2 = 2\n"
+                                                "3 = 1 / 2\n4 = 2 / 1\n")},
+                {"div0", Parser::parseFromString("1 = 7\n2 = 0\n"
+                                                 "3 = 1 / 2\n")},
+                {"overflow", Parser::parseFromString("1 = -2147483648\n"
+                                                     "2 = -1\n3 = 1 / 2\n")}};
+        BatchRunner::Config config;
+        config.models = {MemoryModel::SC, MemoryModel::TSO};
+        config.runsPerModel = 10;
+        auto expected = BatchRunner(config).run(tests);
+        config.lockstepLanes = 8;
+        auto actual = BatchRunner(config).run(tests);
+        for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex) {
+            CAPTURE(tests[testIndex].name);
+            for (size_t modelIndex = 0; modelIndex < 2; ++modelIndex) {
+                const auto &cell = actual.cells[testIndex][modelIndex];
+                const auto &expectedCell =
+                        expected.cells[testIndex][modelIndex];
+                CHECK_EQ(cell.completedRuns, expectedCell.completedRuns);
+                CHECK_EQ(cell.failedRuns, expectedCell.failedRuns);
+                CHECK(cell.outcomes == expectedCell.outcomes);
+            }
+        }
+        const auto &quotients = expected.cells[0][0];
+        REQUIRE_EQ(quotients.outcomes.size(), 1);
+        const auto &registers =
+                quotients.outcomes.begin()->threadLocalStorages[0];
+        CHECK_EQ(registers[3], -3);
+        CHECK_EQ(registers[4], 0);
+        CHECK_EQ(expected.cells[1][0].failedRuns, 10);
+        CHECK_EQ(expected.cells[2][0].failedRuns, 10);
+    }
+
+    TEST_CASE("Other models are rejected") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        CHECK_THROWS_AS(LockstepExecutor(programs, MemoryModel::RA, {}),
+                        std::invalid_argument);
+    }
+
+    TEST_CASE("Fused compare-and-swap loops reach the explored outcomes") {
+        auto programs = Parser::parseFromString(CAS_LOOPS);
+        auto optimized = Optimizer::optimize(programs);
+        for (auto model: {MemoryModel::SC, MemoryModel::TSO}) {
+            CAPTURE(toString(model));
+            for (const auto &lockstepPrograms: {programs, optimized}) {
+                LockstepExecutor executor(lockstepPrograms, model, {});
+                auto runs = executor.run(makeSeeds(2000));
+                CHECK(completedOutcomes(runs) == explore(programs, model));
+            }
+        }
+    }
+
+    TEST_CASE("Generated programs only reach explored outcomes") {
+        Generator::Config generatorConfig;
+        generatorConfig.programLength = 5;
+        Generator generator(generatorConfig, 5);
+        for (size_t i = 0; i < 10; ++i) {
+            auto programs = generator.generate();
+            for (auto model: {MemoryModel::SC, MemoryModel::TSO}) {
+                BoundedExplorer::Config config;
+                config.maxExecutionsPerRound = 20000;
+                auto explored =
+                        BoundedExplorer(config).explore(programs, model);
+                if (!explored.isExhaustive) { continue; }
+                auto runs = LockstepExecutor(programs, model, {})
+                                    .run(makeSeeds(200));
+                for (const auto &outcome: completedOutcomes(runs)) {
+                    CHECK(explored.outcomes.count(outcome) > 0);
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Batch runner uses lockstep lanes for SC and TSO") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)},
+                {"mp", Parser::parseFromString(MESSAGE_PASSING)}};
+        BatchRunner::Config config;
+        config.models = {MemoryModel::SC, MemoryModel::TSO, MemoryModel::PSO};
+        config.runsPerModel = 1000;
+        auto expected = BatchRunner(config).run(tests);
+        config.lockstepLanes = 128;
+        auto actual = BatchRunner(config).run(tests);
+        for (size_t testIndex = 0; testIndex < tests.size(); ++testIndex) {
+            for (size_t modelIndex = 0; modelIndex < 3; ++modelIndex) {
+                const auto &cell = actual.cells[testIndex][modelIndex];
+                CHECK_EQ(cell.completedRuns, 1000);
+                CHECK(cell.outcomes ==
+                         expected.cells[testIndex][modelIndex].outcomes);
+            }
+        }
+    }
+}
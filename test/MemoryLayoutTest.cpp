@@ -0,0 +1,114 @@
+#include <set>
+#include <sstream>
+
+#include "ExecutorFactory.h"
+#include "MemoryLayout.h"
+#include "Parser.h"
+#include "Watchdog.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+
+namespace {
+// Location 3 is private to the first thread, location 4 is only read and
+// location 5 is private but updated by a read-modify-write
+const std::string PRIVATE_LOCATIONS = R"(MAKETHREAD
+1 = 1
+2 = 2
+3 = 3
+4 = 4
+5 = 5
+store RLX #3 1
+store REL #1 1
+load ACQ #3 7
+fai RLX #5 1
+load RLX #4 6
+load RLX #2 0
+MAKETHREAD
+1 = 1
+2 = 2
+4 = 4
+store RLX #2 1
+load RLX #4 6
+load RLX #1 0
+)";
+
+std::set<Outcome> runOutcomes(const std::vector<Program> &programs,
+                              MemoryModel model, bool useLayout) {
+    MemoryLayoutPtr layout;
+    size_t storageSize = 10;
+    if (useLayout) {
+        layout = std::make_shared<const MemoryLayout>(programs, storageSize);
+        storageSize = layout->getSharedStorageSize();
+    }
+    auto storageManager = makeStorageManager(model, ExecutionMode::Random,
+                                             storageSize, programs.size(), 0);
+    auto executor = makeExecutor(ExecutionMode::Random, programs,
+                                 storageManager, 10, 0, {}, layout);
+    std::set<Outcome> outcomes;
+    for (unsigned long seed = 0; seed < 300; ++seed) {
+        storageManager->reset(seed);
+        executor->reset(seed);
+        auto report = Watchdog({}).run(*executor);
+        REQUIRE_EQ(toString(report.status),
+                   toString(ExecutionStatus::Completed));
+        outcomes.insert(executor->getOutcome());
+    }
+    return outcomes;
+}
+} // namespace
+
+TEST_SUITE("Memory layout") {
+    TEST_CASE("Locations of a single thread are private") {
+        auto programs = Parser::parseFromString(PRIVATE_LOCATIONS);
+        MemoryLayout layout(programs, 10);
+        CHECK(layout.isPrivate(0, 3));
+        CHECK_FALSE(layout.isPrivate(1, 3));
+        CHECK_FALSE(layout.isPrivate(0, 5));
+        CHECK(layout.hasPrivateLocations(0));
+        CHECK_FALSE(layout.hasPrivateLocations(1));
+        CHECK_EQ(layout.getSharedStorageSize(), 4);
+        CHECK_EQ(layout.getSharedIndex(1), 0);
+        CHECK_EQ(layout.getSharedIndex(5), 3);
+        CHECK_THROWS((void) layout.getSharedIndex(3));
+        CHECK_THROWS((void) layout.getSharedIndex(10));
+    }
+
+    TEST_CASE("Unknown addresses keep all locations shared") {
+        auto programs = Parser::parseFromString("load RLX #0 1\n"
+                                                "store RLX #1 0\n");
+        MemoryLayout layout(programs, 10);
+        CHECK_FALSE(layout.hasPrivateLocations(0));
+        CHECK_EQ(layout.getSharedStorageSize(), 10);
+        CHECK_EQ(layout.getSharedIndex(7), 7);
+    }
+
+    TEST_CASE("Private locations don't change the outcomes") {
+        auto programs = Parser::parseFromString(PRIVATE_LOCATIONS);
+        for (auto model: ALL_MEMORY_MODELS) {
+            CAPTURE(toString(model));
+            auto outcomes = runOutcomes(programs, model, true);
+            CHECK_EQ(outcomes, runOutcomes(programs, model, false));
+            CHECK_EQ(outcomes.begin()->sharedStorage[3], 1);
+        }
+    }
+
+    TEST_CASE("The state lists all locations separated by spaces") {
+        auto programs = Parser::parseFromString(PRIVATE_LOCATIONS);
+        auto layout = std::make_shared<const MemoryLayout>(programs, 10);
+        auto storageManager = makeStorageManager(
+                MemoryModel::SC, ExecutionMode::Random,
+                layout->getSharedStorageSize(), programs.size(), 0);
+        auto executor = makeExecutor(ExecutionMode::Random, programs,
+                                     storageManager, 10, 0, {}, layout);
+        (void) Watchdog({}).run(*executor);
+        std::string expected = "All locations:";
+        for (auto value: executor->getOutcome().sharedStorage) {
+            expected += " " + std::to_string(value);
+        }
+        std::ostringstream stream;
+        executor->writeState(stream);
+        CHECK_NE(stream.str().find(expected + '\n'), std::string::npos);
+    }
+}
@@ -0,0 +1,241 @@
+#include "BoundedExplorer.h"
+#include "Generator.h"
+#include "Optimizer.h"
+#include "Parser.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+
+namespace {
+// Two threads add to x with retry loops, a third sets it once if it is 0
+const std::string CAS_LOOPS = R"(MAKETHREAD
+1 = 1
+3 = 1
+4 = 1
+1: load RLX #1 5
+6 = 5 + 4
+cas REL_ACQ #1 5 6 7
+8 = 3 - 7
+if 8 goto 1
+MAKETHREAD
+1 = 1
+3 = 1
+4 = 2
+1: load ACQ #1 5
+6 = 5 + 4
+cas REL_ACQ #1 5 6 7
+8 = 7 - 3
+if 8 goto 1
+MAKETHREAD
+1 = 1
+3 = 10
+cas RLX #1 0 3 4
+)";
+
+Program optimizeString(const std::string &string,
+                       Optimizer::Stats *stats = nullptr) {
+    auto programs = Parser::parseFromString(string);
+    REQUIRE_EQ(programs.size(), 1);
+    return Optimizer::optimize(programs[0], stats);
+}
+
+std::set<Outcome> explore(const std::vector<Program> &programs,
+                          MemoryModel model, bool optimize,
+                          size_t bound = 3) {
+    BoundedExplorer::Config config;
+    config.maxPreemptions = bound;
+    config.maxDelays = bound;
+    config.optimize = optimize;
+    auto result = BoundedExplorer(config).explore(programs, model);
+    REQUIRE(result.isExhaustive);
+    return result.outcomes;
+}
+} // namespace
+
+TEST_SUITE("Optimizer") {
+    TEST_CASE("Known arithmetic is folded") {
+        Optimizer::Stats stats;
+        auto program = optimizeString("1 = 2\n2 = 3\n3 = 1 * 2\n", &stats);
+        CHECK_EQ(stats.foldedExpressions, 1);
+        REQUIRE_EQ(program.size(), 3);
+        auto instruction = program.getInstruction(2);
+        REQUIRE_EQ(instruction->action,
+                   InstructionAction::StoreConstInRegister);
+        CHECK_EQ(static_cast<const StoreConstInRegister &>(*instruction).value,
+                 6);
+    }
+
+    TEST_CASE("Division by zero is not folded") {
+        Optimizer::Stats stats;
+        auto program = optimizeString("1 = 2\n3 = 1 / 2\n", &stats);
+        CHECK_EQ(stats.foldedExpressions, 0);
+        CHECK_EQ(program.size(), 2);
+    }
+
+    TEST_CASE("Jumps that are never taken and dead code are removed") {
+        Optimizer::Stats stats;
+        auto program = optimizeString(
+                "1 = 1\nif 0 goto 1\n2 = 2\nstore RLX #1 2\n1:\n", &stats);
+        CHECK_EQ(stats.removedJumps, 1);
+        CHECK_EQ(program.size(), 3);
+
+        Optimizer::Stats skipStats;
+        auto skipped = optimizeString(
+                "1 = 1\nif 1 goto 1\nstore RLX #1 1\n1:\nload RLX #1 0\n",
+                &skipStats);
+        CHECK_EQ(skipStats.removedUnreachable, 1);
+        REQUIRE_EQ(skipped.size(), 3);
+        CHECK_EQ(skipped.getInstruction(2)->action, InstructionAction::Load);
+    }
+
+    TEST_CASE("Jumps to unconditional jumps are threaded") {
+        Optimizer::Stats stats;
+        auto program = optimizeString("1 = 1\nload RLX #1 2\nif 2 goto 1\n"
+                                      "store RLX #1 1\n1:\nif 1 goto 2\n"
+                                      "store RLX #1 2\n2:\n",
+                                      &stats);
+        CHECK_GE(stats.threadedJumps, 1);
+        // The conditional jump leads straight to the end
+        auto jump = program.getInstruction(2);
+        REQUIRE_EQ(jump->action, InstructionAction::Goto);
+        auto label = static_cast<const Goto &>(*jump).label;
+        CHECK_EQ(program.getLabels().at(label), program.size());
+    }
+
+    TEST_CASE("Only overwritten register writes are removed") {
+        Optimizer::Stats stats;
+        auto program = optimizeString("1 = 1\n5 = 7\n5 = 8\n1 = 2\n", &stats);
+        CHECK_EQ(stats.removedDeadStores, 2);
+        CHECK_EQ(program.size(), 2);
+
+        Optimizer::Stats readStats;
+        auto read = optimizeString("1 = 1\n2 = 3\nstore RLX #1 2\n2 = 4\n",
+                                   &readStats);
+        CHECK_EQ(readStats.removedDeadStores, 0);
+        CHECK_EQ(read.size(), 4);
+    }
+
+    TEST_CASE("Loaded values are not folded") {
+        // Register 2 is always loaded before it is read
+        Optimizer::Stats stats;
+        auto program = optimizeString("1 = 1\n2 = 0\n3 = 1\n"
+                                      "1: load ACQ #1 2\n4 = 2 - 3\n"
+                                      "if 4 goto 1\n",
+                                      &stats);
+        CHECK_EQ(stats.foldedExpressions, 0);
+        CHECK_EQ(stats.removedDeadStores, 1);
+        REQUIRE_EQ(program.size(), 5);
+        CHECK_EQ(program.getInstruction(3)->action,
+                 InstructionAction::StoreExprInRegister);
+        CHECK_EQ(program.getLabels().at(1), 2);
+    }
+
+    TEST_CASE("Outcomes don't change") {
+        auto programs = Parser::parseFromString(R"(MAKETHREAD
+1 = 1
+2 = 2
+3 = 1 + 1
+4 = 3 - 2
+if 4 goto 1
+store RLX #2 3
+1:
+store REL #1 2
+load RLX #2 0
+MAKETHREAD
+1 = 1
+2 = 2
+load ACQ #1 5
+6 = 5 - 2
+if 6 goto 2
+load RLX #2 0
+2:
+7 = 0 * 1
+)");
+        for (auto model: ALL_MEMORY_MODELS) {
+            CHECK_EQ(explore(programs, model, true),
+                     explore(programs, model, false));
+        }
+    }
+
+    TEST_CASE("Outcomes of generated programs don't change") {
+        Generator::Config config;
+        config.programLength = 5;
+        Generator generator(config, 11);
+        for (size_t i = 0; i < 10; ++i) {
+            auto programs = generator.generate();
+            for (auto model: {MemoryModel::TSO, MemoryModel::RA}) {
+                BoundedExplorer::Config exploration;
+                exploration.maxExecutionsPerRound = 20000;
+                auto optimized = exploration;
+                exploration.optimize = false;
+                auto expected =
+                        BoundedExplorer(exploration).explore(programs, model);
+                auto actual =
+                        BoundedExplorer(optimized).explore(programs, model);
+                if (!expected.isExhaustive || !actual.isExhaustive) {
+                    continue;
+                }
+                CHECK_EQ(actual.outcomes, expected.outcomes);
+            }
+        }
+    }
+
+    TEST_CASE("Compare-and-swap retry loops are fused") {
+        Optimizer::Stats stats;
+        auto program = optimizeString("1 = 1\n3 = 1\n4 = 1\n"
+                                      "1: load RLX #1 5\n6 = 5 + 4\n"
+                                      "cas REL_ACQ #1 5 6 7\n8 = 3 - 7\n"
+                                      "if 8 goto 1\nstore RLX #1 8\n",
+                                      &stats);
+        CHECK_EQ(stats.fusedLoops, 1);
+        REQUIRE_EQ(program.size(), 5);
+        auto loop = program.getInstruction(3);
+        REQUIRE_EQ(loop->action, InstructionAction::CompareAndSwapLoop);
+        const auto &cmd = static_cast<const CompareAndSwapLoop &>(*loop);
+        CHECK_EQ(cmd.body.size(), 4);
+        CHECK_EQ(cmd.conditionRegister, 8);
+        CHECK_EQ(program.getLabels().at(1), 3);
+        CHECK_EQ(program.getInstruction(4)->action, InstructionAction::Store);
+    }
+
+    TEST_CASE("Loops that don't retry exactly the failed cas are kept") {
+        std::string loop;
+        SUBCASE("Repeats on success") {
+            loop = "1: load RLX #1 5\n6 = 5 + 4\ncas RLX #1 5 6 7\n"
+                   "8 = 7 - 0\nif 8 goto 1\n";
+        }
+        SUBCASE("Condition register is loaded") {
+            loop = "load RLX #2 3\n1: load RLX #1 5\n6 = 5 + 4\n"
+                   "cas RLX #1 5 6 7\n8 = 3 - 7\nif 8 goto 1\n";
+        }
+        SUBCASE("Other value expected") {
+            loop = "1: load RLX #1 5\n6 = 5 + 4\ncas RLX #1 6 6 7\n"
+                   "8 = 3 - 7\nif 8 goto 1\n";
+        }
+        SUBCASE("Memory access in the loop") {
+            loop = "1: load RLX #1 5\nstore RLX #2 5\ncas RLX #1 5 4 7\n"
+                   "8 = 3 - 7\nif 8 goto 1\n";
+        }
+        SUBCASE("Jump into the loop") {
+            loop = "if 3 goto 2\n1: load RLX #1 5\n2: 6 = 5 + 4\n"
+                   "cas RLX #1 5 6 7\n8 = 3 - 7\nif 8 goto 1\n";
+        }
+        Optimizer::Stats stats;
+        (void) optimizeString("1 = 1\n3 = 1\n4 = 1\n" + loop, &stats);
+        CHECK_EQ(stats.fusedLoops, 0);
+    }
+
+    TEST_CASE("Outcomes of compare-and-swap loops don't change") {
+        auto programs = Parser::parseFromString(CAS_LOOPS);
+        Optimizer::Stats stats;
+        (void) Optimizer::optimize(programs, &stats);
+        CHECK_EQ(stats.fusedLoops, 2);
+        for (auto model: ALL_MEMORY_MODELS) {
+            CAPTURE(toString(model));
+            // Failed iterations take more preemptions
+            CHECK_EQ(explore(programs, model, true),
+                     explore(programs, model, false, 8));
+        }
+    }
+}
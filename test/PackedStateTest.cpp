@@ -0,0 +1,102 @@
+#include <climits>
+#include <set>
+
+#include "ExecutorFactory.h"
+#include "Generator.h"
+#include "PackedState.h"
+#include "Parser.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::storage;
+using namespace wmm::test;
+
+namespace {
+struct Context {
+    StorageManagerPtr storageManager;
+    ExecutorPtr executor;
+
+    Context(const std::vector<Program> &programs, MemoryModel model,
+            unsigned long seed)
+        : storageManager(makeStorageManager(model, ExecutionMode::Random, 10,
+                                            programs.size(), seed)),
+          executor(makeExecutor(ExecutionMode::Random, programs,
+                                storageManager, 10, seed)) {}
+};
+} // namespace
+
+TEST_SUITE("Packed state") {
+    TEST_CASE("Fields are read back as written") {
+        std::vector<int32_t> values = {0, 1, -1, 7, -300, INT32_MAX,
+                                       INT32_MIN};
+        StateWriter writer;
+        for (auto value: values) { writer.writeValue(value); }
+        writer.writeSize(0);
+        writer.writeSize(1);
+        writer.writeSize(1000000);
+        writer.writeIndex(5, 6);
+        writer.writeIndex(0, 1);
+        writer.writeFlag(true);
+        auto state = writer.finish();
+
+        StateReader reader(state);
+        for (auto value: values) { CHECK_EQ(reader.readValue(), value); }
+        CHECK_EQ(reader.readSize(), 0);
+        CHECK_EQ(reader.readSize(), 1);
+        CHECK_EQ(reader.readSize(), 1000000);
+        CHECK_EQ(reader.readIndex(6), 5);
+        CHECK_EQ(reader.readIndex(1), 0);
+        CHECK(reader.readFlag());
+        CHECK_THROWS_AS(reader.readBits(8), std::out_of_range);
+    }
+
+    TEST_CASE("Small values take a few bits") {
+        StateWriter writer;
+        for (size_t i = 0; i < 8; ++i) { writer.writeValue(0); }
+        CHECK_EQ(writer.finish().getBytes().size(), 6);
+
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        Context context(programs, MemoryModel::TSO, 0);
+        auto state = context.executor->encodeState();
+        CHECK_LT(state.getBytes().size(), 48);
+    }
+
+    TEST_CASE("Decoded states are encoded the same way") {
+        Generator::Config generatorConfig;
+        generatorConfig.programLength = 8;
+        Generator generator(generatorConfig, 23);
+        for (unsigned long seed = 0; seed < 20; ++seed) {
+            auto programs = generator.generate();
+            for (auto model: {MemoryModel::SC, MemoryModel::TSO,
+                              MemoryModel::PSO, MemoryModel::RA}) {
+                Context original(programs, model, seed);
+                Context copy(programs, model, seed + 1);
+                REQUIRE(original.executor->canEncodeState());
+                for (size_t step = 0; step < 30; ++step) {
+                    auto state = original.executor->encodeState();
+                    copy.executor->decodeState(state);
+                    CHECK(copy.executor->encodeState() == state);
+                    CHECK_EQ(copy.executor->hashState(),
+                             original.executor->hashState());
+                    CHECK(copy.executor->getOutcome() ==
+                          original.executor->getOutcome());
+                    if (!original.executor->execute()) { break; }
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Different states have different encodings") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        Context context(programs, MemoryModel::PSO, 3);
+        std::set<PackedState> states;
+        std::set<size_t> hashes;
+        do {
+            states.insert(context.executor->encodeState());
+            hashes.insert(context.executor->hashState());
+        } while (context.executor->execute());
+        CHECK_EQ(states.size(), hashes.size());
+    }
+}
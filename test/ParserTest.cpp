@@ -1,3 +1,8 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#include "Generator.h"
 #include "Parser.h"
 #include "doctest.h"
 
@@ -18,7 +23,8 @@ TEST_SUITE("Parser") {
         SUBCASE("Load") { command = "load SEQ_CST #1 2"; }
         SUBCASE("Store") { command = "store REL #1 2"; }
         SUBCASE("CompareAndSwap") { command = "cas ACQ #1 2 3"; }
-        SUBCASE("FetchAndIncrement") { command = "fei REL_ACQ #1 2"; }
+        SUBCASE("CompareAndSwap with result") { command = "cas RLX #1 2 3 4"; }
+        SUBCASE("FetchAndIncrement") { command = "fai REL_ACQ #1 2"; }
         SUBCASE("Fence") { command = "fence RLX"; }
         auto [label, instruction] = Parser::parseLine(command);
         CHECK_EQ(command, instruction->str());
@@ -52,4 +58,61 @@ TEST_SUITE("Parser") {
         CHECK_THROWS_WITH(Parser::parseLine("1 = 2 -5 6"),
                           "Couldn't parse binary operation");
     }
-}
\ No newline at end of file
+
+    TEST_CASE("Numbers must be whole tokens") {
+        CHECK_THROWS_WITH(Parser::parseLine("1x = 2"),
+                          "Couldn't parse register");
+        CHECK_THROWS_WITH(Parser::parseLine("-1 = 2"),
+                          "Couldn't parse register");
+        CHECK_THROWS_WITH(Parser::parseLine("1 = 2147483648"),
+                          "Couldn't parse constant value");
+        CHECK_EQ(std::get<1>(Parser::parseLine("1 = +5"))->str(), "1 = 5");
+    }
+
+    TEST_CASE("Error reports the line number") {
+        CHECK_THROWS_WITH(
+                Parser::parseFromString("MAKETHREAD\n1 = 2\n\nload RLX 1 2\n"),
+                "Parsing error in line 4: Couldn't parse register");
+        CHECK_THROWS_WITH(Parser::parseFromString("1 = 2\nfence RLX 1 2 3 4 5"),
+                          "Parsing error in line 2: Too many tokens");
+        CHECK_THROWS_WITH(Parser::parseFromString("1 = 12abc"),
+                          "Parsing error in line 1: "
+                          "Couldn't parse constant value");
+    }
+
+    TEST_CASE("Windows line endings") {
+        auto programs = Parser::parseFromString(
+                "MAKETHREAD\r\n1 = -3\r\nMAKETHREAD\r\nfence RLX\r\n");
+        REQUIRE_EQ(programs.size(), 2);
+        CHECK_EQ(programs[0].getInstruction(0)->str(), "1 = -3");
+        CHECK_EQ(programs[1].getInstruction(0)->str(), "fence RLX");
+    }
+
+    TEST_CASE("Mapped file and stream give the same programs") {
+        Generator::Config config;
+        config.nOfThreads = 3;
+        config.programLength = 200;
+        auto programs = Generator(config, 7).generate();
+        std::stringstream text;
+        Parser::writeToStream(programs, text);
+
+        auto path = std::filesystem::temp_directory_path() /
+                    "wmm_parser_test.wmm";
+        std::ofstream(path) << text.str();
+        auto mapped = Parser::parseFromFile(path.string());
+        auto streamed = Parser::parseFromStream(text);
+        std::filesystem::remove(path);
+
+        std::stringstream mappedText;
+        std::stringstream streamedText;
+        Parser::writeToStream(mapped, mappedText);
+        Parser::writeToStream(streamed, streamedText);
+        CHECK_EQ(mappedText.str(), text.str());
+        CHECK_EQ(streamedText.str(), text.str());
+    }
+
+    TEST_CASE("Missing file") {
+        CHECK_THROWS_WITH(Parser::parseFromFile("/nonexistent/file.wmm"),
+                          "Couldn't open file /nonexistent/file.wmm");
+    }
+}
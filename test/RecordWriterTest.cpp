@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <sstream>
+
+#include "BatchRunner.h"
+#include "BoundedExplorer.h"
+#include "Parser.h"
+#include "RecordWriter.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::test;
+
+namespace {
+ExecutionRecord makeRecord() {
+    ExecutionRecord record;
+    record.test = "sb";
+    record.model = MemoryModel::TSO;
+    record.run = 3;
+    record.seed = 42;
+    record.status = ExecutionStatus::Completed;
+    record.steps = 12;
+    record.outcome = Outcome{{1, 1}, {{0, 1}, {1, 0}}};
+    return record;
+}
+
+std::vector<std::string> lines(const std::string &text) {
+    std::vector<std::string> result;
+    std::istringstream stream(text);
+    for (std::string line; std::getline(stream, line);) {
+        result.push_back(line);
+    }
+    return result;
+}
+} // namespace
+
+TEST_SUITE("Record writer") {
+    TEST_CASE("JSON Lines leave out unset fields") {
+        std::ostringstream stream;
+        {
+            RecordWriter writer(stream);
+            writer.write(makeRecord());
+            ExecutionRecord failed;
+            failed.test = "a \"quoted\"\tname";
+            failed.run = 4;
+            writer.write(failed);
+        }
+        auto written = lines(stream.str());
+        REQUIRE_EQ(written.size(), 2);
+        CHECK_EQ(written[0],
+                 "{\"test\": \"sb\", \"model\": \"tso\", \"run\": 3, "
+                 "\"seed\": 42, \"status\": \"" +
+                         toString(ExecutionStatus::Completed) +
+                         "\", \"steps\": 12, \"storage\": [1, 1], "
+                         "\"registers\": [[0, 1], [1, 0]]}");
+        CHECK_EQ(written[1], "{\"test\": \"a \\\"quoted\\\"\\u0009name\", "
+                             "\"model\": \"sc\", \"run\": 4}");
+    }
+
+    TEST_CASE("CSV has a header and quotes names") {
+        std::ostringstream stream;
+        {
+            RecordWriter writer(stream, RecordFormat::Csv);
+            auto record = makeRecord();
+            record.test = "sb,2";
+            record.bound = BoundedExecutor::Bound{1, 0};
+            record.choices = std::vector<uint32_t>{0, 2, 1};
+            writer.write(record);
+        }
+        auto written = lines(stream.str());
+        REQUIRE_EQ(written.size(), 2);
+        CHECK_EQ(written[0], "test,model,run,seed,status,steps,storage,"
+                             "registers,preemptions,delays,choices");
+        CHECK_EQ(written[1],
+                 "\"sb,2\",tso,3,42," +
+                         toString(ExecutionStatus::Completed) +
+                         ",12,1 1,0 1|1 0,1,0,0 2 1");
+    }
+
+    TEST_CASE("Batch runs are recorded once regardless of the workers") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)}};
+        auto recordRuns = [&](size_t nOfWorkers) {
+            std::ostringstream stream;
+            BatchRunner::Config config;
+            config.models = {MemoryModel::SC, MemoryModel::TSO};
+            config.runsPerModel = 150;
+            config.nOfWorkers = nOfWorkers;
+            config.records = std::make_shared<RecordWriter>(stream);
+            (void) BatchRunner(config).run(tests);
+            auto written = lines(stream.str());
+            std::sort(written.begin(), written.end());
+            return written;
+        };
+        auto sequential = recordRuns(1);
+        CHECK_EQ(sequential.size(), 300);
+        CHECK(sequential == recordRuns(4));
+    }
+
+    TEST_CASE("Distinct outcomes are recorded once") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)}};
+        std::ostringstream stream;
+        BatchRunner::Config config;
+        config.models = {MemoryModel::TSO};
+        config.runsPerModel = 300;
+        config.nOfWorkers = 2;
+        config.records = std::make_shared<RecordWriter>(stream);
+        config.recordOutcomes = true;
+        auto result = BatchRunner(config).run(tests);
+        CHECK_EQ(lines(stream.str()).size(),
+                 result.cells[0][0].outcomes.size());
+    }
+
+    TEST_CASE("Executions of a cut round are recorded once") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        std::ostringstream stream;
+        BoundedExplorer::Config config;
+        config.nOfWorkers = 4;
+        config.maxExecutionsPerRound = 5;
+        config.records = std::make_shared<RecordWriter>(stream);
+        config.recordName = "sb";
+        auto result = BoundedExplorer(config).explore(programs,
+                                                      MemoryModel::TSO);
+        REQUIRE_FALSE(result.rounds[0].isComplete);
+        size_t executions = 0;
+        for (const auto &round: result.rounds) {
+            executions += round.executions;
+        }
+        auto written = lines(stream.str());
+        CHECK_EQ(written.size(), executions);
+        CHECK(std::all_of(written.begin(), written.end(),
+                          [](const std::string &line) {
+                              return line.find("\"choices\": [") !=
+                                     std::string::npos;
+                          }));
+    }
+}
@@ -0,0 +1,128 @@
+#include "ReleaseAcquireStorageManager.h"
+#include "doctest.h"
+
+using namespace wmm::storage;
+
+namespace {
+// A storage manager that takes the given options for its choices with more
+// than one option
+RA::ReleaseAcquireStorageManager
+makeReplaying(size_t storageSize, const std::vector<uint32_t> &options) {
+    auto choices = std::make_shared<ChoiceSequence>();
+    choices->replay(options);
+    return RA::ReleaseAcquireStorageManager(
+            storageSize, 2, RA::Model::RA,
+            std::make_unique<RA::EnumerateInternalUpdateManager>(choices));
+}
+
+PackedState encode(const StorageManagerInterface &storageManager) {
+    StateWriter writer;
+    storageManager.encodeState(writer);
+    return writer.finish();
+}
+} // namespace
+
+TEST_SUITE("Release Acquire") {
+    using RA::ReleaseAcquireStorageManager;
+    using RA::RandomInternalUpdateManager;
+    constexpr auto relaxed = MemoryAccessMode::Relaxed;
+    constexpr auto release = MemoryAccessMode::Release;
+    constexpr auto acquire = MemoryAccessMode::Acquire;
+
+    TEST_CASE("A relaxed read never goes back in the modification order") {
+        for (unsigned long seed = 0; seed < 100; ++seed) {
+            ReleaseAcquireStorageManager storageManager(
+                    1, 2, RA::Model::SRA,
+                    std::make_unique<RandomInternalUpdateManager>(seed));
+            for (int32_t value = 1; value <= 3; ++value) {
+                storageManager.store(0, 0, value, relaxed);
+            }
+            int32_t first = storageManager.load(1, 0, relaxed);
+            int32_t second = storageManager.load(1, 0, relaxed);
+            CHECK_LE(first, second);
+        }
+    }
+
+    TEST_CASE("Failed CAS doesn't block later atomic updates") {
+        for (auto model: {RA::Model::RA, RA::Model::SRA}) {
+            for (unsigned long seed = 0; seed < 100; ++seed) {
+                ReleaseAcquireStorageManager storageManager(
+                        1, 2, model,
+                        std::make_unique<RandomInternalUpdateManager>(seed));
+                storageManager.compareAndSwap(0, 0, 1, 2, relaxed);
+                storageManager.fetchAndIncrement(1, 0, 1, relaxed);
+                storageManager.fetchAndIncrement(0, 0, 1, relaxed);
+                CHECK_EQ(storageManager.getSharedStorage()[0], 2);
+            }
+        }
+    }
+
+    TEST_CASE("States that differ only in timestamps are equal") {
+        // Thread 1 writes before both writes of thread 0, the first time
+        // between timestamps 0 and 1, the second time at 1
+        auto middle = makeReplaying(1, {0});
+        middle.store(0, 0, 1, relaxed);
+        middle.store(0, 0, 2, relaxed);
+        middle.store(1, 0, 3, relaxed);
+        auto end = makeReplaying(1, {1});
+        end.store(1, 0, 3, relaxed);
+        end.store(0, 0, 1, relaxed);
+        end.store(0, 0, 2, relaxed);
+        CHECK(encode(middle) == encode(end));
+        CHECK_EQ(middle.hashState(), end.hashState());
+
+        auto later = makeReplaying(1, {0});
+        later.store(1, 0, 3, relaxed);
+        later.store(0, 0, 1, relaxed);
+        later.store(0, 0, 2, relaxed);
+        CHECK(encode(later) != encode(end));
+    }
+
+    TEST_CASE("Messages no thread can read are dropped") {
+        // Thread 1 acquires the view of thread 0, so the first write of
+        // thread 0 can't be read anymore
+        auto twoWrites = makeReplaying(2, {1});
+        twoWrites.store(0, 0, 1, relaxed);
+        twoWrites.store(0, 0, 2, relaxed);
+        twoWrites.store(0, 1, 5, release);
+        CHECK_EQ(twoWrites.load(1, 1, acquire), 5);
+        auto oneWrite = makeReplaying(2, {1});
+        oneWrite.store(0, 0, 2, relaxed);
+        oneWrite.store(0, 1, 5, release);
+        CHECK_EQ(oneWrite.load(1, 1, acquire), 5);
+        CHECK(encode(twoWrites) == encode(oneWrite));
+        CHECK_EQ(twoWrites.hashState(), oneWrite.hashState());
+    }
+
+    TEST_CASE("Decoded states behave as the original") {
+        for (unsigned long seed = 0; seed < 50; ++seed) {
+            ReleaseAcquireStorageManager original(
+                    2, 2, RA::Model::RA,
+                    std::make_unique<RandomInternalUpdateManager>(seed));
+            original.store(0, 0, 1, relaxed);
+            original.store(1, 0, 2, release);
+            original.store(1, 1, 3, relaxed);
+            original.store(0, 1, 4, release);
+            original.compareAndSwap(1, 0, 1, 5, acquire);
+            auto state = encode(original);
+
+            ReleaseAcquireStorageManager copy(
+                    2, 2, RA::Model::RA,
+                    std::make_unique<RandomInternalUpdateManager>(seed));
+            StateReader reader(state);
+            copy.decodeState(reader);
+            CHECK(encode(copy) == state);
+            CHECK(copy.getSharedStorage() == original.getSharedStorage());
+            for (size_t threadId = 0; threadId < 2; ++threadId) {
+                for (size_t address = 0; address < 2; ++address) {
+                    for (int32_t value = 0; value < 6; ++value) {
+                        CHECK_EQ(copy.canLoadOtherValue(threadId, address,
+                                                        value),
+                                 original.canLoadOtherValue(threadId,
+                                                            address, value));
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#include "ExecutorFactory.h"
+#include "Parser.h"
+#include "Watchdog.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::storage;
+
+namespace {
+const std::string MESSAGE_PASSING = R"(MAKETHREAD
+1 = 1
+2 = 2
+3 = 1
+store RLX #1 3
+store REL #2 3
+store RLX #1 2
+MAKETHREAD
+1 = 1
+2 = 2
+load ACQ #2 0
+load RLX #1 3
+load RLX #1 4
+)";
+
+struct Run {
+    Outcome outcome;
+    size_t steps;
+    size_t hash;
+};
+
+Run runToCompletion(ExecutorInterface &executor) {
+    auto report = Watchdog({10000, 0}).run(executor);
+    return {executor.getOutcome(), report.steps, executor.hashState()};
+}
+} // namespace
+
+TEST_SUITE("Reset") {
+    TEST_CASE("A reset context repeats the run of a new one") {
+        auto programs = Parser::parseFromString(MESSAGE_PASSING);
+        for (auto mode: {ExecutionMode::Random, ExecutionMode::Pct}) {
+            for (auto model: ALL_MEMORY_MODELS) {
+                CAPTURE(toString(model));
+                auto reusedStorageManager = makeStorageManager(
+                        model, mode, 3, programs.size(), 1,
+                        std::make_unique<FakeStorageLogger>());
+                auto reusedExecutor = makeExecutor(
+                        mode, programs, reusedStorageManager, 5, 2);
+                runToCompletion(*reusedExecutor);
+                for (unsigned long seed = 0; seed < 20; ++seed) {
+                    auto storageManager = makeStorageManager(
+                            model, mode, 3, programs.size(), seed,
+                            std::make_unique<FakeStorageLogger>());
+                    auto executor = makeExecutor(mode, programs,
+                                                 storageManager, 5, ~seed);
+                    auto expected = runToCompletion(*executor);
+
+                    reusedStorageManager->reset(seed);
+                    reusedExecutor->reset(~seed);
+                    auto actual = runToCompletion(*reusedExecutor);
+                    CHECK_EQ(actual.outcome, expected.outcome);
+                    CHECK_EQ(actual.steps, expected.steps);
+                    CHECK_EQ(actual.hash, expected.hash);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include "BatchRunner.h"
+#include "Parser.h"
+#include "ReleaseAcquireStorageManager.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::storage;
+using namespace wmm::test;
+
+TEST_SUITE("Schedulers") {
+    TEST_CASE("PCT without change points runs threads one after another") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)}};
+        BatchRunner::Config config;
+        config.models = {MemoryModel::SC};
+        config.mode = ExecutionMode::Pct;
+        config.scheduling.pctDepth = 1;
+        config.runsPerModel = 100;
+        auto result = BatchRunner(config).run(tests);
+        CHECK_EQ(loadedValues(result.cells[0][0].outcomes),
+                 std::set<std::pair<int32_t, int32_t>>{{0, 1}, {1, 0}});
+    }
+
+    TEST_CASE("PCT with delayed flushes finds store buffering") {
+        std::vector<LitmusTest> tests = {
+                {"sb", Parser::parseFromString(STORE_BUFFERING)}};
+        BatchRunner::Config config;
+        config.models = {MemoryModel::TSO, MemoryModel::PSO};
+        config.mode = ExecutionMode::Pct;
+        config.scheduling.flushProbability = 0.1;
+        config.scheduling.pctDepth = 2;
+        config.scheduling.pctExpectedSteps = 10;
+        config.runsPerModel = 50;
+        auto result = BatchRunner(config).run(tests);
+        for (const auto &cell: result.cells[0]) {
+            CHECK_EQ(loadedValues(cell.outcomes).count({0, 0}), 1);
+        }
+    }
+
+    TEST_CASE("Old message bias prefers older messages") {
+        constexpr auto relaxed = wmm::storage::MemoryAccessMode::Relaxed;
+        size_t oldReads = 0;
+        for (unsigned long seed = 0; seed < 100; ++seed) {
+            RA::InternalUpdateManagerPtr internalUpdateManager(
+                    new RA::RandomInternalUpdateManager(seed, 0.9));
+            RA::ReleaseAcquireStorageManager storageManager(
+                    2, 2, RA::Model::SRA, std::move(internalUpdateManager));
+            for (int32_t value = 1; value <= 4; ++value) {
+                storageManager.store(0, 0, value, relaxed);
+            }
+            if (storageManager.load(1, 0, relaxed) == 0) {
+                ++oldReads;
+            }
+        }
+        CHECK_GT(oldReads, 80);
+    }
+
+    TEST_CASE("Executors for concrete storage managers match the generic one") {
+        auto programs = Parser::parseFromString(STORE_BUFFERING);
+        for (auto model: ALL_MEMORY_MODELS) {
+            for (unsigned long seed = 0; seed < 20; ++seed) {
+                auto typedStorageManager = makeStorageManager(
+                        model, ExecutionMode::Random, 4, 2, seed);
+                auto typedExecutor =
+                        makeExecutor(ExecutionMode::Random, programs,
+                                     typedStorageManager, 4, seed);
+                auto storageManager = makeStorageManager(
+                        model, ExecutionMode::Random, 4, 2, seed);
+                RandomExecutor executor(programs, storageManager, 4, seed);
+                while (typedExecutor->execute()) {
+                    REQUIRE(executor.execute());
+                }
+                CHECK_FALSE(executor.execute());
+                CHECK_EQ(typedExecutor->getOutcome(), executor.getOutcome());
+            }
+        }
+    }
+}
@@ -28,12 +28,16 @@ TEST_SUITE("Sequential Consistency") {
 
         storageManager.store(0, 0, 42, MemoryAccessMode::Relaxed);
         SUBCASE("CompareAndSwap should succeed with the expected value") {
-            storageManager.compareAndSwap(0, 0, 42, 43, MemoryAccessMode::Relaxed);
+            CHECK_EQ(storageManager.compareAndSwap(0, 0, 42, 43,
+                                                   MemoryAccessMode::Relaxed),
+                     42);
             int32_t result = storageManager.load(1, 0, MemoryAccessMode::Relaxed);
             CHECK_EQ(result, 43);
         }
         SUBCASE("CompareAndSwap should fail with the wrong expected value") {
-            storageManager.compareAndSwap(0, 0, 0, 43, MemoryAccessMode::Relaxed);
+            CHECK_EQ(storageManager.compareAndSwap(0, 0, 0, 43,
+                                                   MemoryAccessMode::Relaxed),
+                     42);
             int32_t result = storageManager.load(1, 0, MemoryAccessMode::Relaxed);
             CHECK_EQ(result, 42);
         }
@@ -0,0 +1,102 @@
+#include "BoundedExplorer.h"
+#include "Executor.h"
+#include "ExecutorFactory.h"
+#include "Parser.h"
+#include "ReleaseAcquireStorageManager.h"
+#include "TestPrograms.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::storage;
+using namespace wmm::test;
+
+namespace {
+const std::string WAIT_FOREVER = R"(MAKETHREAD
+1 = 1
+1: load ACQ #1 0
+   0 = 0 - 1
+   if 0 goto 1
+)";
+} // namespace
+
+TEST_SUITE("Spin loops") {
+    TEST_CASE("Spin loop detection") {
+        SUBCASE("Loop recomputing registers from the load") {
+            auto programs = Parser::parseFromString(WAIT_FOREVER);
+            CHECK_EQ(programs[0].getSpinLoopHead(3), 1);
+            CHECK_FALSE(programs[0].getSpinLoopHead(2));
+        }
+        SUBCASE("Loop with a counter") {
+            auto programs = Parser::parseFromString(R"(MAKETHREAD
+1 = 1
+1: load ACQ #1 0
+   3 = 3 + 1
+   if 0 goto 1
+)");
+            CHECK_FALSE(programs[0].getSpinLoopHead(3));
+        }
+        SUBCASE("Loop with a store") {
+            auto programs = Parser::parseFromString(R"(MAKETHREAD
+1 = 1
+1: load ACQ #1 0
+   store RLX #1 0
+   if 0 goto 1
+)");
+            CHECK_FALSE(programs[0].getSpinLoopHead(3));
+        }
+    }
+
+    TEST_CASE("Spinning thread waits for the store") {
+        auto programs = Parser::parseFromString(MESSAGE_PASSING);
+        for (auto model: ALL_MEMORY_MODELS) {
+            CAPTURE(toString(model));
+            for (unsigned long seed = 0; seed < 20; ++seed) {
+                auto storageManager = makeStorageManager(
+                        model, ExecutionMode::Random, 10, programs.size(),
+                        seed);
+                RandomExecutor executor(programs, storageManager, 10, seed);
+                size_t steps = 0;
+                while (executor.execute()) { ++steps; }
+                CHECK(executor.isFinished());
+                // Every pass through the loop but the last is followed by
+                // a memory update
+                CHECK_LE(steps, 20);
+            }
+        }
+    }
+
+    TEST_CASE("Thread blocked forever stops the execution") {
+        auto programs = Parser::parseFromString(WAIT_FOREVER);
+        auto storageManager = makeStorageManager(
+                MemoryModel::TSO, ExecutionMode::Random, 10, 1, 0);
+        RandomExecutor executor(programs, storageManager, 10, 0);
+        size_t steps = 0;
+        while (executor.execute()) { ++steps; }
+        CHECK_FALSE(executor.isFinished());
+        CHECK_EQ(steps, 4);
+    }
+
+    TEST_CASE("Spin loops are explored exhaustively") {
+        auto programs = Parser::parseFromString(MESSAGE_PASSING);
+        for (auto model: ALL_MEMORY_MODELS) {
+            CAPTURE(toString(model));
+            auto result = BoundedExplorer({}).explore(programs, model);
+            CHECK(result.isExhaustive);
+            CHECK_EQ(result.truncatedExecutions, 0);
+            CHECK_EQ(result.outcomes.size(), 1);
+        }
+    }
+
+    TEST_CASE("RA thread may load any message it can see") {
+        constexpr auto relaxed = wmm::storage::MemoryAccessMode::Relaxed;
+        RA::InternalUpdateManagerPtr internalUpdateManager(
+                new RA::RandomInternalUpdateManager(0));
+        RA::ReleaseAcquireStorageManager storageManager(
+                2, 2, RA::Model::SRA, std::move(internalUpdateManager));
+        storageManager.store(0, 0, 1, relaxed);
+        CHECK_FALSE(storageManager.canLoadOtherValue(0, 0, 1));
+        CHECK(storageManager.canLoadOtherValue(1, 0, 1));
+        CHECK(storageManager.canLoadOtherValue(1, 0, 0));
+    }
+}
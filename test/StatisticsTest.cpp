@@ -0,0 +1,113 @@
+#include <sstream>
+
+#include "ExecutorFactory.h"
+#include "Parser.h"
+#include "ReleaseAcquireStorageManager.h"
+#include "TotalStoreOrderStorageManager.h"
+#include "Watchdog.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+using namespace wmm::storage;
+
+namespace {
+const std::string MESSAGE_PASSING = R"(MAKETHREAD
+1 = 1
+2 = 2
+3 = 1
+store RLX #1 3
+store REL #2 3
+MAKETHREAD
+1 = 1
+2 = 2
+load ACQ #2 0
+load RLX #1 3
+)";
+} // namespace
+
+TEST_SUITE("Statistics") {
+    constexpr auto relaxed = wmm::storage::MemoryAccessMode::Relaxed;
+
+    TEST_CASE("Buffer depth high-water mark") {
+        TSO::TotalStoreOrderStorageManager storageManager(
+                2, 2, std::make_unique<TSO::SequentialInternalUpdateManager>());
+        storageManager.store(0, 0, 1, relaxed);
+        storageManager.store(0, 1, 2, relaxed);
+        storageManager.internalUpdate();
+        storageManager.store(1, 0, 3, relaxed);
+        CHECK_EQ(storageManager.getStatistics().maxBufferDepth, 2);
+        // The counters survive a reset
+        storageManager.reset(0);
+        CHECK_EQ(storageManager.getStatistics().maxBufferDepth, 2);
+    }
+
+    TEST_CASE("Message histories and view joins") {
+        RA::ReleaseAcquireStorageManager storageManager(
+                1, 2, RA::Model::SRA,
+                std::make_unique<RA::RandomInternalUpdateManager>(0));
+        for (int32_t value = 1; value <= 3; ++value) {
+            storageManager.store(0, 0, value, relaxed);
+        }
+        const auto &statistics = storageManager.getStatistics();
+        REQUIRE_GE(statistics.maxHistoryLengths.size(), 1);
+        CHECK_EQ(statistics.maxHistoryLengths[0], 4);
+        storageManager.load(1, 0, relaxed);
+        storageManager.fence(
+                0, wmm::storage::MemoryAccessMode::SequentialConsistency);
+        CHECK_EQ(statistics.viewJoins, 3);
+        // After the fence both threads have seen the last store
+        CHECK_EQ(statistics.historyPops, 3);
+    }
+
+    TEST_CASE("Steps are counted per thread over all runs") {
+        auto programs = Parser::parseFromString(MESSAGE_PASSING);
+        for (auto model: ALL_MEMORY_MODELS) {
+            CAPTURE(toString(model));
+            auto storageManager = makeStorageManager(
+                    model, ExecutionMode::Random, 3, programs.size(), 1,
+                    std::make_unique<FakeStorageLogger>());
+            auto executor = makeExecutor(ExecutionMode::Random, programs,
+                                         storageManager, 5, 2);
+            for (unsigned long seed = 0; seed < 3; ++seed) {
+                storageManager->reset(seed);
+                executor->reset(seed);
+                Watchdog({}).run(*executor);
+            }
+            auto statistics = executor->getStatistics();
+            CHECK_EQ(statistics.threadLocalSteps, std::vector<size_t>{9, 6});
+            CHECK_EQ(statistics.memorySteps, std::vector<size_t>{6, 6});
+            CHECK_EQ(statistics.steps(), 27);
+            bool isBuffered =
+                    model == MemoryModel::TSO || model == MemoryModel::PSO;
+            CHECK_EQ(statistics.internalUpdates, isBuffered ? 6 : 0);
+        }
+    }
+
+    TEST_CASE("Merging adds the counters") {
+        ExecutionStatistics lhs;
+        lhs.threadLocalSteps = {1, 2};
+        lhs.storage.recordHistoryLength(0, 3);
+        ExecutionStatistics rhs;
+        rhs.threadLocalSteps = {1, 2, 3};
+        rhs.internalUpdates = 4;
+        rhs.storage.recordHistoryLength(1, 2);
+        lhs.merge(rhs);
+        CHECK_EQ(lhs.threadLocalSteps, std::vector<size_t>{2, 4, 3});
+        CHECK_EQ(lhs.internalUpdates, 4);
+        CHECK_EQ(lhs.storage.maxHistoryLengths, std::vector<size_t>{3, 2});
+    }
+
+    TEST_CASE("JSON report") {
+        ExecutionStatistics statistics;
+        statistics.memorySteps = {2, 3};
+        StatisticsReport report{{{"tso", statistics}}, {{"parse", 0.5}}};
+        std::stringstream stream;
+        report.writeJson(stream);
+        auto json = stream.str();
+        CHECK_NE(json.find("\"tso\": {\"steps\": 5,"), std::string::npos);
+        CHECK_NE(json.find("\"memorySteps\": [2, 3]"), std::string::npos);
+        CHECK_NE(json.find("\"phases\": {\"parse\": 0.500000}"),
+                 std::string::npos);
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <set>
+#include <string>
+#include <utility>
+
+#include "Outcome.h"
+
+namespace wmm::test {
+
+/**
+ * Store buffering: each thread stores 1 to its location and loads the other
+ * location into its register 0, both loads read 0 only with store buffers
+ */
+inline const std::string STORE_BUFFERING = R"(MAKETHREAD
+1 = 1
+2 = 2
+3 = 1
+store RLX #1 3
+load RLX #2 0
+MAKETHREAD
+1 = 1
+2 = 2
+3 = 1
+store RLX #2 3
+load RLX #1 0
+)";
+
+/**
+ * Message passing: the first thread releases 1 to location 1 and the second
+ * spins until it acquires that value
+ */
+inline const std::string MESSAGE_PASSING = R"(MAKETHREAD
+1 = 1
+2 = 1
+store REL #1 2
+MAKETHREAD
+1 = 1
+1: load ACQ #1 0
+   0 = 0 - 1
+   if 0 goto 1
+)";
+
+/** Values loaded by the first two threads into their register 0 */
+inline std::set<std::pair<int32_t, int32_t>>
+loadedValues(const std::set<execution::Outcome> &outcomes) {
+    std::set<std::pair<int32_t, int32_t>> result;
+    for (const auto &outcome: outcomes) {
+        result.emplace(outcome.threadLocalStorages[0][0],
+                       outcome.threadLocalStorages[1][0]);
+    }
+    return result;
+}
+
+} // namespace wmm::test
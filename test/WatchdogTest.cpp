@@ -0,0 +1,53 @@
+#include "ExecutorFactory.h"
+#include "Parser.h"
+#include "Watchdog.h"
+#include "doctest.h"
+
+using namespace wmm::execution;
+using namespace wmm::program;
+
+namespace {
+ExecutionReport runProgram(const std::string &program,
+                           Watchdog::Config config) {
+    auto programs = Parser::parseFromString(program);
+    auto storageManager = makeStorageManager(
+            MemoryModel::TSO, ExecutionMode::Random, 10, programs.size(), 0);
+    RandomExecutor executor(programs, storageManager, 10, 0);
+    return Watchdog(config).run(executor);
+}
+} // namespace
+
+TEST_SUITE("Watchdog") {
+    TEST_CASE("Finished execution is completed") {
+        auto report = runProgram("1 = 1\n2 = 3\nstore RLX #1 2\n", {});
+        CHECK_EQ(toString(report.status), "completed");
+        CHECK(report.snapshot.empty());
+    }
+
+    TEST_CASE("Threads blocked in spin loops are deadlocked") {
+        auto report = runProgram("1 = 1\n1: load ACQ #1 0\nif 0 goto 1\n"
+                                 "2: load ACQ #1 0\n0 = 0 - 1\nif 0 goto 2\n",
+                                 {});
+        CHECK_EQ(toString(report.status), "deadlocked");
+        CHECK_FALSE(report.snapshot.empty());
+    }
+
+    TEST_CASE("Loop over the same states is livelocked") {
+        auto report = runProgram(R"(1 = 1
+2 = 1
+3 = 0
+1: store RLX #1 2
+   store RLX #1 3
+   if 2 goto 1
+)",
+                                 {10000, 100});
+        CHECK_EQ(toString(report.status), "livelocked");
+        CHECK_LT(report.steps, 10000);
+    }
+
+    TEST_CASE("Loop that changes the state runs into the step limit") {
+        auto report = runProgram("1 = 1\n1: 0 = 0 + 1\nif 1 goto 1\n",
+                                 {1000, 100});
+        CHECK_EQ(toString(report.status), "step limit exceeded");
+    }
+}